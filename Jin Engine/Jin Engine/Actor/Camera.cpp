@@ -30,6 +30,8 @@ void Camera::setCamera(Vulkan *pVulkanApp, glm::vec3 eyePositionParam, glm::vec3
 
 	updateViewMatrix(glm::lookAtRH(position, focusPosition, upVector));
 
+	cameraBufferInfo.prevViewProjMat = glm::mat4(1.0);
+
 	//modelMat = viewMat;
 
 	createCameraBuffer();
@@ -47,8 +49,25 @@ void Camera::updateViewMatrix(const glm::mat4 &viewMatParam)
 
 void Camera::updateProjectionMatrix()
 {
-	projMat = glm::perspective(glm::radians(fovY), aspectRatio, nearPlane, farPlane);
-	frustum.update(projMat);
+	//the frustum planes come from the regular projection, the far plane still culls
+	frustum.update(glm::perspective(glm::radians(fovY), aspectRatio, nearPlane, farPlane));
+
+	//reverse-Z spreads the float precision evenly over the view distance
+	float focalLength = 1.0f / tan(glm::radians(fovY) * 0.5f);
+
+	projMat = glm::mat4(0.0f);
+	projMat[0][0] = focalLength / aspectRatio;
+	projMat[1][1] = focalLength;
+	projMat[2][3] = -1.0f;
+
+#if INFINITE_FAR_PLANE
+	projMat[2][2] = 0.0f;
+	projMat[3][2] = nearPlane;
+#else
+	projMat[2][2] = nearPlane / (farPlane - nearPlane);
+	projMat[3][2] = nearPlane * farPlane / (farPlane - nearPlane);
+#endif
+
 	projMat[1][1] *= -1.0;
 
 	
@@ -108,6 +127,15 @@ void Camera::updatePosition(float deltaX, float deltaY, float deltaZ)
 	updateCameraBuffer();
 }
 
+void Camera::setPose(glm::vec3 positionParam, float thetaParam, float phiParam)
+{
+	position = positionParam;
+	theta = thetaParam;
+	phi = phiParam;
+
+	updateOrbit(0.0f, 0.0f, 0.0f);
+}
+
 BoundingBox Camera::getViewAABB(BoundingBox &refBox, glm::mat4 &modelViewMat)
 {
 	BoundingBox viewBox;
@@ -147,6 +175,14 @@ void Camera::updateCameraBuffer()
 	vulkanApp->updateBuffer(&cameraBufferInfo, uniformCameraBufferMemory, sizeof(cameraBuffer));
 }
 
+//should be called once at the beginning of every frame, before the camera moves
+void Camera::updatePrevViewProjMatrix()
+{
+	cameraBufferInfo.prevViewProjMat = viewProjMat;
+
+	updateCameraBuffer();
+}
+
 void Camera::shutDown()
 {
 	vkDestroyBuffer(vulkanApp->getDevice(), uniformCameraBuffer, nullptr);
@@ -5,7 +5,11 @@
 #include "Actor.h"
 
 #define NEAR_PLANE 0.1f
-#define FAR_PLANE 1000.0f
+#define FAR_PLANE 1000.0f //still bounds frustum culling and light clusters with INFINITE_FAR_PLANE
+
+//reverse-Z projection, depth is 1 on the near plane and 0 on the far plane
+//INFINITE_FAR_PLANE in the shaders has to match
+#define INFINITE_FAR_PLANE 1
 
 class Camera : public Actor
 {
@@ -19,13 +23,18 @@ public:
 	virtual void updateOrbit(float deltaX, float deltaY, float deltaZ);
 	virtual void updatePosition(float deltaX, float deltaY, float deltaZ);
 
+	//puts the camera where updateOrbit and updatePosition had left it, for replaying camera paths
+	void setPose(glm::vec3 positionParam, float thetaParam, float phiParam);
+
 	void updateViewMatrix(const glm::mat4 &viewMatParam);
 	void updateProjectionMatrix();
 	void updateViewProjectionMatrix();
 
-	BoundingBox getViewAABB(BoundingBox &refBox, glm::mat4 &modelViewMat);
+	//view space bounds of the corners of refBox, needs no camera state
+	static BoundingBox getViewAABB(BoundingBox &refBox, glm::mat4 &modelViewMat);
 	void createCameraBuffer();
 	void updateCameraBuffer();
+	void updatePrevViewProjMatrix();
 	void shutDown();
 
 	glm::vec3 focusPosition;
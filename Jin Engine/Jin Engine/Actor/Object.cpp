@@ -17,7 +17,7 @@ void Object::initialize(Vulkan *pvulkanApp, std::string actorNameParam, std::str
 bool Object::LoadFromFilename(std::string path)
 {
 	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals | aiProcess_ValidateDataStructure);
+	const aiScene* scene = importer.ReadFile(path, OBJECT_IMPORT_FLAGS);
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
 		std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
 		return false;
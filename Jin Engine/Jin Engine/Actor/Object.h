@@ -8,6 +8,9 @@
 
 #include "Actor.h"
 
+//post processing of every imported scene, the micro benchmarks read their meshes the same way
+#define OBJECT_IMPORT_FLAGS (aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace | aiProcess_JoinIdenticalVertices | aiProcess_GenSmoothNormals | aiProcess_ValidateDataStructure)
+
 class Object : public Actor
 {
 public:
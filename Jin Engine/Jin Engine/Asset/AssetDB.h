@@ -5,6 +5,7 @@
 #include <typeindex>
 
 #include "Asset.h"
+#include "TextureStreamer.h"
 
 #include "../Actor/Object.h"
 
@@ -32,6 +33,9 @@ public:
 	std::vector<Object*> objectManager;
 	//std::vector<Material*> materialManager;
 
+	//LoadAsset<Texture> hands out placeholders, the full textures land through it
+	TextureStreamer textureStreamer;
+
 	AssetDatabase();
 	
 	~AssetDatabase()
@@ -41,6 +45,8 @@ public:
 
 	void cleanUp()
 	{
+		textureStreamer.shutDown();
+
 		for (uint32_t i = 0; i < geomList.size(); i++)
 		{
 			Geometry* pGeo = FindAsset<Geometry>(geomList[i]);
@@ -2,6 +2,10 @@
 
 void Geometry::shutDown()
 {
+	//geometries that were never uploaded have no device to release from
+	if (vertexBuffer == VK_NULL_HANDLE)
+		return;
+
 	vkDestroyBuffer(vulkanApp->getDevice(), vertexBuffer, nullptr);
 	vkFreeMemory(vulkanApp->getDevice(), vertexBufferMemory, nullptr);
 
@@ -11,6 +15,8 @@ void Geometry::shutDown()
 
 void Geometry::initialize(Vulkan *pvulkanApp, std::string pathParam, bool needUflipCorrection, const aiMesh* mesh)
 {
+	PROFILE_ZONE("Geometry::initialize");
+
 	vulkanApp = pvulkanApp;
 	path = pathParam;
 	UflipCorrection = needUflipCorrection;
@@ -230,6 +236,9 @@ void Geometry::setGeometry(const aiMesh* mesh)
 	glm::vec4 maxCorner = glm::vec4(-FLT_MAX);
 	glm::vec4 minCorner = glm::vec4(FLT_MAX);;
 
+	glm::vec2 maxUV = glm::vec2(-FLT_MAX);
+	glm::vec2 minUV = glm::vec2(FLT_MAX);
+
 	for (unsigned int j = 0; j < this->numVetices; j++)
 	{
 		Vertex tempVertexInfo;
@@ -275,7 +284,12 @@ void Geometry::setGeometry(const aiMesh* mesh)
 
 		maxCorner = glm::max(maxCorner, tempVertexInfo.positions);
 		minCorner = glm::min(minCorner, tempVertexInfo.positions);
+
+		maxUV = glm::max(maxUV, tempVertexInfo.texcoords);
+		minUV = glm::min(minUV, tempVertexInfo.texcoords);
 	}
+
+	uvSpan = glm::max(maxUV.x - minUV.x, maxUV.y - minUV.y);
 	
 	AABB.maxPt = maxCorner;
 	AABB.minPt = minCorner;
@@ -315,24 +329,21 @@ void Geometry::createVertexBuffer()
 {
 	VkDeviceSize bufferSize = sizeof(Vertex) * vertices.size();
 
-	vulkanApp->createBuffer(sizeof(Vertex) * vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, vertexBuffer, vertexBufferMemory);
+	//device local, filled through the upload context on the transfer queue
+	vulkanApp->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexBuffer, vertexBufferMemory,
+		VK_SHARING_MODE_EXCLUSIVE);
 
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), vertexBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, vertices.data(), (size_t)bufferSize);
-	vkUnmapMemory(vulkanApp->getDevice(), vertexBufferMemory);
+	vulkanApp->getUploadContext()->uploadBuffer(vertices.data(), bufferSize, vertexBuffer, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
 }
 
 void Geometry::createIndexBuffer()
 {
 	VkDeviceSize bufferSize = sizeof(uint32_t) * indices.size();
 
-	vulkanApp->createBuffer(sizeof(uint32_t) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, indexBuffer, indexBufferMemory);
+	vulkanApp->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer, indexBufferMemory,
+		VK_SHARING_MODE_EXCLUSIVE);
 
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), indexBufferMemory, 0, bufferSize, 0, &data);
-	memcpy(data, indices.data(), (size_t)bufferSize);
-	vkUnmapMemory(vulkanApp->getDevice(), indexBufferMemory);
+	vulkanApp->getUploadContext()->uploadBuffer(indices.data(), bufferSize, indexBuffer, VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
 }
 
 VkBuffer Geometry::getVertexBuffer()
@@ -96,7 +96,7 @@ struct Vertex
 class Geometry : public Asset
 {
 public:
-	Geometry():UflipCorrection(false)
+	Geometry():vertexBuffer(VK_NULL_HANDLE), indexBuffer(VK_NULL_HANDLE), UflipCorrection(false)
 	{
 
 	}
@@ -110,6 +110,8 @@ public:
 	virtual void LoadFromFilename(Vulkan *vulkanAppParam, std::string filename) {};
 
 	void initialize(Vulkan *pvulkanApp, std::string pathParam, bool needUflipCorrection, const aiMesh* mesh);
+
+	//setGeometry and fillTBN only build the CPU copy, initialize uploads it afterwards
 	void setGeometry(const aiMesh* mesh);
 
 	void createVertexBuffer();
@@ -127,6 +129,11 @@ public:
 	{
 		return static_cast<uint32_t>(indices.size());
 	}
+
+	const std::vector<Vertex>& getVertices()
+	{
+		return vertices;
+	}
 	/*
 	BoundingBox getAABB()
 	{
@@ -140,6 +147,9 @@ public:
 
 	BoundingBox AABB;
 
+	//UV units across the longer side of the texture coordinates, the texture streamer relates it to the screen size of AABB
+	float uvSpan;
+
 private:
 
 	std::vector<glm::vec3> Vpositions;
@@ -139,7 +139,7 @@ void Material::depthStencilState(VkPipelineDepthStencilStateCreateInfo &depthSte
 	depthStencilInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 	depthStencilInfo.depthTestEnable = depthTestEnable;
 	depthStencilInfo.depthWriteEnable = depthWriteEnable;
-	depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencilInfo.depthCompareOp = VK_COMPARE_OP_GREATER; //reverse-Z
 	depthStencilInfo.depthBoundsTestEnable = depthBoundsTestEnable;
 	depthStencilInfo.minDepthBounds = 0.0f;
 	depthStencilInfo.maxDepthBounds = 1.0f;
@@ -277,10 +277,18 @@ void Material::createGraphicsPipeline(VkPolygonMode polygonMode, float lineWidth
 	auto bindingDescription = Vertex::getBindingDescription();
 	auto attributeDescriptions = Vertex::getAttributeDescriptions();
 
-	vertexInputInfo.vertexBindingDescriptionCount = 1;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-	vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+	if (isFullscreenPass())
+	{
+		vertexInputInfo.vertexBindingDescriptionCount = 0;
+		vertexInputInfo.vertexAttributeDescriptionCount = 0;
+	}
+	else
+	{
+		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+	}
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
 	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -396,6 +404,10 @@ void Material::createDescriptorWrite(VkWriteDescriptorSet &writeDescriptorSet, u
 	if (type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
 	{
 		writeDescriptorSet.pImageInfo = imageInfo;
+
+		//a streaming texture is still bound as its placeholder, this write is redone when it lands
+		if (type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+			AssetDatabase::GetInstance()->textureStreamer.addDescriptorReference(this, binding, *imageInfo);
 	}
 	else if (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
 	{
@@ -444,7 +456,7 @@ void Material::createDepthStencilState(VkPipelineDepthStencilStateCreateInfo &de
 	depthStencilInfo.flags = 0;
 	depthStencilInfo.depthTestEnable = VK_TRUE;
 	depthStencilInfo.depthWriteEnable = VK_TRUE;
-	depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+	depthStencilInfo.depthCompareOp = VK_COMPARE_OP_GREATER; //reverse-Z
 	depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
 	depthStencilInfo.minDepthBounds = 0.0f;
 	depthStencilInfo.maxDepthBounds = 1.0f;
@@ -484,12 +496,30 @@ VkPipelineLayout Material::getPipelineLayout()
 }
 
 
+void GbufferMaterial::createLocalBuffer()
+{
+	vulkanApp->createBuffer(sizeof(glm::vec4), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		residentLevelBuffer, residentLevelBufferMem);
+}
+
+void GbufferMaterial::updateResidentLevels()
+{
+	glm::vec4 residentLevels;
+
+	for (int i = 0; i < NUM_GBUFFERS; i++)
+	{
+		residentLevels[i] = static_cast<float>(textures[i]->residentLevel);
+	}
+
+	vulkanApp->updateBuffer(&residentLevels, residentLevelBufferMem, sizeof(glm::vec4));
+}
+
 void GbufferMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(6);
+	descPoolSize.resize(7);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
@@ -509,6 +539,9 @@ void GbufferMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 si
 	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[5].descriptorCount = 1;
 
+	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[6].descriptorCount = 1;
+
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
@@ -520,6 +553,7 @@ void GbufferMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 si
 	createLayoutBinding(descLayoutBinding[3], 3, 1, descPoolSize[3].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 	createLayoutBinding(descLayoutBinding[4], 4, 1, descPoolSize[4].type, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
 	createLayoutBinding(descLayoutBinding[5], 5, 1, descPoolSize[5].type, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[6], 6, 1, descPoolSize[6].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 
 	createDescriptorSetLayout(descLayoutBinding);
 
@@ -533,10 +567,11 @@ void GbufferMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 si
 	createImageInfo(ImageInfos[3], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, textures[EMISSIVE_COLOR]->textureImageView, textures[EMISSIVE_COLOR]->textureSampler);
 
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
-	bufferInfos.resize(2);
+	bufferInfos.resize(3);
 
 	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(objectBuffer));
 	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[2], residentLevelBuffer, 0, sizeof(glm::vec4));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -553,8 +588,11 @@ void GbufferMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 si
 	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, &ImageInfos[3], nullptr, NULL);
 	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[0], NULL);
 	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[6], 6, 6, descPoolSize[6].type, nullptr, &bufferInfos[2], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	updateResidentLevels();
 }
 
 void GbufferMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
@@ -573,6 +611,8 @@ void GbufferMaterial::createPipeline(std::string name, std::string albedo, std::
 	addBuffer(objectBuffer);
 	addBuffer(cameraBuffer);
 
+	createLocalBuffer();
+
 	setShaderPaths("Shader/gbuffers.vert.spv", "Shader/gbuffers.frag.spv", "", "", "", "");
 	createDescriptor(ScreenOffsets, SizeScale);
 
@@ -707,12 +747,138 @@ void FrustumCullingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::ve
 	createComputePipeline();
 }
 
+/////////////////////// LightCulling ///////////////////////////////////
+
+void LightCullingMaterial::createLocalBuffer()
+{
+	vulkanApp->createBuffer(sizeof(ClusterInfo), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		clusterInfoBuffer, clusterInfoBufferMem);
+
+	//only touched by the GPU
+	vulkanApp->createBuffer(sizeof(uint32_t) * NUM_CLUSTERS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		lightGridBuffer, lightGridBufferMem);
+
+	vulkanApp->createBuffer(sizeof(uint32_t) * NUM_CLUSTERS * MAX_LIGHTS_PER_CLUSTER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		lightIndexBuffer, lightIndexBufferMem);
+}
+
+void LightCullingMaterial::updateClusterInfoBuffer(ClusterInfo &clusterInfo)
+{
+	vulkanApp->updateBuffer(&clusterInfo, clusterInfoBufferMem, sizeof(ClusterInfo));
+}
+
+void LightCullingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(6);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[2].descriptorCount = 1;
+
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[3].descriptorCount = 1;
+
+	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[4].descriptorCount = 1;
+
+	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[5].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_COMPUTE_BIT);
+	}
+
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(LightInfo) * MAX_POINT_LIGHTS);
+	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(ClusterInfo));
+	createBufferInfo(bufferInfos[3], *buffers[3], 0, sizeof(uint32_t) * NUM_CLUSTERS);
+	createBufferInfo(bufferInfos[4], *buffers[4], 0, sizeof(uint32_t) * NUM_CLUSTERS * MAX_LIGHTS_PER_CLUSTER);
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[2], NULL);
+	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[3], NULL);
+	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[4], NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void LightCullingMaterial::createPipeline(std::string name,
+	std::string albedo, std::string specular, std::string normal, std::string emissive,
+	VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 SizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	numPointLights = static_cast<uint32_t>(numPointLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+
+	createLocalBuffer();
+
+	addTexture(pDepthImageView);
+
+	addBuffer(cameraBuffer);
+	addBuffer(pointLightBuffer);
+	addBuffer(&clusterInfoBuffer);
+	addBuffer(&lightGridBuffer);
+	addBuffer(&lightIndexBuffer);
+
+	setShaderPaths("", "", "", "", "", "Shader/lightCulling.comp.spv");
+	createDescriptor(ScreenOffsets, SizeScale);
+
+	createComputePipeline();
+}
+
+void LightCullingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+	createComputePipeline();
+}
+
 void UberMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(8);
+	descPoolSize.resize(11);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
@@ -732,12 +898,22 @@ void UberMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeS
 	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[5].descriptorCount = 1;
 
-	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	descPoolSize[6].descriptorCount = 1;
 
 	descPoolSize[7].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[7].descriptorCount = 1;
 
+	//Clusters
+	descPoolSize[8].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[8].descriptorCount = 1;
+
+	descPoolSize[9].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[9].descriptorCount = 1;
+
+	descPoolSize[10].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[10].descriptorCount = 1;
+
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
@@ -753,6 +929,10 @@ void UberMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeS
 	createLayoutBinding(descLayoutBinding[6], 6, 1, descPoolSize[6].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 	createLayoutBinding(descLayoutBinding[7], 7, 1, descPoolSize[7].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 
+	createLayoutBinding(descLayoutBinding[8], 8, 1, descPoolSize[8].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[9], 9, 1, descPoolSize[9].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[10], 10, 1, descPoolSize[10].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+
 	createDescriptorSetLayout(descLayoutBinding);
 
 
@@ -768,9 +948,14 @@ void UberMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeS
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 	
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(LightInfo) * numPointLights);
-	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(LightInfo) * numDirectionalLights);
+	//cluster buffers are added before createPipeline
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(ClusterInfo));
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(uint32_t) * NUM_CLUSTERS);
+	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(uint32_t) * NUM_CLUSTERS * MAX_LIGHTS_PER_CLUSTER);
+
+	createBufferInfo(bufferInfos[3], *buffers[3], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[4], *buffers[4], 0, sizeof(LightInfo) * MAX_POINT_LIGHTS);
+	createBufferInfo(bufferInfos[5], *buffers[5], 0, sizeof(LightInfo) * numDirectionalLights);
 
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
@@ -788,9 +973,13 @@ void UberMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeS
 	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, &ImageInfos[3], nullptr, NULL);
 	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, &ImageInfos[4], nullptr, NULL);
 
-	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[6], 6, 6, descPoolSize[6].type, nullptr, &bufferInfos[1], NULL);
-	createDescriptorWrite(descriptorWrites[7], 7, 7, descPoolSize[7].type, nullptr, &bufferInfos[2], NULL);
+	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[3], NULL);
+	createDescriptorWrite(descriptorWrites[6], 6, 6, descPoolSize[6].type, nullptr, &bufferInfos[4], NULL);
+	createDescriptorWrite(descriptorWrites[7], 7, 7, descPoolSize[7].type, nullptr, &bufferInfos[5], NULL);
+
+	createDescriptorWrite(descriptorWrites[8], 8, 8, descPoolSize[8].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[9], 9, 9, descPoolSize[9].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[10], 10, 10, descPoolSize[10].type, nullptr, &bufferInfos[2], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
@@ -816,7 +1005,8 @@ void UberMaterial::createPipeline(std::string name, std::string albedo, std::str
 	addBuffer(pointLightBuffer);
 	addBuffer(directionalLightBuffer);
 
-	setShaderPaths("Shader/pbr.vert.spv", "Shader/pbr.frag.spv", "", "", "", "");
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/pbr.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	//glm::vec2 screenOffsets = glm::vec2(0.0);
 	//glm::vec4 sizeScale = glm::vec4(swapChainExtent.width, swapChainExtent.height, 1.0, 1.0);
@@ -847,22 +1037,6 @@ void UberMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeSca
 
 /////////////////////// ScreenSpaceProjection ///////////////////////////////////
 
-void ScreenSpaceProjectionMaterial::createLocalBuffer()
-{
-	vulkanApp->createBuffer(sizeof(PlaneInfoPack), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		planeInfoBuffer, planeInfoBufferMem);
-}
-
-void ScreenSpaceProjectionMaterial::updatePlaneInfoPackBuffer(PlaneInfoPack &planeInfoPack)
-{
-	VkDeviceSize bufferSize = sizeof(PlaneInfoPack);
-
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), planeInfoBufferMem, 0, bufferSize, 0, &data);
-	memcpy(data, &planeInfoPack, static_cast<size_t>(bufferSize));
-	vkUnmapMemory(vulkanApp->getDevice(), planeInfoBufferMem);
-}
-
 void ScreenSpaceProjectionMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
@@ -882,7 +1056,7 @@ void ScreenSpaceProjectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[3].descriptorCount = 1;
 
-	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	descPoolSize[4].descriptorCount = 1;	
 
 	createDescriptorPool(descPoolSize);
@@ -907,8 +1081,8 @@ void ScreenSpaceProjectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(PlaneInfoPack));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, VK_WHOLE_SIZE);
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
 	
 	
 
@@ -925,8 +1099,8 @@ void ScreenSpaceProjectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
 	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
 
-	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[0], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
@@ -942,14 +1116,11 @@ void ScreenSpaceProjectionMaterial::createPipeline(std::string name,
 
 	LoadFromFilename(vulkanApp, name);
 
-	createLocalBuffer();
-
 	addTexture((*renderTarget)[0]); //Scene
 	addTexture((*renderTarget)[1]); //image
 	addTexture(pDepthImageView);
 
 	addBuffer(cameraBuffer);
-	addBuffer(&planeInfoBuffer);
 	
 
 	setShaderPaths("", "", "", "", "", "Shader/SSRP.comp.spv");
@@ -968,22 +1139,6 @@ void ScreenSpaceProjectionMaterial::updatePipeline(glm::vec2 screenOffsetParam,
 /////////////////////////////////////////////////// SSP2 //////////////////////////////////////////////
 
 
-void ScreenSpaceProjectionMaterial2::createLocalBuffer()
-{
-	vulkanApp->createBuffer(sizeof(PlaneInfoPack), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		planeInfoBuffer, planeInfoBufferMem);
-}
-
-void ScreenSpaceProjectionMaterial2::updatePlaneInfoPackBuffer(PlaneInfoPack &planeInfoPack)
-{
-	VkDeviceSize bufferSize = sizeof(PlaneInfoPack);
-
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), planeInfoBufferMem, 0, bufferSize, 0, &data);
-	memcpy(data, &planeInfoPack, static_cast<size_t>(bufferSize));
-	vkUnmapMemory(vulkanApp->getDevice(), planeInfoBufferMem);
-}
-
 void ScreenSpaceProjectionMaterial2::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
@@ -1003,7 +1158,7 @@ void ScreenSpaceProjectionMaterial2::createDescriptor(glm::vec2 screenOffsetPara
 	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[3].descriptorCount = 1;
 
-	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	descPoolSize[4].descriptorCount = 1;
 
 	createDescriptorPool(descPoolSize);
@@ -1028,8 +1183,8 @@ void ScreenSpaceProjectionMaterial2::createDescriptor(glm::vec2 screenOffsetPara
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(PlaneInfoPack));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, VK_WHOLE_SIZE);
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
 
 
 
@@ -1046,8 +1201,8 @@ void ScreenSpaceProjectionMaterial2::createDescriptor(glm::vec2 screenOffsetPara
 	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
 	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
 
-	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[0], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
@@ -1063,17 +1218,15 @@ void ScreenSpaceProjectionMaterial2::createPipeline(std::string name,
 
 	LoadFromFilename(vulkanApp, name);
 
-	createLocalBuffer();
-
 	addTexture((*renderTarget)[0]); //Scene
 	addTexture((*renderTarget)[1]); //image
 	addTexture(pDepthImageView);
 
 	addBuffer(cameraBuffer);
-	addBuffer(&planeInfoBuffer);
 
 
 	setShaderPaths("Shader/postProcess.vert.spv", "Shader/SSRP.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 	createDescriptor(ScreenOffsets, SizeScale);
 
 	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
@@ -1108,7 +1261,7 @@ void ScreenSpaceReflectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(10);
+	descPoolSize.resize(11);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
@@ -1131,7 +1284,7 @@ void ScreenSpaceReflectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[6].descriptorCount = 1;
 
-	descPoolSize[7].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[7].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	descPoolSize[7].descriptorCount = 1;
 
 	descPoolSize[8].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -1140,6 +1293,9 @@ void ScreenSpaceReflectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	descPoolSize[9].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[9].descriptorCount = 1;
 
+	descPoolSize[10].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // plane ID
+	descPoolSize[10].descriptorCount = 1;
+
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
@@ -1162,11 +1318,14 @@ void ScreenSpaceReflectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	createImageInfo(ImageInfos[5], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[5]->textureImageView, textures[5]->textureSampler);
 	createImageInfo(ImageInfos[6], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[6]->textureImageView, textures[6]->textureSampler);
 
+	VkDescriptorImageInfo planeIDImageInfo;
+	createImageInfo(planeIDImageInfo, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, planeIDTexture->textureImageView, planeIDTexture->textureSampler);
+
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(PlaneInfoPack));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(glm::vec4));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, VK_WHOLE_SIZE);
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(glm::vec4) * 3);
 	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(cameraBuffer));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
@@ -1192,6 +1351,8 @@ void ScreenSpaceReflectionMaterial::createDescriptor(glm::vec2 screenOffsetParam
 	createDescriptorWrite(descriptorWrites[8], 8, 8, descPoolSize[8].type, nullptr, &bufferInfos[1], NULL);
 	createDescriptorWrite(descriptorWrites[9], 9, 9, descPoolSize[9].type, nullptr, &bufferInfos[2], NULL);
 
+	createDescriptorWrite(descriptorWrites[10], 10, 10, descPoolSize[10].type, &planeIDImageInfo, nullptr, NULL);
+
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
@@ -1219,6 +1380,7 @@ void ScreenSpaceReflectionMaterial::createPipeline(std::string name, std::string
 	addBuffer(cameraBuffer);
 
 	setShaderPaths("Shader/postProcess.vert.spv", "Shader/SSRR.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	createDescriptor(ScreenOffsets, SizeScale);
 
@@ -1243,60 +1405,46 @@ void ScreenSpaceReflectionMaterial::updatePipeline(glm::vec2 screenOffsetParam,
 	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
 	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
-/////
 
-void SkyRenderingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+/////////////////////////////////////////////////// PlaneID ///////////////////////////////////////////////////////
+
+void PlaneIDMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(6);
+	descPoolSize.resize(3);
 
-	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // depth
 	descPoolSize[0].descriptorCount = 1;
 
-	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[1].descriptorCount = 1;
 
-	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	descPoolSize[2].descriptorCount = 1;
 
-	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	descPoolSize[3].descriptorCount = 1;
-
-	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[4].descriptorCount = 1;
-
-	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[5].descriptorCount = 1;
-
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
 	descLayoutBinding.resize(descPoolSize.size());
 
-	createLayoutBinding(descLayoutBinding[0], 0, 1, descPoolSize[0].type, VK_SHADER_STAGE_FRAGMENT_BIT);
-	createLayoutBinding(descLayoutBinding[1], 1, 1, descPoolSize[1].type, VK_SHADER_STAGE_FRAGMENT_BIT);
-	createLayoutBinding(descLayoutBinding[2], 2, 1, descPoolSize[2].type, VK_SHADER_STAGE_FRAGMENT_BIT);
-	createLayoutBinding(descLayoutBinding[3], 3, 1, descPoolSize[3].type, VK_SHADER_STAGE_FRAGMENT_BIT);
-	createLayoutBinding(descLayoutBinding[4], 4, 1, descPoolSize[4].type, VK_SHADER_STAGE_FRAGMENT_BIT);
-	createLayoutBinding(descLayoutBinding[5], 5, 1, descPoolSize[5].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
 	createDescriptorSetLayout(descLayoutBinding);
 
-
 	std::vector<VkDescriptorImageInfo> ImageInfos;
-	ImageInfos.resize(4);
+	ImageInfos.resize(textures.size());
 
 	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
-	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
-	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
-	createImageInfo(ImageInfos[3], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[3]->textureImageView, textures[3]->textureSampler);
-	
+
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(perframeBuffer));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, VK_WHOLE_SIZE);
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1308,21 +1456,16 @@ void SkyRenderingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::ve
 	descriptorWrites.resize(descPoolSize.size());
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, &ImageInfos[3], nullptr, NULL);
-
-	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[0], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void SkyRenderingMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+void PlaneIDMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
 	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
-	glm::vec2 ScreenOffsets, glm::vec4 SizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
-
 	numPointLights = static_cast<uint32_t>(numPointLight);
 	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
 
@@ -1330,28 +1473,31 @@ void SkyRenderingMaterial::createPipeline(std::string name, std::string albedo,
 	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
 	LoadFromFilename(vulkanApp, name);
-	addTexture((*renderTarget)[0]);
-	addTexture((*renderTarget)[1]);
-	addTexture((*renderTarget)[2]);
-	addTexture(AssetDatabase::GetInstance()->LoadAsset<Texture>("Asset/Texture/cloudTextures/wheather.tga"));
+
+	addTexture(pDepthImageView);
 
 	addBuffer(cameraBuffer);
-	addBuffer(perFrameBuffer);
 
-	setShaderPaths("Shader/postProcess.vert.spv", "Shader/sky.frag.spv", "", "", "", "");
+	setShaderPaths("Shader/planeID.vert.spv", "Shader/planeID.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
-	createDescriptor(ScreenOffsets, SizeScale);
+	//a quad per plane, the instances past the visible planes collapse in planeID.vert
+	drawVertexCount = 6;
+	drawInstanceCount = MAX_REFLECTIVE_PLANES;
+
+	createDescriptor(ScreenOffsets, sizeScale);
 
 	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
 	colorBlendAttachments.resize(1);
 
 	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
 
+	//planes facing away are culled on the CPU
 	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
-void SkyRenderingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+void PlaneIDMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
 {
 	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
 
@@ -1361,32 +1507,668 @@ void SkyRenderingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4
 	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
 
 	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
+/////
 
-void HolePatchingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+void SkyRenderingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(3);
+	descPoolSize.resize(8);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
 
-	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[1].descriptorCount = 1;
 
-	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[2].descriptorCount = 1;
 
-	createDescriptorPool(descPoolSize);
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[3].descriptorCount = 1;
 
-	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
-	descLayoutBinding.resize(descPoolSize.size());
+	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[4].descriptorCount = 1;
 
-	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
-	{
+	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[5].descriptorCount = 1;
+
+	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[6].descriptorCount = 1;
+
+	descPoolSize[7].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[7].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	createLayoutBinding(descLayoutBinding[0], 0, 1, descPoolSize[0].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[1], 1, 1, descPoolSize[1].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[2], 2, 1, descPoolSize[2].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[3], 3, 1, descPoolSize[3].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[4], 4, 1, descPoolSize[4].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[5], 5, 1, descPoolSize[5].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[6], 6, 1, descPoolSize[6].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[7], 7, 1, descPoolSize[7].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createDescriptorSetLayout(descLayoutBinding);
+
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(4);
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
+	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
+	createImageInfo(ImageInfos[3], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[3]->textureImageView, textures[3]->textureSampler);
+	
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	//cloud buffers are added before createPipeline
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4));
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(float) * CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE);
+	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[3], *buffers[3], 0, sizeof(perframeBuffer));
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, &ImageInfos[3], nullptr, NULL);
+
+	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[2], NULL);
+	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[3], NULL);
+	createDescriptorWrite(descriptorWrites[6], 6, 6, descPoolSize[6].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[7], 7, 7, descPoolSize[7].type, nullptr, &bufferInfos[1], NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void SkyRenderingMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 SizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+	addTexture((*renderTarget)[0]);
+	addTexture((*renderTarget)[1]);
+	addTexture((*renderTarget)[2]);
+	addTexture(AssetDatabase::GetInstance()->LoadAsset<Texture>("Asset/Texture/cloudTextures/wheather.tga"));
+
+	addBuffer(cameraBuffer);
+	addBuffer(perFrameBuffer);
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/sky.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, SizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void SkyRenderingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void CloudTemporalMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(4);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[2].descriptorCount = 1;
+
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[3].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(perframeBuffer));
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[1], NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void CloudTemporalMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+	addTexture((*renderTarget)[0]); //current clouds
+	addTexture((*renderTarget)[1]); //history
+
+	addBuffer(cameraBuffer);
+	addBuffer(perFrameBuffer);
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/cloudTemporal.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void CloudTemporalMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void CloudUpsampleMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(3);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
+	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void CloudUpsampleMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+	addTexture((*renderTarget)[0]); //scene
+	addTexture((*renderTarget)[1]); //resolved clouds
+	addTexture(pDepthImageView);
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/cloudUpsample.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void CloudUpsampleMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void HolePatchingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(3);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[2].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_COMPUTE_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_GENERAL, textures[1]->textureImageView, textures[1]->textureSampler);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4) * 4);
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[0], NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void HolePatchingMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+
+	addTexture((*renderTarget)[0]); //SSR
+	addTexture((*renderTarget)[1]); //patched image
+
+	setShaderPaths("", "", "", "", "", "Shader/holePatching.comp.spv");
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	createComputePipeline();
+}
+
+void HolePatchingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+	createComputePipeline();
+}
+
+void SSRUpsampleMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(3);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], textures[0]->sampledLayout, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
+	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void SSRUpsampleMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+	addTexture((*renderTarget)[0]); //low resolution reflection
+	addTexture(pDepthImageView);
+	addTexture((*renderTarget)[1]); //normal gbuffer
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/SSRUpsample.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void SSRUpsampleMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+
+void SSRTemporalMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(6);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].descriptorCount = 1;
+
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[3].descriptorCount = 1;
+
+	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[4].descriptorCount = 1;
+
+	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[5].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], textures[0]->sampledLayout, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], textures[1]->sampledLayout, textures[1]->textureImageView, textures[1]->textureSampler);
+	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4) * 3);
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(perframeBuffer));
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[2], NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void SSRTemporalMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+	addTexture((*renderTarget)[0]); //current reflection
+	addTexture((*renderTarget)[1]); //history
+	addTexture(pDepthImageView);
+
+	addBuffer(cameraBuffer);
+	addBuffer(perFrameBuffer);
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/SSRTemporal.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void SSRTemporalMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void BruteForceMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(10);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].descriptorCount = 1;
+
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[3].descriptorCount = 1;
+
+	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // depth
+	descPoolSize[4].descriptorCount = 1;
+	
+	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[5].descriptorCount = 1;
+	
+	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[6].descriptorCount = 1;
+
+	descPoolSize[7].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[7].descriptorCount = 1;
+
+	descPoolSize[8].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // Hi-Z levels
+	descPoolSize[8].descriptorCount = DEPTH_MIP_SIZE;
+
+	descPoolSize[9].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // plane ID
+	descPoolSize[9].descriptorCount = 1;
+	
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
 		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 	}
 	createDescriptorSetLayout(descLayoutBinding);
@@ -1395,12 +2177,142 @@ void HolePatchingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::ve
 	ImageInfos.resize(textures.size());
 
 	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
+	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
+	createImageInfo(ImageInfos[3], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[3]->textureImageView, textures[3]->textureSampler);
+	createImageInfo(ImageInfos[4], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[4]->textureImageView, textures[4]->textureSampler);
+
+	//level 0 is the depth buffer itself, the rest are min reduced by DepthMipmapMaterial
+	std::vector<VkDescriptorImageInfo> hiZImageInfos;
+	hiZImageInfos.resize(DEPTH_MIP_SIZE);
+
+	for (size_t i = 0; i < hiZImageInfos.size(); i++)
+	{
+		Texture *hiZLevel = (i == 0 || i > hiZTextures.size()) ? textures[4] : hiZTextures[i - 1];
+		createImageInfo(hiZImageInfos[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, hiZLevel->textureImageView, hiZLevel->textureSampler);
+	}
+
+	VkDescriptorImageInfo planeIDImageInfo;
+	createImageInfo(planeIDImageInfo, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, planeIDTexture->textureImageView, planeIDTexture->textureSampler);
+
 
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4) * 2);
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, VK_WHOLE_SIZE);
+	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(cameraBuffer));
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, &ImageInfos[3], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, &ImageInfos[4], nullptr, NULL);
+
+	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[6], 6, 6, descPoolSize[6].type, nullptr, &bufferInfos[2], NULL);
+	createDescriptorWrite(descriptorWrites[7], 7, 7, descPoolSize[7].type, nullptr, &bufferInfos[1], NULL);
+
+	createDescriptorWrite(descriptorWrites[8], 8, 8, descPoolSize[8].type, hiZImageInfos.data(), nullptr, NULL);
+	descriptorWrites[8].descriptorCount = DEPTH_MIP_SIZE;
+
+	createDescriptorWrite(descriptorWrites[9], 9, 9, descPoolSize[9].type, &planeIDImageInfo, nullptr, NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
+
+void BruteForceMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
+{
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+
+	for (size_t i = 0; i < renderTarget->size(); i++)
+	{
+		addTexture((*renderTarget)[i]);
+	}
+
+	addTexture(pDepthImageView);
+
+	addBuffer(cameraBuffer);
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/SSR.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void BruteForceMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+}
+
+void HorizontalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(2);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1413,12 +2325,11 @@ void HolePatchingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::ve
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
 	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[1], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void HolePatchingMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+void HorizontalBlurMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
 	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
 	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
@@ -1437,7 +2348,8 @@ void HolePatchingMaterial::createPipeline(std::string name, std::string albedo,
 
 	addBuffer(cameraBuffer);
 
-	setShaderPaths("Shader/postProcess.vert.spv", "Shader/holePatching.frag.spv", "", "", "", "");
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/horizontalBlur.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	createDescriptor(ScreenOffsets, sizeScale);
 
@@ -1450,7 +2362,7 @@ void HolePatchingMaterial::createPipeline(std::string name, std::string albedo,
 	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
-void HolePatchingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+void HorizontalBlurMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
 {
 	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
 
@@ -1463,30 +2375,108 @@ void HolePatchingMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4
 	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
+void VerticalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(2);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
+	{
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	}
+	createDescriptorSetLayout(descLayoutBinding);
+
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
+
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
+
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
+
+	createDescriptorSet(descriptorSetLayouts);
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
+
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
+
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
 
-void BruteForceMaterial::createLocalBuffer()
+void VerticalBlurMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
-	vulkanApp->createBuffer(sizeof(PlaneInfoPack), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		planeInfoBuffer, planeInfoBufferMem);
+	numPointLights = static_cast<uint32_t>(numPointLight);
+	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
+
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
+
+	LoadFromFilename(vulkanApp, name);
+
+	for (size_t i = 0; i < renderTarget->size(); i++)
+	{
+		addTexture((*renderTarget)[i]);
+	}
+
+	addBuffer(cameraBuffer);
+
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/horizontalBlur.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
+
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
-void BruteForceMaterial::updatePlaneInfoPackBuffer(PlaneInfoPack &planeInfoPack)
+void VerticalBlurMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
 {
-	VkDeviceSize bufferSize = sizeof(PlaneInfoPack);
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+
+	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
+	colorBlendAttachments.resize(1);
+
+	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
 
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), planeInfoBufferMem, 0, bufferSize, 0, &data);
-	memcpy(data, &planeInfoPack, static_cast<size_t>(bufferSize));
-	vkUnmapMemory(vulkanApp->getDevice(), planeInfoBufferMem);
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
 
-void BruteForceMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+void CompositePostProcessMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(8);
+	descPoolSize.resize(4);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
@@ -1494,25 +2484,12 @@ void BruteForceMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4
 	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[1].descriptorCount = 1;
 
-	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[2].descriptorCount = 1;
 
-	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 	descPoolSize[3].descriptorCount = 1;
 
-	descPoolSize[4].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; // depth
-	descPoolSize[4].descriptorCount = 1;
-	
-	descPoolSize[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[5].descriptorCount = 1;
-	
-	descPoolSize[6].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[6].descriptorCount = 1;
-
-	descPoolSize[7].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[7].descriptorCount = 1;
-	
-
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
@@ -1524,22 +2501,18 @@ void BruteForceMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4
 	}
 	createDescriptorSetLayout(descLayoutBinding);
 
-	std::vector<VkDescriptorImageInfo> ImageInfos;
-	ImageInfos.resize(textures.size());
-
-	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
-	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
-	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[2]->textureImageView, textures[2]->textureSampler);
-	createImageInfo(ImageInfos[3], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[3]->textureImageView, textures[3]->textureSampler);
-	createImageInfo(ImageInfos[4], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[4]->textureImageView, textures[4]->textureSampler);
+	std::vector<VkDescriptorImageInfo> ImageInfos;
+	ImageInfos.resize(textures.size());
 
+	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], textures[1]->sampledLayout, textures[1]->textureImageView, textures[1]->textureSampler);
 
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(uint32_t));
 	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
-	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(PlaneInfoPack));
+	
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1552,44 +2525,36 @@ void BruteForceMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
 	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, &ImageInfos[3], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[4], 4, 4, descPoolSize[4].type, &ImageInfos[4], nullptr, NULL);
 
-	createDescriptorWrite(descriptorWrites[5], 5, 5, descPoolSize[5].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[6], 6, 6, descPoolSize[6].type, nullptr, &bufferInfos[1], NULL);
-	createDescriptorWrite(descriptorWrites[7], 7, 7, descPoolSize[7].type, nullptr, &bufferInfos[2], NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[1], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void BruteForceMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+void CompositePostProcessMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
 	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
 	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
 	numPointLights = static_cast<uint32_t>(numPointLight);
 	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
 
-	
-
 	AssetDatabase::GetInstance()->materialList.push_back(name);
 	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
 	LoadFromFilename(vulkanApp, name);
 
-	createLocalBuffer();
-
 	for (size_t i = 0; i < renderTarget->size(); i++)
 	{
 		addTexture((*renderTarget)[i]);
 	}
 
-	addTexture(pDepthImageView);
+	//addTexture(pDepthImageView);
 
 	addBuffer(cameraBuffer);
-	addBuffer(&planeInfoBuffer);
 
-	setShaderPaths("Shader/postProcess.vert.spv", "Shader/SSR.frag.spv", "", "", "", "");
+	setShaderPaths("Shader/postProcess.vert.spv", "Shader/compositePostProcess.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	createDescriptor(ScreenOffsets, sizeScale);
 
@@ -1602,7 +2567,7 @@ void BruteForceMaterial::createPipeline(std::string name, std::string albedo, st
 	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
-void BruteForceMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+void CompositePostProcessMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
 {
 	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
 
@@ -1615,7 +2580,8 @@ void BruteForceMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 s
 	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
 }
 
-void HorizontalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+
+void BloomDownsampleMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
@@ -1625,7 +2591,7 @@ void HorizontalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
 
-	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	descPoolSize[1].descriptorCount = 1;
 
 	createDescriptorPool(descPoolSize);
@@ -1635,19 +2601,15 @@ void HorizontalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::
 
 	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
 	{
-		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_COMPUTE_BIT);
 	}
 	createDescriptorSetLayout(descLayoutBinding);
 
 	std::vector<VkDescriptorImageInfo> ImageInfos;
 	ImageInfos.resize(textures.size());
 
-	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
-
-	std::vector<VkDescriptorBufferInfo> bufferInfos;
-	bufferInfos.resize(buffers.size());
-
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
+	createImageInfo(ImageInfos[0], textures[0]->sampledLayout, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_GENERAL, textures[1]->textureImageView, textures[1]->textureSampler);
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1659,69 +2621,54 @@ void HorizontalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::
 	descriptorWrites.resize(descPoolSize.size());
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void HorizontalBlurMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+void BloomDownsampleMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
 	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
 	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
-	numPointLights = static_cast<uint32_t>(numPointLight);
-	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
-
 	AssetDatabase::GetInstance()->materialList.push_back(name);
 	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
 	LoadFromFilename(vulkanApp, name);
 
-	for (size_t i = 0; i < renderTarget->size(); i++)
-	{
-		addTexture((*renderTarget)[i]);
-	}
-
-	addBuffer(cameraBuffer);
-
-	setShaderPaths("Shader/postProcess.vert.spv", "Shader/horizontalBlur.frag.spv", "", "", "", "");
+	addTexture((*renderTarget)[0]); //larger level
+	addTexture((*renderTarget)[1]); //downsampled level
 
+	setShaderPaths("", "", "", "", "", "Shader/bloomDownsample.comp.spv");
 	createDescriptor(ScreenOffsets, sizeScale);
 
-	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-	colorBlendAttachments.resize(1);
-
-	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	createComputePipeline();
 }
 
-void HorizontalBlurMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+void BloomDownsampleMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
 {
 	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
-
-	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-	colorBlendAttachments.resize(1);
-
-	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	createComputePipeline();
 }
 
-void VerticalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+void BloomUpsampleMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(2);
+	descPoolSize.resize(4);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
 
-	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[1].descriptorCount = 1;
 
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	descPoolSize[2].descriptorCount = 1;
+
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[3].descriptorCount = 1;
+
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
@@ -1729,19 +2676,21 @@ void VerticalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::ve
 
 	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
 	{
-		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_COMPUTE_BIT);
 	}
 	createDescriptorSetLayout(descLayoutBinding);
 
 	std::vector<VkDescriptorImageInfo> ImageInfos;
 	ImageInfos.resize(textures.size());
 
-	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[0], textures[0]->sampledLayout, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], textures[1]->sampledLayout, textures[1]->textureImageView, textures[1]->textureSampler);
+	createImageInfo(ImageInfos[2], VK_IMAGE_LAYOUT_GENERAL, textures[2]->textureImageView, textures[2]->textureSampler);
 
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(cameraBuffer));
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1753,76 +2702,51 @@ void VerticalBlurMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::ve
 	descriptorWrites.resize(descPoolSize.size());
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[2], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[0], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void VerticalBlurMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+void BloomUpsampleMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
 	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
 	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
-	numPointLights = static_cast<uint32_t>(numPointLight);
-	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
-
 	AssetDatabase::GetInstance()->materialList.push_back(name);
 	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
 	LoadFromFilename(vulkanApp, name);
 
-	for (size_t i = 0; i < renderTarget->size(); i++)
-	{
-		addTexture((*renderTarget)[i]);
-	}
-
-	addBuffer(cameraBuffer);
-
-	setShaderPaths("Shader/postProcess.vert.spv", "Shader/horizontalBlur.frag.spv", "", "", "", "");
+	addTexture((*renderTarget)[0]); //smaller, already accumulated level
+	addTexture((*renderTarget)[1]); //downsampled level of the same size
+	addTexture((*renderTarget)[2]); //accumulated level
 
+	setShaderPaths("", "", "", "", "", "Shader/bloomUpsample.comp.spv");
 	createDescriptor(ScreenOffsets, sizeScale);
 
-	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-	colorBlendAttachments.resize(1);
-
-	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	createComputePipeline();
 }
 
-void VerticalBlurMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+void BloomUpsampleMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
 {
 	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
-
-	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-	colorBlendAttachments.resize(1);
-
-	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	createComputePipeline();
 }
 
-
-void CompositePostProcessMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+void LuminanceHistogramMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(4);
+	descPoolSize.resize(2);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
 
-	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	descPoolSize[1].descriptorCount = 1;
 
-	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[2].descriptorCount = 1;
-
-	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[3].descriptorCount = 1;
-
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
@@ -1830,7 +2754,7 @@ void CompositePostProcessMaterial::createDescriptor(glm::vec2 screenOffsetParam,
 
 	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
 	{
-		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_COMPUTE_BIT);
 	}
 	createDescriptorSetLayout(descLayoutBinding);
 
@@ -1838,14 +2762,11 @@ void CompositePostProcessMaterial::createDescriptor(glm::vec2 screenOffsetParam,
 	ImageInfos.resize(textures.size());
 
 	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
-	createImageInfo(ImageInfos[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[1]->textureImageView, textures[1]->textureSampler);
 
 	std::vector<VkDescriptorBufferInfo> bufferInfos;
 	bufferInfos.resize(buffers.size());
 
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(uint32_t));
-	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(cameraBuffer));
-	
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(ExposureInfo));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1857,86 +2778,150 @@ void CompositePostProcessMaterial::createDescriptor(glm::vec2 screenOffsetParam,
 	descriptorWrites.resize(descPoolSize.size());
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, &ImageInfos[1], nullptr, NULL);
-
-	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[0], NULL);
-	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void CompositePostProcessMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+void LuminanceHistogramMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
 	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
 	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
-	numPointLights = static_cast<uint32_t>(numPointLight);
-	numDirectionalLights = static_cast<uint32_t>(numDirectionalLight);
-
 	AssetDatabase::GetInstance()->materialList.push_back(name);
 	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
 	LoadFromFilename(vulkanApp, name);
 
-	for (size_t i = 0; i < renderTarget->size(); i++)
+	addTexture((*renderTarget)[0]); //HDR scene
+
+	setShaderPaths("", "", "", "", "", "Shader/luminanceHistogram.comp.spv");
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	createComputePipeline();
+}
+
+void LuminanceHistogramMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+	createComputePipeline();
+}
+
+void ExposureAdaptationMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
+{
+	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
+
+	std::vector<VkDescriptorPoolSize> descPoolSize;
+	descPoolSize.resize(3);
+
+	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[0].descriptorCount = 1;
+
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[2].descriptorCount = 1;
+
+	createDescriptorPool(descPoolSize);
+
+	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
+	descLayoutBinding.resize(descPoolSize.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(descLayoutBinding.size()); i++)
 	{
-		addTexture((*renderTarget)[i]);
+		createLayoutBinding(descLayoutBinding[i], i, descPoolSize[i].descriptorCount, descPoolSize[i].type, VK_SHADER_STAGE_COMPUTE_BIT);
 	}
+	createDescriptorSetLayout(descLayoutBinding);
 
-	//addTexture(pDepthImageView);
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
 
-	addBuffer(cameraBuffer);
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(ExposureInfo));
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(glm::vec4));
+	createBufferInfo(bufferInfos[2], *buffers[2], 0, sizeof(perframeBuffer));
 
-	setShaderPaths("Shader/postProcess.vert.spv", "Shader/compositePostProcess.frag.spv", "", "", "", "");
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
+	descriptorSetLayouts.resize(1);
+	descriptorSetLayouts[0] = descriptorSetLayout;
 
-	createDescriptor(ScreenOffsets, sizeScale);
+	createDescriptorSet(descriptorSetLayouts);
 
-	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-	colorBlendAttachments.resize(1);
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	descriptorWrites.resize(descPoolSize.size());
 
-	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[1], NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, nullptr, &bufferInfos[2], NULL);
 
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
-void CompositePostProcessMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+void ExposureAdaptationMaterial::createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+	VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+	glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView)
 {
-	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+	AssetDatabase::GetInstance()->materialList.push_back(name);
+	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
-	std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-	colorBlendAttachments.resize(1);
+	LoadFromFilename(vulkanApp, name);
 
-	createColorBlendAttachmentState(colorBlendAttachments[0], VK_FALSE, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+	addBuffer(perFrameBuffer);
 
-	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
-	createGraphicsPipeline(VK_POLYGON_MODE_FILL, 1.0f, VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_SAMPLE_COUNT_1_BIT, colorBlendAttachments, VK_FALSE, depthStencil, 0.0f, renderPass);
+	setShaderPaths("", "", "", "", "", "Shader/exposureAdaptation.comp.spv");
+	createDescriptor(ScreenOffsets, sizeScale);
+
+	createComputePipeline();
 }
 
+void ExposureAdaptationMaterial::updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass)
+{
+	createDescriptor(screenOffsetParam, sizeScalescreenOffsetParam);
+	createComputePipeline();
+}
 
 void ToneMappingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam)
 {
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(1);
+	descPoolSize.resize(4);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
 
+	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	descPoolSize[1].descriptorCount = 1;
+
+	descPoolSize[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	descPoolSize[2].descriptorCount = 1;
+
+	descPoolSize[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descPoolSize[3].descriptorCount = 1;
+
 	createDescriptorPool(descPoolSize);
 
 	std::vector<VkDescriptorSetLayoutBinding> descLayoutBinding;
 	descLayoutBinding.resize(descPoolSize.size());
 
 	createLayoutBinding(descLayoutBinding[0], 0, 1, descPoolSize[0].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[1], 1, 1, descPoolSize[1].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[2], 2, 1, descPoolSize[2].type, VK_SHADER_STAGE_FRAGMENT_BIT);
+	createLayoutBinding(descLayoutBinding[3], 3, 1, descPoolSize[3].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 
 	createDescriptorSetLayout(descLayoutBinding);
 
 
 	std::vector<VkDescriptorImageInfo> ImageInfos;
-	ImageInfos.resize(1);
+	ImageInfos.resize(2);
 
 	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
+	createImageInfo(ImageInfos[1], textures[1]->sampledLayout, textures[1]->textureImageView, textures[1]->textureSampler); //bloom
+
+	std::vector<VkDescriptorBufferInfo> bufferInfos;
+	bufferInfos.resize(buffers.size());
+
+	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(ExposureInfo)); //exposure written by the adaptation pass
+	createBufferInfo(bufferInfos[1], *buffers[1], 0, sizeof(glm::vec4));
 
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
@@ -1948,6 +2933,9 @@ void ToneMappingMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec
 	descriptorWrites.resize(descPoolSize.size());
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
+	createDescriptorWrite(descriptorWrites[2], 2, 2, descPoolSize[2].type, &ImageInfos[1], nullptr, NULL);
+	createDescriptorWrite(descriptorWrites[3], 3, 3, descPoolSize[3].type, nullptr, &bufferInfos[1], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
@@ -1965,8 +2953,10 @@ void ToneMappingMaterial::createPipeline(std::string name, std::string albedo, s
 
 	LoadFromFilename(vulkanApp, name);
 	addTexture((*renderTarget)[0]);
+	addTexture((*renderTarget)[1]); //bloom
 
 	setShaderPaths("Shader/postProcess.vert.spv", "Shader/toneMapping.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	createDescriptor(ScreenOffsets, SizeScale);
 
@@ -2046,6 +3036,7 @@ void PresentMaterial::createPipeline(std::string name, std::string albedo, std::
 	addTexture((*renderTarget)[0]);
 
 	setShaderPaths("Shader/postProcess.vert.spv", "Shader/postProcess.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	createDescriptor(ScreenOffsets, SizeScale);
 
@@ -2076,12 +3067,10 @@ void DepthMipmapMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec
 	Material::createDescriptor(screenOffsetParam, sizeScaleParam);
 
 	std::vector<VkDescriptorPoolSize> descPoolSize;
-	descPoolSize.resize(2);
+	descPoolSize.resize(1);
 
 	descPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 	descPoolSize[0].descriptorCount = 1;
-	descPoolSize[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	descPoolSize[1].descriptorCount = 1;
 
 	createDescriptorPool(descPoolSize);
 
@@ -2089,7 +3078,6 @@ void DepthMipmapMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec
 	descLayoutBinding.resize(descPoolSize.size());
 
 	createLayoutBinding(descLayoutBinding[0], 0, 1, descPoolSize[0].type, VK_SHADER_STAGE_FRAGMENT_BIT);
-	createLayoutBinding(descLayoutBinding[1], 1, 1, descPoolSize[1].type, VK_SHADER_STAGE_FRAGMENT_BIT);
 
 	createDescriptorSetLayout(descLayoutBinding);
 
@@ -2099,11 +3087,6 @@ void DepthMipmapMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec
 
 	createImageInfo(ImageInfos[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, textures[0]->textureImageView, textures[0]->textureSampler);
 
-	std::vector<VkDescriptorBufferInfo> bufferInfos;
-	bufferInfos.resize(buffers.size());
-
-	createBufferInfo(bufferInfos[0], *buffers[0], 0, sizeof(glm::vec4));
-
 	std::vector<VkDescriptorSetLayout> descriptorSetLayouts;
 	descriptorSetLayouts.resize(1);
 	descriptorSetLayouts[0] = descriptorSetLayout;
@@ -2114,7 +3097,6 @@ void DepthMipmapMaterial::createDescriptor(glm::vec2 screenOffsetParam, glm::vec
 	descriptorWrites.resize(descPoolSize.size());
 
 	createDescriptorWrite(descriptorWrites[0], 0, 0, descPoolSize[0].type, &ImageInfos[0], nullptr, NULL);
-	createDescriptorWrite(descriptorWrites[1], 1, 1, descPoolSize[1].type, nullptr, &bufferInfos[0], NULL);
 
 	vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
@@ -2131,11 +3113,11 @@ void DepthMipmapMaterial::createPipeline(std::string name, std::string albedo, s
 	AssetDatabase::GetInstance()->SaveAsset<Material>(this, name);
 
 	LoadFromFilename(vulkanApp, name);
+	//previous Hi-Z level
 	addTexture(pDepthImageView);
 
-	addBuffer(cameraBuffer);
-
 	setShaderPaths("Shader/postProcess.vert.spv", "Shader/depthMipmap.frag.spv", "", "", "", "");
+	bFullscreenPass = true;
 
 	createDescriptor(ScreenOffsets, SizeScale);
 
@@ -8,9 +8,10 @@ class Material : public Asset
 {
 public:
 
-	Material():vertexShaderPath(""), tessellationControlShaderPath(""), tessellationEvaluationShaderPath(""), geometryShaderPath(""), fragmentShaderPath(""), computeShaderPath("")
+	Material():vertexShaderPath(""), tessellationControlShaderPath(""), tessellationEvaluationShaderPath(""), geometryShaderPath(""), fragmentShaderPath(""), computeShaderPath(""), bFullscreenPass(false)
 	{
-		
+		drawVertexCount = 3;
+		drawInstanceCount = 1;
 	}
 
 	virtual ~Material();
@@ -75,6 +76,18 @@ public:
 
 	}
 
+	//textures of materials that draw scene geometry keep only the mips their screen size needs
+	virtual bool streamsTextureMips()
+	{
+		return false;
+	}
+
+	//called by the texture streamer after it swapped the chain of one of the textures
+	virtual void updateResidentLevels()
+	{
+
+	}
+
 	virtual void releasePipeline();
 	virtual void shutDown();
 
@@ -95,11 +108,20 @@ public:
 	uint32_t numPointLights;
 	uint32_t numDirectionalLights;
 
+	//recordFullscreenCommandBuffers draws these without vertex buffers, one triangle unless the material builds its own primitives
+	uint32_t drawVertexCount;
+	uint32_t drawInstanceCount;
+
 	bool isComputeShader()
 	{
 		return computeShaderPath == "" ? true : false;
 	}
 
+	bool isFullscreenPass()
+	{
+		return bFullscreenPass;
+	}
+
 protected:
 
 	VkDescriptorPool descriptorPool;
@@ -117,12 +139,32 @@ protected:
 
 	std::string computeShaderPath;
 	glm::ivec3 computeDispatchSize;
+
+	//drawn by recordFullscreenCommandBuffers with no vertex input, the vertex shader builds its primitives from gl_VertexIndex
+	bool bFullscreenPass;
 };
 
 class GbufferMaterial : public Material
 {
 public:
 
+	virtual ~GbufferMaterial()
+	{
+		vkDestroyBuffer(vulkanApp->getDevice(), residentLevelBuffer, nullptr);
+		vkFreeMemory(vulkanApp->getDevice(), residentLevelBufferMem, nullptr);
+
+		Material::~Material();
+	}
+
+	virtual bool streamsTextureMips()
+	{
+		return true;
+	}
+
+	virtual void updateResidentLevels();
+
+	void createLocalBuffer();
+
 	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
 
 	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
@@ -133,6 +175,10 @@ public:
 
 
 private:
+
+	//first resident level of each gbuffer texture, explicit LODs in gbuffers.frag are relative to the full chain
+	VkBuffer residentLevelBuffer;
+	VkDeviceMemory residentLevelBufferMem;
 };
 
 class FrustumCullingMaterial : public Material
@@ -214,6 +260,51 @@ private:
 	//VkDeviceMemory ubosMem;
 };
 
+class LightCullingMaterial : public Material
+{
+public:
+
+	virtual ~LightCullingMaterial()
+	{
+		vkDestroyBuffer(vulkanApp->getDevice(), clusterInfoBuffer, nullptr);
+		vkFreeMemory(vulkanApp->getDevice(), clusterInfoBufferMem, nullptr);
+
+		vkDestroyBuffer(vulkanApp->getDevice(), lightGridBuffer, nullptr);
+		vkFreeMemory(vulkanApp->getDevice(), lightGridBufferMem, nullptr);
+
+		vkDestroyBuffer(vulkanApp->getDevice(), lightIndexBuffer, nullptr);
+		vkFreeMemory(vulkanApp->getDevice(), lightIndexBufferMem, nullptr);
+
+		Material::~Material();
+	}
+
+	virtual void shutDown()
+	{
+		Material::shutDown();
+	}
+
+	void createLocalBuffer();
+	void updateClusterInfoBuffer(ClusterInfo &clusterInfo);
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+	VkBuffer clusterInfoBuffer;
+	VkBuffer lightGridBuffer;
+	VkBuffer lightIndexBuffer;
+
+private:
+
+	VkDeviceMemory clusterInfoBufferMem;
+	VkDeviceMemory lightGridBufferMem;
+	VkDeviceMemory lightIndexBufferMem;
+};
+
 class UberMaterial : public Material
 {
 public:
@@ -235,9 +326,6 @@ public:
 
 	virtual ~BruteForceMaterial()
 	{
-		vkDestroyBuffer(vulkanApp->getDevice(), planeInfoBuffer, nullptr);
-		vkFreeMemory(vulkanApp->getDevice(), planeInfoBufferMem, nullptr);
-
 		Material::~Material();
 	}
 
@@ -249,14 +337,21 @@ public:
 
 	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
 
-	void createLocalBuffer();
-	void updatePlaneInfoPackBuffer(PlaneInfoPack &planeInfoPack);
-
-	VkBuffer planeInfoBuffer;
-private:
+	//min depth pyramid above the depth buffer, must be set before createPipeline
+	void setHiZTextures(std::vector<Texture*> &hiZTexturesParam)
+	{
+		hiZTextures = hiZTexturesParam;
+	}
 
+	//index + 1 of the reflective plane under each pixel, must be set before createPipeline
+	void setPlaneIDTexture(Texture *planeIDTextureParam)
+	{
+		planeIDTexture = planeIDTextureParam;
+	}
 
-	VkDeviceMemory planeInfoBufferMem;
+	std::vector<Texture*> hiZTextures;
+	Texture *planeIDTexture;
+private:
 };
 
 
@@ -266,9 +361,6 @@ public:
 
 	virtual ~ScreenSpaceProjectionMaterial()
 	{
-		vkDestroyBuffer(vulkanApp->getDevice(), planeInfoBuffer, nullptr);
-		vkFreeMemory(vulkanApp->getDevice(), planeInfoBufferMem, nullptr);
-
 		Material::~Material();
 	}
 
@@ -277,8 +369,6 @@ public:
 		Material::shutDown();
 	}
 
-	void updatePlaneInfoPackBuffer(PlaneInfoPack &planeInfoPack);
-
 	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
 
 	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
@@ -287,15 +377,7 @@ public:
 
 	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
 
-	void createLocalBuffer();
-
-	VkBuffer planeInfoBuffer;
 private:
-
-	
-	VkDeviceMemory planeInfoBufferMem;
-
-	
 };
 
 class ScreenSpaceProjectionMaterial2 : public Material
@@ -304,9 +386,6 @@ public:
 
 	virtual ~ScreenSpaceProjectionMaterial2()
 	{
-		vkDestroyBuffer(vulkanApp->getDevice(), planeInfoBuffer, nullptr);
-		vkFreeMemory(vulkanApp->getDevice(), planeInfoBufferMem, nullptr);
-
 		Material::~Material();
 	}
 
@@ -315,8 +394,6 @@ public:
 		Material::shutDown();
 	}
 
-	void updatePlaneInfoPackBuffer(PlaneInfoPack &planeInfoPack);
-
 	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
 
 	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
@@ -325,15 +402,7 @@ public:
 
 	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
 
-	void createLocalBuffer();
-
-	VkBuffer planeInfoBuffer;
 private:
-
-
-	VkDeviceMemory planeInfoBufferMem;
-
-
 };
 
 class ScreenSpaceReflectionMaterial : public Material
@@ -354,6 +423,30 @@ public:
 
 	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
 
+	//index + 1 of the reflective plane under each pixel, must be set before createPipeline
+	void setPlaneIDTexture(Texture *planeIDTextureParam)
+	{
+		planeIDTexture = planeIDTextureParam;
+	}
+
+	Texture *planeIDTexture;
+private:
+};
+
+//writes index + 1 of the nearest visible reflective plane under each pixel, 0 if there is none
+//one quad per plane is rasterized, so the cost follows the covered pixels instead of pixels times planes
+class PlaneIDMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
 private:
 };
 
@@ -372,6 +465,36 @@ public:
 private:
 };
 
+class CloudTemporalMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
+class CloudUpsampleMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
 class HolePatchingMaterial : public Material
 {
 public:
@@ -387,6 +510,38 @@ public:
 private:
 };
 
+//joint bilateral upsample of the reduced resolution reflection, guided by full resolution depth and normals
+class SSRUpsampleMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
+//blends the reflection with the reprojected history of the previous frames
+class SSRTemporalMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
 
 
 class HorizontalBlurMaterial : public Material
@@ -437,6 +592,70 @@ public:
 private:
 };
 
+//13 tap downsample into the next smaller level of the bloom pyramid
+class BloomDownsampleMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
+//tent upsample of the smaller bloom level, added to the downsampled level of the same size
+class BloomUpsampleMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
+//bins the log luminance of the HDR scene, each workgroup reduces its tile in shared memory first
+class LuminanceHistogramMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
+//single workgroup pass turning the histogram into an exposure that adapts over time
+class ExposureAdaptationMaterial : public Material
+{
+public:
+
+	virtual void createDescriptor(glm::vec2 screenOffsetParam, glm::vec4 sizeScaleParam);
+
+	virtual void createPipeline(std::string name, std::string albedo, std::string specular, std::string normal, std::string emissive, VkBuffer *objectBuffer, VkBuffer *cameraBuffer,
+		VkBuffer *pointLightBuffer, size_t numPointLight, VkBuffer *directionalLightBuffer, size_t numDirectionalLight, VkBuffer *perFrameBuffer,
+		glm::vec2 ScreenOffsets, glm::vec4 sizeScale, VkRenderPass renderPass, std::vector<Texture*> *renderTarget, Texture *pDepthImageView);
+
+	virtual void updatePipeline(glm::vec2 screenOffsetParam, glm::vec4 sizeScalescreenOffsetParam, VkRenderPass renderPass);
+
+private:
+};
+
 class ToneMappingMaterial : public Material
 {
 public:
@@ -1,7 +1,6 @@
 #include "Texture.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb-master/stb_image.h>
+#include "TextureCooker.h"
+#include "AssetDB.h"
 
 
 void Texture::connectDevice(Vulkan *vulkanAppParam)
@@ -11,150 +10,265 @@ void Texture::connectDevice(Vulkan *vulkanAppParam)
 
 void Texture::LoadFromFilename(Vulkan *vulkanAppParam, std::string pathParam)
 {
+	PROFILE_ZONE("Texture::LoadFromFilename");
+
 	connectDevice(vulkanAppParam);
 	path = pathParam;
 
-	loadTextureImage(path);
-
-	vulkanApp->createImageView(textureImage, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevel, 0, 1, textureImageView);
 	vulkanApp->createTextureSampler(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_TRUE, 16.0, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE,
 		VK_SAMPLER_MIPMAP_MODE_LINEAR, 0.0f, 0.0f, 5.0f, textureSampler);
+
+	//returns right away, the streamer cooks the container on its worker thread when only the grey texel could be made
+	//and swaps in the levels the renderer asks for later
+	bool bMipTail = createPlaceholder(TextureCooker::getCookedPath(path));
+	AssetDatabase::GetInstance()->textureStreamer.request(this, !bMipTail);
+}
+
+static VkDeviceSize getContainerMipSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth)
+{
+	switch (format)
+	{
+	//BC blocks are 4x4 in each slice
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC4_UNORM_BLOCK:
+		return static_cast<VkDeviceSize>((width + 3) / 4) * ((height + 3) / 4) * depth * 8;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC5_UNORM_BLOCK:
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+		return static_cast<VkDeviceSize>((width + 3) / 4) * ((height + 3) / 4) * depth * 16;
+	case VK_FORMAT_R8G8B8A8_UNORM:
+		return static_cast<VkDeviceSize>(width) * height * depth * 4;
+	default:
+		throw std::runtime_error("failed to find a supported texture format!");
+	}
 }
 
+static VkDeviceSize getContainerLevelsSize(const TextureContainerHeader &header, uint32_t firstLevel, uint32_t lastLevel)
+{
+	VkDeviceSize size = 0;
+
+	for (uint32_t i = firstLevel; i < lastLevel; i++)
+	{
+		size += getContainerMipSize(static_cast<VkFormat>(header.format), glm::max(header.width >> i, 1u), glm::max(header.height >> i, 1u), glm::max(header.depth >> i, 1u));
+	}
+
+	return size;
+}
 
+static bool isValidContainerHeader(const TextureContainerHeader &header)
+{
+	return memcmp(header.magic, "JTEX", 4) == 0 && header.version == TEXTURE_CONTAINER_VERSION && header.mipLevels != 0;
+}
 
-void Texture::loadTextureImage(std::string path)
+static uint32_t getContainerTailLevel(const TextureContainerHeader &header)
 {
-	stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	
+	uint32_t tailLevel = 0;
 
-	if (!pixels)
+	while (tailLevel + 1 < header.mipLevels && glm::max(header.width >> tailLevel, header.height >> tailLevel) > TEXTURE_PLACEHOLDER_SIZE)
 	{
-		throw std::runtime_error("failed to load texture image!");
+		tailLevel++;
 	}
 
-	mipLevel = glm::max(static_cast<int>(glm::floor(glm::log2(static_cast<float>(glm::min(texWidth, texHeight))))), 0) + 1;
+	return tailLevel;
+}
+
+void Texture::loadTextureContainer(std::string containerPath, std::vector<unsigned char> *pPixels)
+{
+	//the whole container in one read
+	std::vector<char> fileData = readFile(containerPath);
+
+	createContainerImage(fileData, 0, textureImage, textureImageMemory, textureImageView, pPixels);
+	residentLevel = 0;
+}
+
+bool Texture::readContainerLevels(std::string containerPath, uint32_t &firstLevel, std::vector<char> &fileData)
+{
+	std::ifstream file(containerPath, std::ios::binary);
 
-	VkDeviceSize imageSize = vulkanApp->createImage(VK_IMAGE_TYPE_2D, texWidth, texHeight, 1, mipLevel, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED,
-		VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+	if (!file.is_open())
+		return false;
 
-	vulkanApp->createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	TextureContainerHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(TextureContainerHeader));
 
-	VkDeviceSize baseImageSize = texWidth * texHeight * 4;
+	if (!file.good() || !isValidContainerHeader(header))
+		return false;
 
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), stagingBufferMemory, 0, baseImageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(baseImageSize));
-	vkUnmapMemory(vulkanApp->getDevice(), stagingBufferMemory);
+	firstLevel = glm::min(firstLevel, getContainerTailLevel(header));
 
-	stbi_image_free(pixels);	
-	
-	vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
-	
-	vulkanApp->copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1, 0);
+	//the levels are stored from the base, so a shorter chain is the end of the file
+	fileData.resize(sizeof(TextureContainerHeader) + static_cast<size_t>(getContainerLevelsSize(header, firstLevel, header.mipLevels)));
+	memcpy(fileData.data(), &header, sizeof(TextureContainerHeader));
 
-	//vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
-	//Prepare base mip level
-	vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
+	file.seekg(sizeof(TextureContainerHeader) + getContainerLevelsSize(header, 0, firstLevel));
+	file.read(fileData.data() + sizeof(TextureContainerHeader), fileData.size() - sizeof(TextureContainerHeader));
 
-	//Generating the mip-chain
+	return file.good();
+}
 
-	for (int32_t i = 1; i < mipLevel; i++)
+uint64_t Texture::createContainerImage(const std::vector<char> &fileData, uint32_t firstLevel, VkImage &image, VkDeviceMemory &imageMemory, VkImageView &imageView,
+	std::vector<unsigned char> *pPixels)
+{
+	if (fileData.size() < sizeof(TextureContainerHeader))
 	{
-		VkImageBlit imageBlit{};
-
-		// Source
-		imageBlit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageBlit.srcSubresource.layerCount = 1;
-		imageBlit.srcSubresource.mipLevel = i - 1;
-		imageBlit.srcOffsets[1].x = int32_t(texWidth >> (i - 1));
-		imageBlit.srcOffsets[1].y = int32_t(texHeight >> (i - 1));
-		imageBlit.srcOffsets[1].z = 1;
-
-		// Destination
-		imageBlit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageBlit.dstSubresource.layerCount = 1;
-		imageBlit.dstSubresource.mipLevel = i;
-		imageBlit.dstOffsets[1].x = int32_t(texWidth >> i);
-		imageBlit.dstOffsets[1].y = int32_t(texHeight >> i);
-		imageBlit.dstOffsets[1].z = 1;
-
-		VkImageSubresourceRange mipSubRange = {};
-		mipSubRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		mipSubRange.baseMipLevel = i;
-		mipSubRange.levelCount = 1;
-		mipSubRange.layerCount = 1;
-
-		vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue(), mipSubRange);
-
-		vulkanApp->blitImage(textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, VK_FILTER_LINEAR,
-			imageBlit,	vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
-		
-		vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue(), mipSubRange);
-
-		
+		throw std::runtime_error("failed to load texture container!");
 	}
 
-	VkImageSubresourceRange subresourceRange = {};
-	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = mipLevel;
-	subresourceRange.layerCount = 1;
+	TextureContainerHeader header;
+	memcpy(&header, fileData.data(), sizeof(TextureContainerHeader));
 
-	vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue(), subresourceRange);
+	if (!isValidContainerHeader(header) || firstLevel >= header.mipLevels ||
+		fileData.size() < sizeof(TextureContainerHeader) + getContainerLevelsSize(header, firstLevel, header.mipLevels))
+	{
+		throw std::runtime_error("failed to load texture container!");
+	}
 
-	vkDestroyBuffer(vulkanApp->getDevice(), stagingBuffer, nullptr);
-	vkFreeMemory(vulkanApp->getDevice(), stagingBufferMemory, nullptr);
+	VkFormat format = static_cast<VkFormat>(header.format);
+
+	texWidth = static_cast<int>(header.width);
+	texHeight = static_cast<int>(header.height);
+	texChannels = 4;
+	mipLevel = static_cast<int>(header.mipLevels);
+	containerHeader = header;
+
+	const char* mipData = fileData.data() + sizeof(TextureContainerHeader);
+
+	//base level for CPU side work, only meaningful for uncompressed containers
+	if (pPixels)
+	{
+		pPixels->clear();
+
+		if (format == VK_FORMAT_R8G8B8A8_UNORM && firstLevel == 0)
+			pPixels->assign(mipData, mipData + getContainerMipSize(format, header.width, header.height, header.depth));
+	}
+
+	return createContainerLevels(header, mipData, firstLevel, image, imageMemory, imageView);
 }
 
-void Texture::loadTexture2DArrayImage(std::string path, std::string extension)
+uint64_t Texture::createContainerLevels(const TextureContainerHeader &header, const char *levelData, uint32_t firstLevel, VkImage &image, VkDeviceMemory &imageMemory, VkImageView &imageView)
 {
-	std::string tempPath = path + "_0" + extension;
+	VkFormat format = static_cast<VkFormat>(header.format);
+
+	uint32_t levelCount = header.mipLevels - firstLevel;
+	uint32_t baseWidth = glm::max(header.width >> firstLevel, 1u);
+	uint32_t baseHeight = glm::max(header.height >> firstLevel, 1u);
+	uint32_t baseDepth = glm::max(header.depth >> firstLevel, 1u);
 
-	stbi_uc* pixels = stbi_load(tempPath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	std::vector<VkBufferImageCopy> regions(levelCount);
+	VkDeviceSize dataSize = 0;
 
-	int texDepth = texWidth;
+	for (uint32_t i = 0; i < levelCount; i++)
+	{
+		uint32_t width = glm::max(baseWidth >> i, 1u);
+		uint32_t height = glm::max(baseHeight >> i, 1u);
+		uint32_t depth = glm::max(baseDepth >> i, 1u);
+
+		regions[i] = {};
+		regions[i].bufferOffset = dataSize;
+		regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		regions[i].imageSubresource.mipLevel = i;
+		regions[i].imageSubresource.baseArrayLayer = 0;
+		regions[i].imageSubresource.layerCount = 1;
+		regions[i].imageOffset = { 0, 0, 0 };
+		regions[i].imageExtent = { width, height, depth };
+
+		dataSize += getContainerMipSize(format, width, height, depth);
+	}
 
-	VkDeviceSize imageArraySize = texWidth * texHeight * texDepth * 4;
-	
-	vulkanApp->createBuffer(imageArraySize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	VkImageType imageType = header.depth > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
 
-	vulkanApp->createImage(VK_IMAGE_TYPE_3D, texWidth, texHeight, texDepth, 1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED,
-		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureImageMemory);
+	//the image is filled on the transfer queue, so it stays exclusive to change owner
+	vulkanApp->createImage(imageType, baseWidth, baseHeight, baseDepth, levelCount, 1, format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory,
+		VK_SHARING_MODE_EXCLUSIVE);
 
-	stbi_image_free(pixels);
+	VkImageSubresourceRange subresourceRange = {};
+	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	subresourceRange.baseMipLevel = 0;
+	subresourceRange.levelCount = levelCount;
+	subresourceRange.layerCount = 1;
 
+	//staged and recorded, the renderer submits it with the next upload flush
+	uint64_t ticket = vulkanApp->getUploadContext()->uploadImage(levelData, dataSize, image, regions, subresourceRange);
 
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	VkComponentMapping components = {};
 
-	for (int i = 0; i < texDepth; i++)
+	if (header.flags & TEXTURE_CONTAINER_GRAYSCALE)
 	{
-		tempPath = path + "_" + std::to_string(i) + extension;
+		components.r = VK_COMPONENT_SWIZZLE_R;
+		components.g = VK_COMPONENT_SWIZZLE_R;
+		components.b = VK_COMPONENT_SWIZZLE_R;
+		components.a = VK_COMPONENT_SWIZZLE_ONE;
+	}
 
-		pixels = stbi_load(tempPath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	vulkanApp->createImageView(image, header.depth > 1 ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D, format, VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1, imageView, components);
 
-		if (!pixels)
-		{
-			throw std::runtime_error("failed to load texture image!");
-		}
+	return ticket;
+}
 
-		void* data;
-		vkMapMemory(vulkanApp->getDevice(), stagingBufferMemory, imageSize * i, imageSize, 0, &data);
-		memcpy(data, pixels, static_cast<size_t>(imageSize));
-		vkUnmapMemory(vulkanApp->getDevice(), stagingBufferMemory);
+bool Texture::createPlaceholder(std::string containerPath)
+{
+	uint32_t firstLevel = TEXTURE_MIP_TAIL;
+	std::vector<char> tailData;
+
+	if (readContainerLevels(containerPath, firstLevel, tailData))
+	{
+		createContainerImage(tailData, firstLevel, textureImage, textureImageMemory, textureImageView);
+		residentLevel = firstLevel;
+		return true;
+	}
 
-		stbi_image_free(pixels);
-	}	
+	//not cooked yet, a single mid grey texel, or a flat tangent space normal for normal maps
+	TextureContainerHeader greyHeader = {};
+	memcpy(greyHeader.magic, "JTEX", 4);
+	greyHeader.version = TEXTURE_CONTAINER_VERSION;
+	greyHeader.width = 1;
+	greyHeader.height = 1;
+	greyHeader.depth = 1;
+	greyHeader.mipLevels = 1;
+	greyHeader.format = VK_FORMAT_R8G8B8A8_UNORM;
+
+	const unsigned char grey[4] = { 128, 128, 128, 255 };
+	const unsigned char flatNormal[4] = { 128, 128, 255, 255 };
+
+	texWidth = 1;
+	texHeight = 1;
+	texChannels = 4;
+	mipLevel = 1;
+	containerHeader = greyHeader;
+	residentLevel = 0;
+
+	createContainerLevels(greyHeader, reinterpret_cast<const char*>(TextureCooker::isNormalMap(path) ? flatNormal : grey), 0, textureImage, textureImageMemory, textureImageView);
+	return false;
+}
+
+void Texture::replaceImage(VkImage image, VkDeviceMemory imageMemory, VkImageView imageView, uint32_t firstLevel)
+{
+	vkDestroyImageView(vulkanApp->getDevice(), textureImageView, nullptr);
+	vkDestroyImage(vulkanApp->getDevice(), textureImage, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), textureImageMemory, nullptr);
+
+	textureImage = image;
+	textureImageMemory = imageMemory;
+	textureImageView = imageView;
+	residentLevel = firstLevel;
+}
 
-	vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
-	vulkanApp->copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), static_cast<uint32_t>(texDepth), 0);
-	vulkanApp->transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
-	
-	vkDestroyBuffer(vulkanApp->getDevice(), stagingBuffer, nullptr);
-	vkFreeMemory(vulkanApp->getDevice(), stagingBufferMemory, nullptr);
+uint32_t Texture::getTailLevel()
+{
+	return getContainerTailLevel(containerHeader);
+}
+
+VkDeviceSize Texture::getLevelsSize(uint32_t firstLevel)
+{
+	return getContainerLevelsSize(containerHeader, glm::min(firstLevel, containerHeader.mipLevels - 1), containerHeader.mipLevels);
+}
+
+void Texture::loadVolumeTexture(std::string containerPath, std::vector<unsigned char> *pPixels)
+{
+	loadTextureContainer(containerPath, pPixels);
 
-	vulkanApp->createImageView(textureImage, VK_IMAGE_VIEW_TYPE_3D, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1, textureImageView);
 	vulkanApp->createTextureSampler(VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_REPEAT, VK_FALSE, 1, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE,
-		VK_SAMPLER_MIPMAP_MODE_LINEAR, 0.0f, 0.0f, 0.0f, textureSampler);
+		VK_SAMPLER_MIPMAP_MODE_LINEAR, 0.0f, 0.0f, static_cast<float>(mipLevel), textureSampler);
 }
\ No newline at end of file
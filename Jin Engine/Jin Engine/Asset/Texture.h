@@ -2,10 +2,33 @@
 
 #include "Asset.h"
 
+#define TEXTURE_CONTAINER_VERSION 4
+#define TEXTURE_PLACEHOLDER_SIZE 16 //largest level of the mip tail that stands in while a texture streams
+#define TEXTURE_MIP_TAIL 0xFFFFFFFF //first level of a read that only wants the mip tail
+
+enum TEXTURE_CONTAINER_FLAG
+{
+	TEXTURE_CONTAINER_GRAYSCALE = 1, //single channel, viewed as RRR1
+	TEXTURE_CONTAINER_NORMAL_MAP = 2 //tangent space XY, Z is reconstructed in the shaders, BC3 when the alpha holds metallic
+};
+
+//single file 2D or 3D texture, the mip chain follows the header tightly packed from the base level
+struct TextureContainerHeader
+{
+	char magic[4]; //"JTEX"
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+	uint32_t mipLevels;
+	uint32_t format; //VkFormat, R8G8B8A8_UNORM or a BC block format
+	uint32_t flags; //TEXTURE_CONTAINER_FLAG
+};
+
 class Texture : public Asset
 {
 public:
-	Texture():mipLevel(0)
+	Texture():mipLevel(0), residentLevel(0), sampledLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
 	{
 
 	}
@@ -19,8 +42,31 @@ public:
 
 	void LoadFromFilename(Vulkan *vulkanAppParam, std::string pathParam);
 
-	void loadTextureImage(std::string path);
-	void loadTexture2DArrayImage(std::string path, std::string extension);
+	//uploads every mip of a cooked container as stored, pPixels receives the base level of uncompressed containers
+	void loadTextureContainer(std::string containerPath, std::vector<unsigned char> *pPixels = NULL);
+	void loadVolumeTexture(std::string containerPath, std::vector<unsigned char> *pPixels = NULL);
+
+	//creates the image of a container read into memory and records its upload, returns the upload ticket
+	//fileData is the header followed by the levels from firstLevel on
+	uint64_t createContainerImage(const std::vector<char> &fileData, uint32_t firstLevel, VkImage &image, VkDeviceMemory &imageMemory, VkImageView &imageView,
+		std::vector<unsigned char> *pPixels = NULL);
+
+	//reads the header and the levels [firstLevel, mipLevels) of a cooked container, firstLevel is clamped to the mip tail
+	//safe on any thread, returns false when the container can not be read
+	static bool readContainerLevels(std::string containerPath, uint32_t &firstLevel, std::vector<char> &fileData);
+
+	//the mip tail of the cooked container, or a single texel when it is not cooked yet, returns false for the single texel
+	//the texel is mid grey, or a flat normal for *_norm textures
+	bool createPlaceholder(std::string containerPath);
+
+	//destroys the current image and takes over the given one that starts at firstLevel, its descriptors are rewritten by the caller
+	void replaceImage(VkImage image, VkDeviceMemory imageMemory, VkImageView imageView, uint32_t firstLevel);
+
+	//first level of the mip tail, the coarsest chain a streamed texture keeps
+	uint32_t getTailLevel();
+
+	//device size of the levels [firstLevel, mipLevels) as stored in the container
+	VkDeviceSize getLevelsSize(uint32_t firstLevel);
 
 	void setMiplevel(int mipLevelParam)
 	{
@@ -72,14 +118,32 @@ public:
 
 	int mipLevel;
 
+	//level of the container the image starts at, 0 when the whole chain is resident
+	uint32_t residentLevel;
+
+	//layout the image is in when a later pass samples it, compute targets stay GENERAL
+	VkImageLayout sampledLayout;
+
+	int getWidth()
+	{
+		return texWidth;
+	}
+
+	int getHeight()
+	{
+		return texHeight;
+	}
+
 private:
 
+	//levels [firstLevel, mipLevels) of a container, levelData starts at firstLevel
+	uint64_t createContainerLevels(const TextureContainerHeader &header, const char *levelData, uint32_t firstLevel, VkImage &image, VkDeviceMemory &imageMemory, VkImageView &imageView);
+
 	int texWidth;
 	int texHeight;
 	int texChannels;
 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
+	TextureContainerHeader containerHeader;
 
 	
 };
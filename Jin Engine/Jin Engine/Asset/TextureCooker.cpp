@@ -0,0 +1,563 @@
+#include "TextureCooker.h"
+
+#include <cctype>
+#include <cfloat>
+#include <climits>
+#include <sys/stat.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb-master/stb_image.h>
+
+static void writeTextureContainer(std::string containerPath, TextureContainerHeader &header, std::vector<std::vector<unsigned char>> &mips)
+{
+	std::ofstream file(containerPath, std::ios::binary);
+
+	if (!file.is_open())
+	{
+		throw std::runtime_error("failed to open file!");
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(TextureContainerHeader));
+
+	for (size_t i = 0; i < mips.size(); i++)
+	{
+		file.write(reinterpret_cast<const char*>(mips[i].data()), mips[i].size());
+	}
+
+	file.close();
+}
+
+//file name without the directories and the extension
+static std::string getFileStem(std::string sourcePath)
+{
+	size_t nameStart = sourcePath.find_last_of("/\\");
+	std::string name = nameStart == std::string::npos ? sourcePath : sourcePath.substr(nameStart + 1);
+
+	return name.substr(0, name.find_last_of('.'));
+}
+
+static std::string toLower(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return text;
+}
+
+//noise and lookup tables are read as exact values, block compression would change them
+static bool isDataTexture(std::string sourcePath)
+{
+	std::string path = toLower(sourcePath);
+	std::string name = toLower(getFileStem(sourcePath));
+
+	return path.find("/noise/") != std::string::npos || path.find("\\noise\\") != std::string::npos ||
+		name.find("noise") != std::string::npos || (name.size() >= 3 && name.compare(name.size() - 3, 3, "lut") == 0);
+}
+
+bool TextureCooker::isNormalMap(std::string sourcePath)
+{
+	std::string name = getFileStem(sourcePath);
+
+	return name.size() >= 5 && name.compare(name.size() - 5, 5, "_norm") == 0;
+}
+
+//0 when the file does not exist
+static time_t getModifiedTime(std::string path)
+{
+	struct stat fileStat;
+
+	if (stat(path.c_str(), &fileStat) != 0)
+		return 0;
+
+	return fileStat.st_mtime;
+}
+
+static TextureContainerHeader createContainerHeader(uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevels, VkFormat format, uint32_t flags)
+{
+	TextureContainerHeader header = {};
+	memcpy(header.magic, "JTEX", 4);
+	header.version = TEXTURE_CONTAINER_VERSION;
+	header.width = width;
+	header.height = height;
+	header.depth = depth;
+	header.mipLevels = mipLevels;
+	header.format = format;
+	header.flags = flags;
+
+	return header;
+}
+
+//2x2 box filter, normal maps are renormalized after filtering
+static std::vector<unsigned char> downsampleImage(const std::vector<unsigned char> &image, int width, int height, int nextWidth, int nextHeight, bool bNormalMap)
+{
+	std::vector<unsigned char> nextImage(static_cast<size_t>(nextWidth) * nextHeight * 4);
+
+	for (int y = 0; y < nextHeight; y++)
+	{
+		for (int x = 0; x < nextWidth; x++)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+			for (int dy = 0; dy < 2; dy++)
+			{
+				for (int dx = 0; dx < 2; dx++)
+				{
+					int sx = glm::min(x * 2 + dx, width - 1);
+					int sy = glm::min(y * 2 + dy, height - 1);
+
+					for (int c = 0; c < 4; c++)
+					{
+						sum[c] += image[(static_cast<size_t>(sy) * width + sx) * 4 + c] * 0.25f;
+					}
+				}
+			}
+
+			if (bNormalMap)
+			{
+				glm::vec3 normal = glm::vec3(sum[0], sum[1], sum[2]) / 255.0f * 2.0f - glm::vec3(1.0f);
+
+				if (glm::length(normal) > 0.0f)
+					normal = glm::normalize(normal);
+
+				sum[0] = (normal.x * 0.5f + 0.5f) * 255.0f;
+				sum[1] = (normal.y * 0.5f + 0.5f) * 255.0f;
+				sum[2] = (normal.z * 0.5f + 0.5f) * 255.0f;
+			}
+
+			for (int c = 0; c < 4; c++)
+			{
+				nextImage[(static_cast<size_t>(y) * nextWidth + x) * 4 + c] = static_cast<unsigned char>(glm::clamp(sum[c] + 0.5f, 0.0f, 255.0f));
+			}
+		}
+	}
+
+	return nextImage;
+}
+
+static uint16_t packColor565(const unsigned char color[4])
+{
+	uint16_t r = static_cast<uint16_t>((color[0] * 31 + 127) / 255);
+	uint16_t g = static_cast<uint16_t>((color[1] * 63 + 127) / 255);
+	uint16_t b = static_cast<uint16_t>((color[2] * 31 + 127) / 255);
+
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static glm::vec3 unpackColor565(uint16_t color)
+{
+	int r = (color >> 11) & 31;
+	int g = (color >> 5) & 63;
+	int b = color & 31;
+
+	return glm::vec3(static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2)));
+}
+
+//endpoints are the extremes of the block along its principal axis
+static void encodeBC1(const unsigned char block[16][4], unsigned char *out)
+{
+	glm::vec3 mean = glm::vec3(0.0f);
+
+	for (int i = 0; i < 16; i++)
+	{
+		mean += glm::vec3(block[i][0], block[i][1], block[i][2]);
+	}
+
+	mean /= 16.0f;
+
+	glm::mat3 covariance = glm::mat3(0.0f);
+
+	for (int i = 0; i < 16; i++)
+	{
+		glm::vec3 diff = glm::vec3(block[i][0], block[i][1], block[i][2]) - mean;
+		covariance += glm::outerProduct(diff, diff);
+	}
+
+	glm::vec3 axis = glm::vec3(1.0f);
+
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		glm::vec3 nextAxis = covariance * axis;
+		float maxComponent = glm::max(glm::abs(nextAxis.x), glm::max(glm::abs(nextAxis.y), glm::abs(nextAxis.z)));
+
+		if (maxComponent <= 0.0f)
+			break;
+
+		axis = nextAxis / maxComponent;
+	}
+
+	int minIndex = 0;
+	int maxIndex = 0;
+	float minProjection = FLT_MAX;
+	float maxProjection = -FLT_MAX;
+
+	for (int i = 0; i < 16; i++)
+	{
+		float projection = glm::dot(glm::vec3(block[i][0], block[i][1], block[i][2]) - mean, axis);
+
+		if (projection < minProjection)
+		{
+			minProjection = projection;
+			minIndex = i;
+		}
+
+		if (projection > maxProjection)
+		{
+			maxProjection = projection;
+			maxIndex = i;
+		}
+	}
+
+	uint16_t color0 = packColor565(block[maxIndex]);
+	uint16_t color1 = packColor565(block[minIndex]);
+
+	//color0 > color1 selects the four color mode
+	if (color0 < color1)
+		std::swap(color0, color1);
+
+	uint32_t indices = 0;
+
+	if (color0 != color1)
+	{
+		glm::vec3 palette[4];
+		palette[0] = unpackColor565(color0);
+		palette[1] = unpackColor565(color1);
+		palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+		palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+
+		for (int i = 0; i < 16; i++)
+		{
+			glm::vec3 color = glm::vec3(block[i][0], block[i][1], block[i][2]);
+
+			uint32_t bestIndex = 0;
+			float bestDistance = FLT_MAX;
+
+			for (uint32_t p = 0; p < 4; p++)
+			{
+				glm::vec3 diff = color - palette[p];
+				float distance = glm::dot(diff, diff);
+
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = p;
+				}
+			}
+
+			indices |= bestIndex << (i * 2);
+		}
+	}
+
+	out[0] = static_cast<unsigned char>(color0 & 0xFF);
+	out[1] = static_cast<unsigned char>(color0 >> 8);
+	out[2] = static_cast<unsigned char>(color1 & 0xFF);
+	out[3] = static_cast<unsigned char>(color1 >> 8);
+
+	for (int i = 0; i < 4; i++)
+	{
+		out[4 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+//eight value mode between the min and max of the block
+static void encodeBC4(const unsigned char values[16], unsigned char *out)
+{
+	unsigned char value0 = values[0];
+	unsigned char value1 = values[0];
+
+	for (int i = 1; i < 16; i++)
+	{
+		value0 = std::max(value0, values[i]);
+		value1 = std::min(value1, values[i]);
+	}
+
+	uint64_t indices = 0;
+
+	if (value0 > value1)
+	{
+		int palette[8];
+		palette[0] = value0;
+		palette[1] = value1;
+
+		for (int i = 1; i < 7; i++)
+		{
+			palette[i + 1] = ((7 - i) * value0 + i * value1 + 3) / 7;
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			uint64_t bestIndex = 0;
+			int bestDistance = INT_MAX;
+
+			for (int p = 0; p < 8; p++)
+			{
+				int distance = std::abs(values[i] - palette[p]);
+
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestIndex = static_cast<uint64_t>(p);
+				}
+			}
+
+			indices |= bestIndex << (i * 3);
+		}
+	}
+
+	out[0] = value0;
+	out[1] = value1;
+
+	for (int i = 0; i < 6; i++)
+	{
+		out[2 + i] = static_cast<unsigned char>((indices >> (i * 8)) & 0xFF);
+	}
+}
+
+static std::vector<unsigned char> compressImage(const std::vector<unsigned char> &image, int width, int height, VkFormat format)
+{
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+
+	size_t blockSize = (format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK) ? 8 : 16;
+
+	std::vector<unsigned char> blocks(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			//edge blocks repeat the last row and column
+			unsigned char block[16][4];
+
+			for (int i = 0; i < 16; i++)
+			{
+				int x = glm::min(bx * 4 + (i % 4), width - 1);
+				int y = glm::min(by * 4 + (i / 4), height - 1);
+
+				memcpy(block[i], &image[(static_cast<size_t>(y) * width + x) * 4], 4);
+			}
+
+			unsigned char channel[16];
+			unsigned char *out = &blocks[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+
+			switch (format)
+			{
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+				encodeBC1(block, out);
+				break;
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+				for (int i = 0; i < 16; i++)
+					channel[i] = block[i][3];
+				encodeBC4(channel, out);
+				encodeBC1(block, out + 8);
+				break;
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				for (int i = 0; i < 16; i++)
+					channel[i] = block[i][0];
+				encodeBC4(channel, out);
+				break;
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+				for (int i = 0; i < 16; i++)
+					channel[i] = block[i][0];
+				encodeBC4(channel, out);
+				for (int i = 0; i < 16; i++)
+					channel[i] = block[i][1];
+				encodeBC4(channel, out + 8);
+				break;
+			default:
+				throw std::runtime_error("failed to find a supported texture format!");
+			}
+		}
+	}
+
+	return blocks;
+}
+
+void TextureCooker::cookTexture(std::string sourcePath, std::string containerPath)
+{
+	PROFILE_ZONE("TextureCooker::cookTexture");
+
+	int width, height, channels;
+
+	stbi_uc* pixels = stbi_load(sourcePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!pixels)
+	{
+		throw std::runtime_error("failed to load texture image!");
+	}
+
+	std::vector<unsigned char> image(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+	stbi_image_free(pixels);
+
+	bool bNormalMap = isNormalMap(sourcePath);
+	bool bHasAlpha = false;
+	bool bSingleChannel = true;
+
+	for (size_t i = 0; i < image.size(); i += 4)
+	{
+		bHasAlpha |= image[i + 3] < 255;
+		bSingleChannel &= image[i] == image[i + 1] && image[i] == image[i + 2];
+	}
+
+	VkFormat format;
+	uint32_t flags = 0;
+
+	if (isDataTexture(sourcePath))
+	{
+		format = VK_FORMAT_R8G8B8A8_UNORM;
+	}
+	else if (bNormalMap)
+	{
+		//z is reconstructed in the shaders, metallic lives in the alpha and is kept whenever it is not the default 1.0
+		format = bHasAlpha ? VK_FORMAT_BC3_UNORM_BLOCK : VK_FORMAT_BC5_UNORM_BLOCK;
+		flags = TEXTURE_CONTAINER_NORMAL_MAP;
+	}
+	else if (bSingleChannel && !bHasAlpha)
+	{
+		format = VK_FORMAT_BC4_UNORM_BLOCK;
+		flags = TEXTURE_CONTAINER_GRAYSCALE;
+	}
+	else if (bHasAlpha)
+	{
+		format = VK_FORMAT_BC3_UNORM_BLOCK;
+	}
+	else
+	{
+		format = VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	}
+
+	uint32_t mipLevels = glm::max(static_cast<int>(glm::floor(glm::log2(static_cast<float>(glm::max(width, height))))), 0) + 1;
+
+	std::vector<std::vector<unsigned char>> mips(mipLevels);
+
+	int mipWidth = width;
+	int mipHeight = height;
+
+	for (uint32_t level = 0; level < mipLevels; level++)
+	{
+		mips[level] = format == VK_FORMAT_R8G8B8A8_UNORM ? image : compressImage(image, mipWidth, mipHeight, format);
+
+		if (level + 1 < mipLevels)
+		{
+			int nextWidth = glm::max(mipWidth / 2, 1);
+			int nextHeight = glm::max(mipHeight / 2, 1);
+
+			image = downsampleImage(image, mipWidth, mipHeight, nextWidth, nextHeight, bNormalMap);
+
+			mipWidth = nextWidth;
+			mipHeight = nextHeight;
+		}
+	}
+
+	TextureContainerHeader header = createContainerHeader(width, height, 1, mipLevels, format, flags);
+	writeTextureContainer(containerPath, header, mips);
+}
+
+void TextureCooker::cookVolumeTexture(std::string slicePath, std::string extension, std::string containerPath)
+{
+	int width, height, channels;
+
+	std::string tempPath = slicePath + "_0" + extension;
+
+	stbi_uc* pixels = stbi_load(tempPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!pixels)
+	{
+		throw std::runtime_error("failed to load texture image!");
+	}
+
+	stbi_image_free(pixels);
+
+	//slices are square, one per texel of depth
+	int depth = width;
+
+	uint32_t mipLevels = glm::max(static_cast<int>(glm::floor(glm::log2(static_cast<float>(glm::max(width, glm::max(height, depth)))))), 0) + 1;
+
+	std::vector<std::vector<unsigned char>> mips(mipLevels);
+	mips[0].reserve(static_cast<size_t>(width) * height * depth * 4);
+
+	for (int i = 0; i < depth; i++)
+	{
+		tempPath = slicePath + "_" + std::to_string(i) + extension;
+
+		pixels = stbi_load(tempPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!pixels)
+		{
+			throw std::runtime_error("failed to load texture image!");
+		}
+
+		mips[0].insert(mips[0].end(), pixels, pixels + width * height * 4);
+
+		stbi_image_free(pixels);
+	}
+
+	//box filtered mip chain, each texel averages a 2x2x2 footprint of the previous level
+	int mipWidth = width;
+	int mipHeight = height;
+	int mipDepth = depth;
+
+	for (uint32_t level = 1; level < mipLevels; level++)
+	{
+		int nextWidth = glm::max(mipWidth / 2, 1);
+		int nextHeight = glm::max(mipHeight / 2, 1);
+		int nextDepth = glm::max(mipDepth / 2, 1);
+
+		const std::vector<unsigned char> &mip = mips[level - 1];
+		std::vector<unsigned char> &nextMip = mips[level];
+		nextMip.resize(static_cast<size_t>(nextWidth) * nextHeight * nextDepth * 4);
+
+		for (int z = 0; z < nextDepth; z++)
+		{
+			for (int y = 0; y < nextHeight; y++)
+			{
+				for (int x = 0; x < nextWidth; x++)
+				{
+					for (int c = 0; c < 4; c++)
+					{
+						int sum = 0;
+
+						for (int dz = 0; dz < 2; dz++)
+						{
+							for (int dy = 0; dy < 2; dy++)
+							{
+								for (int dx = 0; dx < 2; dx++)
+								{
+									int sx = glm::min(x * 2 + dx, mipWidth - 1);
+									int sy = glm::min(y * 2 + dy, mipHeight - 1);
+									int sz = glm::min(z * 2 + dz, mipDepth - 1);
+
+									sum += mip[((static_cast<size_t>(sz) * mipHeight + sy) * mipWidth + sx) * 4 + c];
+								}
+							}
+						}
+
+						nextMip[((static_cast<size_t>(z) * nextHeight + y) * nextWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 4) / 8);
+					}
+				}
+			}
+		}
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+		mipDepth = nextDepth;
+	}
+
+	TextureContainerHeader header = createContainerHeader(width, height, depth, mipLevels, VK_FORMAT_R8G8B8A8_UNORM, 0);
+	writeTextureContainer(containerPath, header, mips);
+}
+
+bool TextureCooker::isCooked(std::string containerPath, std::string sourcePath)
+{
+	std::ifstream file(containerPath, std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	//the source was edited after it was cooked
+	if (!sourcePath.empty() && getModifiedTime(sourcePath) > getModifiedTime(containerPath))
+		return false;
+
+	TextureContainerHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(TextureContainerHeader));
+
+	return file.good() && memcmp(header.magic, "JTEX", 4) == 0 && header.version == TEXTURE_CONTAINER_VERSION;
+}
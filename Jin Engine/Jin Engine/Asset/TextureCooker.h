@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Texture.h"
+
+//Offline conversion of source images into block compressed texture containers
+class TextureCooker
+{
+public:
+
+	//RGBA8 for noise and lookup tables, BC5 for normal maps, BC3 for normal maps with metallic in the alpha, BC4 for single channel, BC3 with alpha, BC1 otherwise
+	static void cookTexture(std::string sourcePath, std::string containerPath);
+
+	//packs path_0.ext ... path_N.ext slices into a mipmapped RGBA8 volume container
+	static void cookVolumeTexture(std::string slicePath, std::string extension, std::string containerPath);
+
+	//a container older than its source image is stale
+	static bool isCooked(std::string containerPath, std::string sourcePath = "");
+
+	//*_norm source images hold tangent space normals
+	static bool isNormalMap(std::string sourcePath);
+
+	static std::string getCookedPath(std::string sourcePath)
+	{
+		return sourcePath.substr(0, sourcePath.find_last_of('.')) + ".jtex";
+	}
+};
@@ -0,0 +1,374 @@
+#include "TextureStreamer.h"
+#include "TextureCooker.h"
+#include "Material.h"
+
+TextureStreamer::TextureStreamer() : vulkanApp(NULL), bExit(false), currentFrame(1)
+{
+
+}
+
+void TextureStreamer::request(Texture *texture, bool bLoadTail)
+{
+	vulkanApp = texture->vulkanApp;
+
+	StreamedTexture streamed = {};
+	streamed.texture = texture;
+	streamed.lastUsedFrame = 0;
+	streamed.wantedLevel = texture->residentLevel;
+	streamed.targetLevel = texture->residentLevel;
+	streamed.bPinned = false;
+	streamed.bInFlight = false;
+
+	streamedTextures.push_back(streamed);
+
+	if (bLoadTail)
+		queueJob(streamedTextures.back(), TEXTURE_MIP_TAIL);
+}
+
+void TextureStreamer::queueJob(StreamedTexture &streamed, uint32_t firstLevel)
+{
+	if (!worker.joinable())
+	{
+		bExit = false;
+		worker = std::thread(&TextureStreamer::workerLoop, this);
+	}
+
+	StreamJob job = {};
+	job.texture = streamed.texture;
+	job.path = streamed.texture->path;
+	job.firstLevel = firstLevel;
+
+	streamed.bInFlight = true;
+	streamed.targetLevel = firstLevel;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		requests.push_back(job);
+	}
+
+	condition.notify_one();
+}
+
+void TextureStreamer::workerLoop()
+{
+	Profiler::GetInstance()->setThreadName("TextureStreamer");
+
+	for (;;)
+	{
+		StreamJob job;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this] { return bExit || !requests.empty(); });
+
+			if (bExit)
+				return;
+
+			job = requests.front();
+			requests.pop_front();
+		}
+
+		//exceptions do not cross threads, the main thread rethrows them
+		try
+		{
+			PROFILE_ZONE("TextureStreamer::read");
+
+			std::string cookedPath = TextureCooker::getCookedPath(job.path);
+
+			if (!TextureCooker::isCooked(cookedPath, job.path))
+				TextureCooker::cookTexture(job.path, cookedPath);
+
+			if (!Texture::readContainerLevels(cookedPath, job.firstLevel, job.fileData))
+				throw std::runtime_error("failed to read texture container!");
+		}
+		catch (const std::exception &e)
+		{
+			job.error = e.what();
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		decoded.push_back(job);
+	}
+}
+
+TextureStreamer::StreamedTexture* TextureStreamer::findStreamedTexture(Texture *texture)
+{
+	for (size_t i = 0; i < streamedTextures.size(); i++)
+	{
+		if (streamedTextures[i].texture == texture)
+			return &streamedTextures[i];
+	}
+
+	return NULL;
+}
+
+void TextureStreamer::addDescriptorReference(Material *material, uint32_t binding, const VkDescriptorImageInfo &imageInfo)
+{
+	for (size_t i = 0; i < streamedTextures.size(); i++)
+	{
+		if (streamedTextures[i].texture->textureImageView != imageInfo.imageView)
+			continue;
+
+		//post processes sample with their own coordinates, their textures are not worth a screen size
+		if (!material->streamsTextureMips())
+			streamedTextures[i].bPinned = true;
+
+		//materials rewrite their descriptors when the swapchain is recreated
+		for (size_t j = 0; j < descriptorReferences.size(); j++)
+		{
+			if (descriptorReferences[j].material == material && descriptorReferences[j].binding == binding)
+			{
+				descriptorReferences[j].texture = streamedTextures[i].texture;
+				return;
+			}
+		}
+
+		DescriptorReference reference;
+		reference.texture = streamedTextures[i].texture;
+		reference.material = material;
+		reference.binding = binding;
+		reference.imageLayout = imageInfo.imageLayout;
+
+		descriptorReferences.push_back(reference);
+		return;
+	}
+}
+
+void TextureStreamer::requestPixelDensity(Texture *texture, float pixelsPerUV)
+{
+	StreamedTexture *streamed = findStreamedTexture(texture);
+
+	if (streamed == NULL)
+		return;
+
+	if (streamed->lastUsedFrame != currentFrame)
+		streamed->pixelsPerUV = pixelsPerUV;
+	else
+		streamed->pixelsPerUV = glm::max(streamed->pixelsPerUV, pixelsPerUV);
+
+	streamed->lastUsedFrame = currentFrame;
+}
+
+uint32_t TextureStreamer::getWantedLevel(StreamedTexture &streamed)
+{
+	uint32_t tailLevel = streamed.texture->getTailLevel();
+
+	if (streamed.bPinned)
+		return 0;
+
+	if (streamed.lastUsedFrame != currentFrame || streamed.pixelsPerUV <= 0.0f)
+		return tailLevel;
+
+	//one texel per pixel along the longer side
+	float texels = static_cast<float>(glm::max(streamed.texture->getWidth(), streamed.texture->getHeight()));
+	float level = glm::floor(glm::log2(texels / streamed.pixelsPerUV));
+
+	return static_cast<uint32_t>(glm::clamp(level, 0.0f, static_cast<float>(tailLevel)));
+}
+
+bool TextureStreamer::update(VkDeviceSize budget)
+{
+	PROFILE_ZONE("TextureStreamer::update");
+
+	std::vector<StreamJob> readJobs;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		readJobs.swap(decoded);
+	}
+
+	for (size_t i = 0; i < readJobs.size(); i++)
+	{
+		if (!readJobs[i].error.empty())
+		{
+			throw std::runtime_error("failed to stream texture " + readJobs[i].path + ", " + readJobs[i].error);
+		}
+
+		StreamJob &job = readJobs[i];
+		job.ticket = job.texture->createContainerImage(job.fileData, job.firstLevel, job.image, job.imageMemory, job.imageView);
+
+		//the staging ring already holds a copy
+		std::vector<char>().swap(job.fileData);
+
+		uploading.push_back(job);
+	}
+
+	std::vector<VkWriteDescriptorSet> descriptorWrites;
+	std::vector<VkDescriptorImageInfo> imageInfos;
+	std::vector<Material*> changedMaterials;
+
+	//the addresses of the image infos have to stay put until the writes are submitted
+	//a texture has one chain in flight at most, so every reference is written once
+	imageInfos.reserve(descriptorReferences.size());
+
+	for (size_t i = 0; i < uploading.size();)
+	{
+		StreamJob &job = uploading[i];
+
+		if (!vulkanApp->getUploadContext()->isComplete(job.ticket))
+		{
+			i++;
+			continue;
+		}
+
+		job.texture->replaceImage(job.image, job.imageMemory, job.imageView, job.firstLevel);
+
+		StreamedTexture *streamed = findStreamedTexture(job.texture);
+		streamed->bInFlight = false;
+		streamed->targetLevel = job.firstLevel;
+
+		for (size_t j = 0; j < descriptorReferences.size(); j++)
+		{
+			DescriptorReference &reference = descriptorReferences[j];
+
+			if (reference.texture != job.texture)
+				continue;
+
+			VkDescriptorImageInfo imageInfo = {};
+			imageInfo.imageLayout = reference.imageLayout;
+			imageInfo.imageView = job.texture->textureImageView;
+			imageInfo.sampler = job.texture->textureSampler;
+			imageInfos.push_back(imageInfo);
+
+			VkWriteDescriptorSet descriptorWrite = {};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = reference.material->getDescSet();
+			descriptorWrite.dstBinding = reference.binding;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.pImageInfo = &imageInfos.back();
+			descriptorWrites.push_back(descriptorWrite);
+
+			if (std::find(changedMaterials.begin(), changedMaterials.end(), reference.material) == changedMaterials.end())
+				changedMaterials.push_back(reference.material);
+		}
+
+		uploading.erase(uploading.begin() + i);
+	}
+
+	if (!descriptorWrites.empty())
+	{
+		vkUpdateDescriptorSets(vulkanApp->getDevice(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+		for (size_t i = 0; i < changedMaterials.size(); i++)
+		{
+			changedMaterials[i]->updateResidentLevels();
+		}
+	}
+
+	//plan against the chains that will be resident once everything in flight has landed
+	VkDeviceSize committedSize = 0;
+	size_t jobsInFlight = 0;
+	std::vector<StreamedTexture*> loads;
+
+	for (size_t i = 0; i < streamedTextures.size(); i++)
+	{
+		StreamedTexture &streamed = streamedTextures[i];
+
+		streamed.wantedLevel = getWantedLevel(streamed);
+		committedSize += streamed.texture->getLevelsSize(streamed.targetLevel);
+
+		if (streamed.bInFlight)
+			jobsInFlight++;
+		else if (streamed.wantedLevel < streamed.targetLevel)
+			loads.push_back(&streamed);
+	}
+
+	//the largest gain in sharpness first
+	std::sort(loads.begin(), loads.end(), [](const StreamedTexture *a, const StreamedTexture *b)
+	{
+		return a->targetLevel - a->wantedLevel > b->targetLevel - b->wantedLevel;
+	});
+
+	for (size_t i = 0; i < loads.size() && jobsInFlight < TEXTURE_STREAMING_MAX_JOBS; i++)
+	{
+		StreamedTexture &load = *loads[i];
+
+		VkDeviceSize growth = load.texture->getLevelsSize(load.wantedLevel) - load.texture->getLevelsSize(load.targetLevel);
+
+		//chains finer than their own wanted level go back to it, least recently used first, until the new one fits
+		//pinned textures are loaded whatever the budget says
+		while (!load.bPinned && committedSize + growth > budget && jobsInFlight < TEXTURE_STREAMING_MAX_JOBS)
+		{
+			StreamedTexture *victim = NULL;
+
+			for (size_t j = 0; j < streamedTextures.size(); j++)
+			{
+				StreamedTexture &candidate = streamedTextures[j];
+
+				if (candidate.bPinned || candidate.bInFlight || candidate.wantedLevel <= candidate.targetLevel)
+					continue;
+
+				if (victim == NULL || candidate.lastUsedFrame < victim->lastUsedFrame)
+					victim = &candidate;
+			}
+
+			if (victim == NULL)
+				break;
+
+			committedSize -= victim->texture->getLevelsSize(victim->targetLevel) - victim->texture->getLevelsSize(victim->wantedLevel);
+
+			queueJob(*victim, victim->wantedLevel);
+			jobsInFlight++;
+		}
+
+		if ((!load.bPinned && committedSize + growth > budget) || jobsInFlight >= TEXTURE_STREAMING_MAX_JOBS)
+			continue;
+
+		committedSize += growth;
+
+		queueJob(load, load.wantedLevel);
+		jobsInFlight++;
+	}
+
+	currentFrame++;
+
+	return !descriptorWrites.empty();
+}
+
+size_t TextureStreamer::getPendingCount()
+{
+	size_t pendingCount = 0;
+
+	for (size_t i = 0; i < streamedTextures.size(); i++)
+	{
+		if (streamedTextures[i].bInFlight)
+			pendingCount++;
+	}
+
+	return pendingCount;
+}
+
+void TextureStreamer::shutDown()
+{
+	if (worker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			bExit = true;
+		}
+
+		condition.notify_one();
+		worker.join();
+	}
+
+	requests.clear();
+	decoded.clear();
+
+	if (!uploading.empty())
+	{
+		vulkanApp->getUploadContext()->waitIdle();
+
+		for (size_t i = 0; i < uploading.size(); i++)
+		{
+			vkDestroyImageView(vulkanApp->getDevice(), uploading[i].imageView, nullptr);
+			vkDestroyImage(vulkanApp->getDevice(), uploading[i].image, nullptr);
+			vkFreeMemory(vulkanApp->getDevice(), uploading[i].imageMemory, nullptr);
+		}
+	}
+
+	uploading.clear();
+	streamedTextures.clear();
+	descriptorReferences.clear();
+}
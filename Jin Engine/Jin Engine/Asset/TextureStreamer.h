@@ -0,0 +1,115 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include "Texture.h"
+
+#define TEXTURE_STREAMING_MAX_JOBS 8 //reads and uploads in flight, a texture has at most one
+
+class Material;
+
+//Textures are handed out with their mip tail as placeholder and keep only the levels the renderer asks for resident.
+//A worker thread reads the wanted chains from the cooked containers, the main thread uploads them, swaps them in
+//and rewrites every descriptor that points at the texture. Levels the screen does not need are dropped again,
+//least recently used first, once the resident chains would exceed the budget.
+class TextureStreamer
+{
+public:
+
+	TextureStreamer();
+
+	~TextureStreamer()
+	{
+		shutDown();
+	}
+
+	//starts managing a texture that already has its placeholder, bLoadTail when the placeholder is only a single texel
+	//and the container still has to be cooked and its mip tail read
+	void request(Texture *texture, bool bLoadTail);
+
+	//called by the materials for every image descriptor they write, streamed textures are remembered to be rewritten
+	//textures bound by a material that does not stream mips are kept whole
+	void addDescriptorReference(Material *material, uint32_t binding, const VkDescriptorImageInfo &imageInfo);
+
+	//a visible surface shows the texture with pixelsPerUV screen pixels across one UV unit this frame
+	void requestPixelDensity(Texture *texture, float pixelsPerUV);
+
+	//main thread, once per frame while the GPU is idle
+	//uploads what the worker has read, swaps in what has finished uploading and plans the next reads and evictions
+	//returns true if a descriptor was rewritten
+	bool update(VkDeviceSize budget);
+
+	//stops the worker and drops every chain that has not landed yet
+	void shutDown();
+
+	//chains being read or uploaded
+	size_t getPendingCount();
+
+private:
+
+	struct StreamJob
+	{
+		Texture *texture;
+		std::string path;
+		uint32_t firstLevel; //clamped to the mip tail by the worker
+
+		std::vector<char> fileData;
+		std::string error;
+
+		VkImage image;
+		VkDeviceMemory imageMemory;
+		VkImageView imageView;
+		uint64_t ticket;
+	};
+
+	struct StreamedTexture
+	{
+		Texture *texture;
+
+		float pixelsPerUV; //largest density asked for this frame
+		uint64_t lastUsedFrame;
+		uint32_t wantedLevel;
+		uint32_t targetLevel; //level of the job in flight, otherwise the resident level
+
+		bool bPinned;
+		bool bInFlight;
+	};
+
+	struct DescriptorReference
+	{
+		Texture *texture;
+		Material *material;
+		uint32_t binding;
+		VkImageLayout imageLayout;
+	};
+
+	void workerLoop();
+
+	void queueJob(StreamedTexture &streamed, uint32_t firstLevel);
+
+	StreamedTexture* findStreamedTexture(Texture *texture);
+
+	//finest level the screen can tell apart, never finer than the base and never coarser than the mip tail
+	uint32_t getWantedLevel(StreamedTexture &streamed);
+
+	Vulkan *vulkanApp;
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool bExit;
+
+	//guarded by mutex
+	std::deque<StreamJob> requests;
+	std::vector<StreamJob> decoded;
+
+	//main thread only
+	std::vector<StreamJob> uploading;
+	std::vector<StreamedTexture> streamedTextures;
+	std::vector<DescriptorReference> descriptorReferences;
+
+	uint64_t currentFrame;
+};
@@ -0,0 +1,183 @@
+#include "Benchmark.h"
+
+#include <sstream>
+#include <iomanip>
+
+bool CameraPath::load(std::string path)
+{
+	std::ifstream file(path);
+
+	if (!file.is_open())
+		return false;
+
+	keys.clear();
+
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		CameraKey key;
+
+		if (stream >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.theta >> key.phi)
+			keys.push_back(key);
+	}
+
+	return !keys.empty();
+}
+
+bool CameraPath::save(std::string path)
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+		return false;
+
+	file << std::setprecision(9);
+
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		file << keys[i].time << " " << keys[i].position.x << " " << keys[i].position.y << " " << keys[i].position.z << " " << keys[i].theta << " " << keys[i].phi << "\n";
+	}
+
+	return true;
+}
+
+void CameraPath::addKey(double time, glm::vec3 position, float theta, float phi)
+{
+	CameraKey key;
+	key.time = time;
+	key.position = position;
+	key.theta = theta;
+	key.phi = phi;
+
+	keys.push_back(key);
+}
+
+CameraPath::CameraKey CameraPath::sample(double time)
+{
+	//recorded paths start at the time the recording did
+	time += keys.front().time;
+
+	if (time <= keys.front().time)
+		return keys.front();
+
+	if (time >= keys.back().time)
+		return keys.back();
+
+	size_t next = 1;
+
+	while (keys[next].time < time)
+		next++;
+
+	const CameraKey &a = keys[next - 1];
+	const CameraKey &b = keys[next];
+
+	float t = b.time > a.time ? static_cast<float>((time - a.time) / (b.time - a.time)) : 1.0f;
+
+	CameraKey key;
+	key.time = time;
+	key.position = glm::mix(a.position, b.position, t);
+	key.theta = glm::mix(a.theta, b.theta, t);
+	key.phi = glm::mix(a.phi, b.phi, t);
+
+	return key;
+}
+
+double CameraPath::getDuration()
+{
+	return keys.empty() ? 0.0 : keys.back().time - keys.front().time;
+}
+
+Benchmark::Benchmark() : frameCount(600), warmupFrames(60), frameStep(16), width(1280), height(720)
+{
+
+}
+
+void Benchmark::addFrame(double cpuTime, double frameTime, double gpuTime)
+{
+	FrameTimes times;
+	times.cpuTime = cpuTime;
+	times.frameTime = frameTime;
+	times.gpuTime = gpuTime;
+
+	frames.push_back(times);
+}
+
+void Benchmark::writeSummary(std::ofstream &file, std::vector<double> times)
+{
+	if (times.empty())
+	{
+		file << "null";
+		return;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	double sum = 0.0;
+
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		sum += times[i];
+	}
+
+	auto percentile = [&times](double p)
+	{
+		size_t rank = static_cast<size_t>(std::ceil(p * 0.01 * static_cast<double>(times.size())));
+		return times[rank > 0 ? rank - 1 : 0];
+	};
+
+	file << "{\"mean\":" << sum / static_cast<double>(times.size()) << ",\"p50\":" << percentile(50.0) << ",\"p95\":" << percentile(95.0) << ",\"p99\":" << percentile(99.0)
+		<< ",\"min\":" << times.front() << ",\"max\":" << times.back() << "}";
+}
+
+bool Benchmark::writeReport(std::string path)
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+		return false;
+
+	std::vector<double> cpuTimes;
+	std::vector<double> frameTimes;
+	std::vector<double> gpuTimes;
+
+	for (size_t i = 0; i < frames.size(); i++)
+	{
+		cpuTimes.push_back(frames[i].cpuTime);
+		frameTimes.push_back(frames[i].frameTime);
+
+		if (frames[i].gpuTime >= 0.0)
+			gpuTimes.push_back(frames[i].gpuTime);
+	}
+
+	file << std::fixed << std::setprecision(4);
+
+	file << "{\n\"width\":" << width << ",\"height\":" << height << ",\"frames\":" << frames.size() << ",\"warmupFrames\":" << warmupFrames << ",\"frameStep\":" << frameStep << ",\n";
+
+	file << "\"cpu\":";
+	writeSummary(file, cpuTimes);
+	file << ",\n\"frame\":";
+	writeSummary(file, frameTimes);
+	file << ",\n\"gpu\":";
+	writeSummary(file, gpuTimes);
+
+	//milliseconds, gpu is null without timestamps
+	file << ",\n\"perFrame\":[";
+
+	for (size_t i = 0; i < frames.size(); i++)
+	{
+		file << (i == 0 ? "" : ",") << "\n{\"cpu\":" << frames[i].cpuTime << ",\"frame\":" << frames[i].frameTime << ",\"gpu\":";
+
+		if (frames[i].gpuTime >= 0.0)
+			file << frames[i].gpuTime;
+		else
+			file << "null";
+
+		file << "}";
+	}
+
+	file << "\n]\n}\n";
+
+	return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Common.h"
+
+//camera poses over time, the same state updateOrbit and updatePosition leave in the camera
+//a file has one "time positionX positionY positionZ theta phi" line per key, times in seconds
+class CameraPath
+{
+public:
+
+	struct CameraKey
+	{
+		double time;
+		glm::vec3 position;
+		float theta;
+		float phi;
+	};
+
+	//returns false when the file can not be opened or holds no key
+	bool load(std::string path);
+	bool save(std::string path);
+
+	//keys have to come in increasing time
+	void addKey(double time, glm::vec3 position, float theta, float phi);
+
+	//linear between the surrounding keys, time from the first key, held at the ends
+	CameraKey sample(double time);
+
+	double getDuration();
+
+	size_t size()
+	{
+		return keys.size();
+	}
+
+	CameraKey getKey(size_t index)
+	{
+		return keys[index];
+	}
+
+	bool empty()
+	{
+		return keys.empty();
+	}
+
+	void clear()
+	{
+		keys.clear();
+	}
+
+private:
+
+	std::vector<CameraKey> keys;
+};
+
+//frame times of a headless run, written as JSON with their summary
+class Benchmark
+{
+public:
+
+	Benchmark();
+
+	//cpuTime - from the start of the frame to its last submit, frameTime - until the GPU has finished it, gpuTime - sum of the timed passes
+	//milliseconds, a negative gpuTime when the device has no timestamps
+	void addFrame(double cpuTime, double frameTime, double gpuTime);
+
+	//returns false when the file can not be opened
+	bool writeReport(std::string path);
+
+	uint32_t frameCount; //measured frames
+	uint32_t warmupFrames; //rendered at the first pose of the path before measuring, longer while textures are still streaming in
+	unsigned int frameStep; //simulated milliseconds per frame, the path and the shaders see the same time on every run
+
+	int width;
+	int height;
+
+	CameraPath cameraPath; //turns the camera once in place over the run when empty
+
+private:
+
+	struct FrameTimes
+	{
+		double cpuTime;
+		double frameTime;
+		double gpuTime;
+	};
+
+	//mean, p50, p95 and p99 of one column, nearest rank
+	static void writeSummary(std::ofstream &file, std::vector<double> times);
+
+	std::vector<FrameTimes> frames;
+};
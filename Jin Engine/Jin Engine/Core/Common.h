@@ -74,11 +74,12 @@ struct cameraBuffer
 	glm::vec4 cameraWorldPos;
 	glm::vec4 viewPortSize;
 
+	glm::mat4 prevViewProjMat; //viewProjMat of the previous frame, for reprojection
 };
 
 struct perframeBuffer
 {
-	glm::vec4 timeInfo; //x - totalTime, y - deltaTime
+	glm::vec4 timeInfo; //x - totalTime, y - deltaTime, z - frameIndex
 };
 
 struct PlaneInfo
@@ -88,11 +89,12 @@ struct PlaneInfo
 	glm::vec4 size;
 };
 
-#define MAX_PLANES 4
+//Reflective planes
+#define MAX_REFLECTIVE_PLANES 1024 //capacity of the plane storage buffer, planes are culled before upload
 
+//header of the plane storage buffer, followed by numPlanes PlaneInfo of the visible planes
 struct PlaneInfoPack
 {	
-	PlaneInfo planeInfo[MAX_PLANES];
 	uint32_t numPlanes;
 	uint32_t pad00;
 	uint32_t pad01;
@@ -125,6 +127,57 @@ enum GBUFFER
 #define MAX_SCREEN_WIDTH 1920
 #define MAX_SCREEN_HEIGHT 1080
 
+#define COMPUTE_TILE_SIZE 8 //workgroup edge of compute post processes, SSRP_TILE_SIZE in SSRP.comp
+
+//Clustered lighting
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define NUM_CLUSTERS (CLUSTER_X * CLUSTER_Y * CLUSTER_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128
+#define MAX_POINT_LIGHTS 4096
+
+//Volumetric clouds
+#define CLOUD_DOWNSAMPLE 2 //2 - half resolution, 4 - quarter resolution
+#define CLOUD_OCCUPANCY_SIZE 16 //cells per axis of the empty space skipping volume
+
+//Auto exposure
+#define LUMINANCE_HISTOGRAM_BINS 256 //NUM_HISTOGRAM_BINS in luminanceHistogram.comp and exposureAdaptation.comp
+
+//Bloom
+#define BLOOM_LEVELS 5 //the pyramid goes down to 1/32 of the screen
+
+//Uploads
+#define UPLOAD_ARENA_SIZE (64 * 1024 * 1024) //staging ring of the UploadContext
+#define UPLOAD_BATCH_COUNT 4 //batches in flight before the oldest one is waited for
+#define UPLOAD_ALIGNMENT 16 //staging offsets, a multiple of every texel block size
+
+//Simulation clock
+#define FIXED_TIMESTEP (1.0 / 120.0) //seconds per simulation step
+#define MAX_STEPS_PER_FRAME 8 //a longer frame drops the rest of its time
+#define FRAME_PACING_WINDOW 240 //frames the pacing statistics are taken over
+
+//CPU profiler
+#define USE_CPU_PROFILER 1 //0 compiles every PROFILE_ZONE out
+#define PROFILER_RING_SIZE 65536 //zones kept per thread, the oldest are overwritten
+#define GPU_TIMER_MAX_PASSES 64 //timed GPU passes, two timestamp queries each
+
+//luminance histogram of the HDR scene and the adapted exposure, only the GPU reads and writes it after creation
+struct ExposureInfo
+{
+	uint32_t histogram[LUMINANCE_HISTOGRAM_BINS];
+	float exposure;
+	float averageLuminance; //adapted over frames
+	float pad00;
+	float pad01;
+};
+
+struct ClusterInfo
+{
+	glm::vec4 depthInfo; //x - near, y - far, z - CLUSTER_Z / log(far / near)
+	glm::uvec4 lightInfo; //x - numPointLights
+};
+
 static void check_vk_result(VkResult err)
 {
 	if (err == 0) return;
@@ -0,0 +1,306 @@
+#include "GoldenTest.h"
+
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+#include <glm/gtc/packing.hpp>
+
+GoldenTest::GoldenTest() : bCapture(false), settleFrames(64), frameStep(16), width(1280), height(720), minPSNR(40.0), maxPixelError(0.05f), errorPercentile(99.0f)
+{
+
+}
+
+bool GoldenTest::readImage(Vulkan *vulkanApp, VkImage image, VkFormat format, VkExtent2D extent, VkImageLayout layout, CapturedImage &captured)
+{
+	VkDeviceSize texelSize;
+
+	switch (format)
+	{
+	case VK_FORMAT_B8G8R8A8_UNORM:
+	case VK_FORMAT_R8G8B8A8_UNORM:
+	case VK_FORMAT_R32_SFLOAT:
+		texelSize = 4;
+		break;
+	case VK_FORMAT_R16G16B16A16_SFLOAT:
+		texelSize = 8;
+		break;
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		texelSize = 16;
+		break;
+	default:
+		//integer targets hold ids and packed depths, a PSNR means nothing for them
+		return false;
+	}
+
+	size_t texelCount = static_cast<size_t>(extent.width) * extent.height;
+	VkDeviceSize bufferSize = texelSize * texelCount;
+
+	VkBuffer readbackBuffer;
+	VkDeviceMemory readbackMemory;
+
+	vulkanApp->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		readbackBuffer, readbackMemory, VK_SHARING_MODE_EXCLUSIVE);
+
+	vulkanApp->copyImageToBuffer(image, layout, extent.width, extent.height, readbackBuffer);
+	vulkanApp->getUploadContext()->waitIdle();
+
+	captured.width = extent.width;
+	captured.height = extent.height;
+	captured.pixels.resize(texelCount);
+
+	void* data;
+	vkMapMemory(vulkanApp->getDevice(), readbackMemory, 0, bufferSize, 0, &data);
+
+	const uint8_t *bytes = static_cast<const uint8_t*>(data);
+
+	for (size_t i = 0; i < texelCount; i++)
+	{
+		const uint8_t *texel = bytes + i * texelSize;
+		glm::vec4 &pixel = captured.pixels[i];
+
+		if (format == VK_FORMAT_B8G8R8A8_UNORM)
+		{
+			pixel = glm::vec4(texel[2], texel[1], texel[0], texel[3]) / 255.0f;
+		}
+		else if (format == VK_FORMAT_R8G8B8A8_UNORM)
+		{
+			pixel = glm::vec4(texel[0], texel[1], texel[2], texel[3]) / 255.0f;
+		}
+		else if (format == VK_FORMAT_R16G16B16A16_SFLOAT)
+		{
+			uint16_t halfs[4];
+			memcpy(halfs, texel, sizeof(halfs));
+
+			pixel = glm::vec4(glm::unpackHalf1x16(halfs[0]), glm::unpackHalf1x16(halfs[1]), glm::unpackHalf1x16(halfs[2]), glm::unpackHalf1x16(halfs[3]));
+		}
+		else if (format == VK_FORMAT_R32_SFLOAT)
+		{
+			float value;
+			memcpy(&value, texel, sizeof(value));
+
+			pixel = glm::vec4(value, value, value, 1.0f);
+		}
+		else
+		{
+			memcpy(&pixel, texel, sizeof(pixel));
+		}
+	}
+
+	vkUnmapMemory(vulkanApp->getDevice(), readbackMemory);
+
+	vkDestroyBuffer(vulkanApp->getDevice(), readbackBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), readbackMemory, nullptr);
+
+	return true;
+}
+
+std::string GoldenTest::getImagePath(uint32_t poseIndex, std::string passName, std::string suffix)
+{
+	return directory + "/pose" + std::to_string(poseIndex) + "_" + passName + suffix + ".pfm";
+}
+
+void GoldenTest::addImage(uint32_t poseIndex, std::string passName, const CapturedImage &captured)
+{
+	if (bCapture)
+	{
+		if (!writePFM(getImagePath(poseIndex, passName, ""), captured))
+			throw std::runtime_error("failed to write golden image " + getImagePath(poseIndex, passName, "") + "!");
+
+		return;
+	}
+
+	PassResult result = {};
+	result.poseIndex = poseIndex;
+	result.passName = passName;
+
+	CapturedImage golden;
+
+	result.bGolden = readPFM(getImagePath(poseIndex, passName, ""), golden) && golden.width == captured.width && golden.height == captured.height;
+
+	if (result.bGolden)
+	{
+		float peak = 1.0f;
+
+		for (size_t i = 0; i < golden.pixels.size(); i++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				if (std::isfinite(golden.pixels[i][c]))
+					peak = glm::max(peak, glm::abs(golden.pixels[i][c]));
+			}
+		}
+
+		CapturedImage difference;
+		difference.width = captured.width;
+		difference.height = captured.height;
+		difference.pixels.resize(captured.pixels.size());
+
+		std::vector<float> errors(captured.pixels.size());
+		double squaredSum = 0.0;
+		double errorSum = 0.0;
+
+		for (size_t i = 0; i < captured.pixels.size(); i++)
+		{
+			float error = 0.0f;
+
+			for (int c = 0; c < 3; c++)
+			{
+				float a = captured.pixels[i][c];
+				float b = golden.pixels[i][c];
+
+				//a NaN or an infinity that appears or goes away is as wrong as a pixel can be
+				float channelError = (std::isfinite(a) && std::isfinite(b)) ? glm::min(glm::abs(a - b) / peak, 1.0f) : (std::isfinite(a) == std::isfinite(b) ? 0.0f : 1.0f);
+
+				squaredSum += channelError * channelError;
+				error = glm::max(error, channelError);
+			}
+
+			errors[i] = error;
+			errorSum += error;
+			difference.pixels[i] = glm::vec4(error, error, error, 1.0f);
+		}
+
+		double meanSquaredError = squaredSum / (3.0 * static_cast<double>(errors.size()));
+
+		result.psnr = meanSquaredError > 0.0 ? glm::min(10.0 * std::log10(1.0 / meanSquaredError), GOLDEN_MAX_PSNR) : GOLDEN_MAX_PSNR;
+		result.meanError = static_cast<float>(errorSum / static_cast<double>(errors.size()));
+
+		std::sort(errors.begin(), errors.end());
+
+		//nearest rank
+		size_t rank = static_cast<size_t>(std::ceil(errorPercentile * 0.01 * static_cast<double>(errors.size())));
+
+		result.percentileError = errors[rank > 0 ? rank - 1 : 0];
+		result.maxError = errors.back();
+
+		result.bPassed = result.psnr >= minPSNR && result.percentileError <= maxPixelError;
+
+		if (!result.bPassed)
+			writePFM(getImagePath(poseIndex, passName, "_diff"), difference);
+	}
+
+	if (!result.bPassed)
+		writePFM(getImagePath(poseIndex, passName, "_output"), captured);
+
+	results.push_back(result);
+}
+
+uint32_t GoldenTest::getFailedCount()
+{
+	uint32_t failedCount = 0;
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		if (!results[i].bPassed)
+			failedCount++;
+	}
+
+	return failedCount;
+}
+
+bool GoldenTest::writeReport(std::string path)
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+		return false;
+
+	file << std::fixed << std::setprecision(4);
+
+	file << "{\n\"width\":" << width << ",\"height\":" << height << ",\"poses\":" << cameraPath.size() << ",\"settleFrames\":" << settleFrames << ",\"frameStep\":" << frameStep << ",\n";
+	file << "\"minPSNR\":" << minPSNR << ",\"maxPixelError\":" << maxPixelError << ",\"errorPercentile\":" << errorPercentile << ",\n";
+	file << "\"passes\":" << results.size() << ",\"failed\":" << getFailedCount() << ",\n";
+
+	//errors are relative to the peak of the golden, a pass without a golden has null metrics
+	file << "\"perPass\":[";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const PassResult &result = results[i];
+
+		file << (i == 0 ? "" : ",") << "\n{\"pose\":" << result.poseIndex << ",\"pass\":\"" << result.passName << "\",\"passed\":" << (result.bPassed ? "true" : "false");
+
+		if (result.bGolden)
+		{
+			file << ",\"psnr\":" << result.psnr << ",\"meanError\":" << result.meanError << ",\"percentileError\":" << result.percentileError << ",\"maxError\":" << result.maxError;
+		}
+		else
+		{
+			file << ",\"psnr\":null,\"meanError\":null,\"percentileError\":null,\"maxError\":null";
+		}
+
+		file << "}";
+	}
+
+	file << "\n]\n}\n";
+
+	return true;
+}
+
+bool GoldenTest::writePFM(std::string path, const CapturedImage &captured)
+{
+	std::ofstream file(path, std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	//a negative scale marks little endian floats
+	file << "PF\n" << captured.width << " " << captured.height << "\n-1.0\n";
+
+	std::vector<float> row(static_cast<size_t>(captured.width) * 3);
+
+	//rows are stored from the bottom
+	for (uint32_t y = captured.height; y-- > 0;)
+	{
+		for (uint32_t x = 0; x < captured.width; x++)
+		{
+			const glm::vec4 &pixel = captured.pixels[static_cast<size_t>(y) * captured.width + x];
+
+			row[x * 3 + 0] = pixel.r;
+			row[x * 3 + 1] = pixel.g;
+			row[x * 3 + 2] = pixel.b;
+		}
+
+		file.write(reinterpret_cast<const char*>(row.data()), row.size() * sizeof(float));
+	}
+
+	return file.good();
+}
+
+bool GoldenTest::readPFM(std::string path, CapturedImage &captured)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	std::string type;
+	float scale;
+
+	file >> type >> captured.width >> captured.height >> scale;
+
+	//only the little endian color maps writePFM stores
+	if (!file.good() || type != "PF" || scale >= 0.0f)
+		return false;
+
+	//a single whitespace character ends the header
+	file.get();
+
+	captured.pixels.resize(static_cast<size_t>(captured.width) * captured.height);
+
+	std::vector<float> row(static_cast<size_t>(captured.width) * 3);
+
+	for (uint32_t y = captured.height; y-- > 0;)
+	{
+		if (!file.read(reinterpret_cast<char*>(row.data()), row.size() * sizeof(float)))
+			return false;
+
+		for (uint32_t x = 0; x < captured.width; x++)
+		{
+			captured.pixels[static_cast<size_t>(y) * captured.width + x] = glm::vec4(row[x * 3 + 0], row[x * 3 + 1], row[x * 3 + 2], 1.0f);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Vulkan.h"
+#include "Benchmark.h"
+
+#define GOLDEN_MAX_PSNR 100.0 //reported for identical images
+
+//first level of a render target as RGBA floats, rows from the top
+struct CapturedImage
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<glm::vec4> pixels;
+};
+
+//Renders fixed camera poses headless and either stores the final image and the intermediate targets as goldens,
+//or compares every pass against its golden and reports the differences.
+//Goldens are RGB portable float maps, one per pass and pose, the alpha channels are not compared.
+class GoldenTest
+{
+public:
+
+	GoldenTest();
+
+	//copies a render target the device has finished with, returns false for formats without a float conversion
+	static bool readImage(Vulkan *vulkanApp, VkImage image, VkFormat format, VkExtent2D extent, VkImageLayout layout, CapturedImage &captured);
+
+	//stores the golden of a pass at a pose when capturing, otherwise compares the pass against it
+	//failing passes leave their output and a difference image next to the golden
+	void addImage(uint32_t poseIndex, std::string passName, const CapturedImage &captured);
+
+	//returns false when the file can not be opened
+	bool writeReport(std::string path);
+
+	//compared passes out of the thresholds or without a golden
+	uint32_t getFailedCount();
+
+	static bool writePFM(std::string path, const CapturedImage &captured);
+	static bool readPFM(std::string path, CapturedImage &captured);
+
+	bool bCapture;
+	std::string directory; //has to exist
+
+	uint32_t settleFrames; //rendered at every pose before its capture, temporal passes converge and the textures finish streaming
+	unsigned int frameStep; //simulated milliseconds per frame
+
+	int width;
+	int height;
+
+	//a pass fails below minPSNR or when more than 100 - errorPercentile % of its pixels are off by more than maxPixelError
+	//errors are relative to the brightest channel of the golden, at least 1.0
+	double minPSNR;
+	float maxPixelError;
+	float errorPercentile;
+
+	CameraPath cameraPath; //every key is one pose, the times do not matter
+
+private:
+
+	struct PassResult
+	{
+		uint32_t poseIndex;
+		std::string passName;
+
+		bool bGolden; //false when the golden is missing or its size differs
+		double psnr; //dB
+		float meanError;
+		float percentileError;
+		float maxError;
+
+		bool bPassed;
+	};
+
+	std::string getImagePath(uint32_t poseIndex, std::string passName, std::string suffix);
+
+	std::vector<PassResult> results;
+};
@@ -0,0 +1,178 @@
+#include "GpuTimer.h"
+#include "Vulkan.h"
+
+GpuTimer::GpuTimer() : vulkanApp(NULL), queryPool(VK_NULL_HANDLE), timestampPeriod(1.0f), submitTime(0)
+{
+
+}
+
+void GpuTimer::initialize(Vulkan *pVulkanApp)
+{
+	vulkanApp = pVulkanApp;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(vulkanApp->getPhysicalDevice(), &properties);
+
+	//without it timestamps are not guaranteed on every graphics and compute queue, the passes go untimed
+	if (properties.limits.timestampComputeAndGraphics == VK_FALSE)
+		return;
+
+	timestampPeriod = properties.limits.timestampPeriod;
+
+	VkQueryPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = GPU_TIMER_MAX_PASSES * 2;
+
+	if (vkCreateQueryPool(vulkanApp->getDevice(), &poolInfo, nullptr, &queryPool) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create query pool!");
+	}
+
+	//queries start out undefined, a pass that is never submitted must still read as unavailable
+	vkCmdResetQueryPool(vulkanApp->getUploadContext()->getGraphicsCommandBuffer(), queryPool, 0, GPU_TIMER_MAX_PASSES * 2);
+}
+
+void GpuTimer::shutDown()
+{
+	if (queryPool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(vulkanApp->getDevice(), queryPool, nullptr);
+
+	queryPool = VK_NULL_HANDLE;
+	passes.clear();
+}
+
+uint32_t GpuTimer::findPass(std::string name)
+{
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		if (passes[i].name == name)
+			return static_cast<uint32_t>(i);
+	}
+
+	if (passes.size() >= GPU_TIMER_MAX_PASSES)
+		return GPU_TIMER_MAX_PASSES;
+
+	GpuPass pass;
+	pass.name = name;
+	pass.traceName = Profiler::GetInstance()->internName(name);
+	pass.lastTime = 0.0f;
+	pass.averageTime = 0.0f;
+
+	passes.push_back(pass);
+
+	return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void GpuTimer::beginPass(VkCommandBuffer cmd, std::string name)
+{
+	if (!isSupported())
+		return;
+
+	uint32_t passIndex = findPass(name);
+
+	if (passIndex == GPU_TIMER_MAX_PASSES)
+		return;
+
+	vkCmdResetQueryPool(cmd, queryPool, passIndex * 2, 2);
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, passIndex * 2);
+}
+
+void GpuTimer::endPass(VkCommandBuffer cmd, std::string name)
+{
+	if (!isSupported())
+		return;
+
+	uint32_t passIndex = findPass(name);
+
+	if (passIndex == GPU_TIMER_MAX_PASSES)
+		return;
+
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, passIndex * 2 + 1);
+}
+
+void GpuTimer::markSubmit()
+{
+	submitTime = Profiler::GetInstance()->getTime();
+}
+
+void GpuTimer::resolve()
+{
+	if (!isSupported() || passes.empty())
+		return;
+
+	//value and availability of every query
+	std::vector<uint64_t> results(passes.size() * 4);
+
+	//VK_NOT_READY only means some passes have nothing new
+	VkResult result = vkGetQueryPoolResults(vulkanApp->getDevice(), queryPool, 0, static_cast<uint32_t>(passes.size() * 2), results.size() * sizeof(uint64_t), results.data(),
+		sizeof(uint64_t) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+	{
+		throw std::runtime_error("failed to get query pool results!");
+	}
+
+	uint64_t firstTimestamp = UINT64_MAX;
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		if (results[i * 4 + 1] != 0 && results[i * 4 + 3] != 0)
+			firstTimestamp = glm::min(firstTimestamp, results[i * 4]);
+	}
+
+	Profiler* profiler = Profiler::GetInstance();
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		uint64_t beginTimestamp = results[i * 4];
+		uint64_t endTimestamp = results[i * 4 + 2];
+
+		if (results[i * 4 + 1] == 0 || results[i * 4 + 3] == 0 || endTimestamp < beginTimestamp)
+			continue;
+
+		GpuPass &pass = passes[i];
+
+		pass.lastTime = static_cast<float>(static_cast<double>(endTimestamp - beginTimestamp) * timestampPeriod * 0.000001);
+		pass.averageTime = pass.averageTime == 0.0f ? pass.lastTime : glm::mix(pass.averageTime, pass.lastTime, 0.05f);
+
+		//the GPU clock is not the CPU one, the first pass of the frame is lined up with its submit
+		if (submitTime != 0)
+		{
+			uint64_t startTime = submitTime + static_cast<uint64_t>(static_cast<double>(beginTimestamp - firstTimestamp) * timestampPeriod);
+			uint64_t endTime = submitTime + static_cast<uint64_t>(static_cast<double>(endTimestamp - firstTimestamp) * timestampPeriod);
+
+			profiler->recordGPU(pass.traceName, startTime, endTime);
+		}
+	}
+}
+
+void GpuTimer::printPassTimes()
+{
+	if (!isSupported())
+	{
+		std::cout << "GPU timestamps are not supported" << std::endl;
+		return;
+	}
+
+	printf("%-32s %10s %10s\n", "GPU pass", "last ms", "avg ms");
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		printf("%-32s %10.3f %10.3f\n", passes[i].name.c_str(), passes[i].lastTime, passes[i].averageTime);
+	}
+
+	printf("%-32s %10.3f\n", "total", getFrameTime());
+}
+
+float GpuTimer::getFrameTime()
+{
+	float frameTime = 0.0f;
+
+	for (size_t i = 0; i < passes.size(); i++)
+	{
+		frameTime += passes[i].lastTime;
+	}
+
+	return frameTime;
+}
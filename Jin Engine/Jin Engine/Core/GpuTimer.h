@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Common.h"
+
+class Vulkan;
+
+//timestamps around every timed pass, each pass owns two queries that its command buffer resets and writes
+//the command buffers are recorded once and submitted every frame, so a pass keeps its queries for good
+class GpuTimer
+{
+public:
+
+	GpuTimer();
+
+	void initialize(Vulkan *pVulkanApp);
+	void shutDown();
+
+	//record right after vkBeginCommandBuffer and right before vkEndCommandBuffer, outside of a render pass
+	void beginPass(VkCommandBuffer cmd, std::string name);
+	void endPass(VkCommandBuffer cmd, std::string name);
+
+	//CPU time of the first submit of the frame, the GPU zones of the trace are placed relative to it
+	void markSubmit();
+
+	//main thread, before the frame is recorded and submitted, the previous frame has finished by then
+	//reads the queries that are available without waiting
+	void resolve();
+
+	//prints the last and the averaged time of every pass
+	void printPassTimes();
+
+	//sum of the passes of the last resolved frame in milliseconds, async compute passes overlap the others
+	float getFrameTime();
+
+	bool isSupported()
+	{
+		return queryPool != VK_NULL_HANDLE;
+	}
+
+private:
+
+	struct GpuPass
+	{
+		std::string name;
+		const char* traceName; //interned by the profiler, outlives the timer
+
+		float lastTime; //milliseconds
+		float averageTime;
+	};
+
+	uint32_t findPass(std::string name);
+
+	Vulkan *vulkanApp;
+
+	VkQueryPool queryPool;
+	float timestampPeriod; //nanoseconds per tick
+
+	std::vector<GpuPass> passes;
+
+	uint64_t submitTime; //of the frame the queries belong to until the next markSubmit
+};
@@ -91,6 +91,11 @@ static void keyboardCallback(GLFWwindow* window, int key, int scancode, int acti
 			interface->bUseInterpolation = !interface->bUseInterpolation;
 		}
 
+		if (key == GLFW_KEY_5)
+		{
+			interface->bUseHiZ = !interface->bUseHiZ;
+		}
+
 		if (key == GLFW_KEY_1)
 		{
 			interface->bUseNormalMap = !interface->bUseNormalMap;
@@ -106,6 +111,11 @@ static void keyboardCallback(GLFWwindow* window, int key, int scancode, int acti
 			interface->bUseHolePatching = !interface->bUseHolePatching;
 		}
 
+		if (key == GLFW_KEY_T && action == GLFW_PRESS)
+		{
+			interface->toggleSSRTemporal();
+		}
+
 		if (key == GLFW_KEY_R)
 		{
 			interface->bRotate = !interface->bRotate;
@@ -116,6 +126,65 @@ static void keyboardCallback(GLFWwindow* window, int key, int scancode, int acti
 			interface->bMoveForward = !interface->bMoveForward;
 		}
 
+		if (key == GLFW_KEY_6)
+		{
+			interface->bUseAutoExposure = !interface->bUseAutoExposure;
+		}
+
+		if (key == GLFW_KEY_9 && action == GLFW_PRESS)
+		{
+			interface->toggleBloom();
+		}
+
+		if (key == GLFW_KEY_P && action == GLFW_PRESS)
+		{
+			interface->bCaptureProfile = true;
+		}
+
+		if (key == GLFW_KEY_K && action == GLFW_PRESS)
+		{
+			interface->bRecordCameraPath = !interface->bRecordCameraPath;
+		}
+
+		if (key == GLFW_KEY_C && action == GLFW_PRESS)
+		{
+			interface->toggleClouds();
+		}
+
+		//Exposure compensation
+		if (key == GLFW_KEY_7)
+		{
+			interface->exposureCompensation -= 0.5f;
+
+			if (interface->exposureCompensation < -4.0f)
+				interface->exposureCompensation = -4.0f;
+		}
+
+		if (key == GLFW_KEY_8)
+		{
+			interface->exposureCompensation += 0.5f;
+
+			if (interface->exposureCompensation > 4.0f)
+				interface->exposureCompensation = 4.0f;
+		}
+
+		//Hole patching radius
+		if (key == GLFW_KEY_MINUS)
+		{
+			interface->SSRPatchRadius -= 1;
+
+			if (interface->SSRPatchRadius < 0)
+				interface->SSRPatchRadius = 0;
+		}
+
+		if (key == GLFW_KEY_EQUAL)
+		{
+			interface->SSRPatchRadius += 1;
+
+			if (interface->SSRPatchRadius > 4)
+				interface->SSRPatchRadius = 4;
+		}
+
 		//Roughness
 		if (key == GLFW_KEY_LEFT_BRACKET)
 		{
@@ -156,6 +225,10 @@ static void keyboardCallback(GLFWwindow* window, int key, int scancode, int acti
 
 void Interface::initWindow()
 {
+	//GPU-less machines may not have a display either
+	if (bHeadless)
+		return;
+
 	glfwInit();
 
 	setPrimaryMonitor();
@@ -202,6 +275,9 @@ void Interface::getAsynckeyState()
 
 void Interface::shutDown()
 {
+	if (bHeadless)
+		return;
+
 	glfwDestroyWindow(window);
 	glfwTerminate();
 }
@@ -22,7 +22,6 @@ public:
 		previousZ = 0.0;
 
 		fps = 0;
-		fpstracker = 0;
 
 		bFoward = false;
 		bBackward = false;
@@ -41,8 +40,41 @@ public:
 		SSRVisibility = 0;
 		bUseBruteForce = false;
 		bUseInterpolation = false;
+		bUseHiZ = true;
+		SSRHiZMaxIterations = 48;
+		SSRThickness = 0.5f;
+		SSRDownsample = 2;
+		bUseSSRTemporal = true;
+		SSRTemporalBlend = 0.1f;
+		SSRPatchRadius = 1;
 		bMoveForward = false;
 
+		//Sky
+		bRenderClouds = false;
+		cloudMarchSteps = 64;
+		cloudSearchStepScale = 2.0f;
+		cloudMinTransmittance = 0.01f;
+		cloudMaxZeroDensitySamples = 11;
+
+		//Exposure
+		bUseAutoExposure = true;
+		exposureCompensation = 0.0f;
+		exposureAdaptationSpeed = 1.5f;
+
+		//Bloom
+		bUseBloom = true;
+		bloomIntensity = 0.04f;
+		bloomRadius = 1.0f;
+
+		//Texture streaming
+		textureStreamingBudgetMB = 512;
+
+		//Profiler
+		bCaptureProfile = false;
+
+		//Benchmark
+		bHeadless = false;
+		bRecordCameraPath = false;
 	}
 
 	void shutDown();
@@ -64,10 +96,33 @@ public:
 		windowResetFlag = true;		
 	}
 
+	//the cloud passes and their volumes are built at initialization, so the renderer is reset
+	void toggleClouds()
+	{
+		shutDown();
+		bRenderClouds = !bRenderClouds;
+		windowResetFlag = true;
+	}
+
+	//the SSR temporal pass and its history targets only exist while it is on
+	void toggleSSRTemporal()
+	{
+		shutDown();
+		bUseSSRTemporal = !bUseSSRTemporal;
+		windowResetFlag = true;
+	}
+
+	//the bloom pyramid only exists while bloom is on
+	void toggleBloom()
+	{
+		shutDown();
+		bUseBloom = !bUseBloom;
+		windowResetFlag = true;
+	}
+
 	void getAsynckeyState();
 		
-	int fps;
-	int fpstracker;
+	int fps; //over the frame pacing window
 
 	const char* getEngineName();
 	GLFWwindow* getWindow();
@@ -100,9 +155,43 @@ public:
 	bool bUseHolePatching;
 	bool bUseBruteForce;
 	bool bUseInterpolation;
+	bool bUseHiZ; //brute force SSR walks the Hi-Z pyramid instead of fixed world space steps
+	int SSRHiZMaxIterations;
+	float SSRThickness; //view depth behind a surface still counted as a hit
+	int SSRDownsample; //1 - full, 2 - half, 4 - quarter resolution reflections, read at initialization
+	bool bUseSSRTemporal; //accumulate reflections over frames, SSR takes fewer samples per frame
+	float SSRTemporalBlend; //weight of the current frame in the temporal resolve
+	int SSRPatchRadius; //hole patching search radius in reflection texels, up to PATCH_MAX_RADIUS in holePatching.comp
 
 	int SSRVisibility;
 
+	//Sky
+	bool bRenderClouds;
+	int cloudMarchSteps;
+	float cloudSearchStepScale;
+	float cloudMinTransmittance;
+	int cloudMaxZeroDensitySamples;
+
+	//Exposure
+	bool bUseAutoExposure; //exposure from the luminance histogram, otherwise only the compensation applies
+	float exposureCompensation; //in EV
+	float exposureAdaptationSpeed; //how fast the adapted luminance follows the scene, per second
+
+	//Bloom
+	bool bUseBloom;
+	float bloomIntensity; //share of the bloom pyramid in the final color
+	float bloomRadius; //tent filter radius of the upsamples in texels of the smaller level
+
+	//Texture streaming
+	int textureStreamingBudgetMB; //device memory for streamed mip chains, the least recently used ones fall back to what they need beyond it
+
+	//Profiler
+	bool bCaptureProfile; //the recorded CPU zones are written to profile.json at the start of the next frame
+
+	//Benchmark
+	bool bHeadless; //no window and no swapchain, the frames go to offscreen images of window_Width x window_Height, set before initWindow
+	bool bRecordCameraPath; //the camera poses are recorded while set and written to camera_path.txt when it is cleared
+
 private:
 	GLFWwindow* window;
 	GLFWmonitor* primaryMonitor;
@@ -0,0 +1,334 @@
+#include "MicroBenchmark.h"
+
+#include <random>
+
+#include "../Asset/AssetDB.h"
+#include "../Actor/Camera.h"
+
+static BoundingBox makeBox(glm::vec4 center, glm::vec4 extents)
+{
+	BoundingBox box;
+
+	box.Center = center;
+	box.Extents = extents;
+	box.minPt = center - extents;
+	box.maxPt = center + extents;
+
+	box.corners[0] = center + glm::vec4(-extents.x, -extents.y, -extents.z, 0.0);
+	box.corners[1] = center + glm::vec4(extents.x, -extents.y, -extents.z, 0.0);
+	box.corners[2] = center + glm::vec4(-extents.x, extents.y, -extents.z, 0.0);
+	box.corners[3] = center + glm::vec4(-extents.x, -extents.y, extents.z, 0.0);
+
+	box.corners[4] = center + glm::vec4(-extents.x, extents.y, extents.z, 0.0);
+	box.corners[5] = center + glm::vec4(extents.x, -extents.y, extents.z, 0.0);
+	box.corners[6] = center + glm::vec4(extents.x, extents.y, -extents.z, 0.0);
+	box.corners[7] = center + glm::vec4(extents.x, extents.y, extents.z, 0.0);
+
+	box.cullingInfo = glm::vec4(0.0f);
+
+	return box;
+}
+
+//a gridSize x gridSize patch of a wavy surface with everything setGeometry reads
+static aiMesh* createGridMesh(unsigned int gridSize)
+{
+	aiMesh* mesh = new aiMesh;
+
+	mesh->mNumVertices = gridSize * gridSize;
+	mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+	mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+	mesh->mTangents = new aiVector3D[mesh->mNumVertices];
+	mesh->mBitangents = new aiVector3D[mesh->mNumVertices];
+	mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+	mesh->mNumUVComponents[0] = 2;
+
+	for (unsigned int y = 0; y < gridSize; y++)
+	{
+		for (unsigned int x = 0; x < gridSize; x++)
+		{
+			unsigned int i = y * gridSize + x;
+
+			float u = static_cast<float>(x) / static_cast<float>(gridSize - 1);
+			float v = static_cast<float>(y) / static_cast<float>(gridSize - 1);
+
+			mesh->mVertices[i] = aiVector3D(u * 10.0f, glm::sin(u * 20.0f) * glm::cos(v * 20.0f) * 0.2f, v * 10.0f);
+			mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+			mesh->mTangents[i] = aiVector3D(1.0f, 0.0f, 0.0f);
+			mesh->mBitangents[i] = aiVector3D(0.0f, 0.0f, 1.0f);
+			mesh->mTextureCoords[0][i] = aiVector3D(u * 4.0f, v * 4.0f, 0.0f);
+		}
+	}
+
+	mesh->mNumFaces = (gridSize - 1) * (gridSize - 1) * 2;
+	mesh->mFaces = new aiFace[mesh->mNumFaces];
+
+	unsigned int face = 0;
+
+	for (unsigned int y = 0; y + 1 < gridSize; y++)
+	{
+		for (unsigned int x = 0; x + 1 < gridSize; x++)
+		{
+			unsigned int i = y * gridSize + x;
+			unsigned int quad[6] = { i, i + gridSize, i + 1, i + 1, i + gridSize, i + gridSize + 1 };
+
+			for (unsigned int j = 0; j < 2; j++)
+			{
+				mesh->mFaces[face].mNumIndices = 3;
+				mesh->mFaces[face].mIndices = new unsigned int[3];
+				mesh->mFaces[face].mIndices[0] = quad[j * 3];
+				mesh->mFaces[face].mIndices[1] = quad[j * 3 + 1];
+				mesh->mFaces[face].mIndices[2] = quad[j * 3 + 2];
+				face++;
+			}
+		}
+	}
+
+	return mesh;
+}
+
+MicroBenchmark::MicroBenchmark() : sink(0.0f)
+{
+
+}
+
+void MicroBenchmark::measure(std::string name, std::string unit, size_t itemsPerCall, std::function<void()> setup, std::function<void()> op)
+{
+	//the first call warms the caches and the allocator
+	setup();
+	op();
+
+	uint64_t calls = 0;
+	double measuredTime = 0.0;
+
+	while (measuredTime < MICRO_BENCHMARK_MIN_TIME || calls < MICRO_BENCHMARK_MIN_CALLS)
+	{
+		setup();
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+		op();
+		std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+
+		measuredTime += std::chrono::duration<double>(endTime - startTime).count();
+		calls++;
+	}
+
+	double callTime = measuredTime / static_cast<double>(calls);
+	double throughput = static_cast<double>(itemsPerCall) / callTime;
+
+	printf("%-48s %10llu %14.3f %14.3f M %s/s\n", name.c_str(), static_cast<unsigned long long>(calls), callTime * 1000000.0, throughput * 0.000001, unit.c_str());
+}
+
+void MicroBenchmark::measureCulling(std::string inputName, std::vector<BoundingBox> &boxes)
+{
+	if (boxes.empty())
+		return;
+
+	//the camera of the renderer, looking across the boxes
+	glm::mat4 viewMat = glm::lookAtRH(glm::vec3(0.0f, 2.0f, 20.0f), glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	Frustum frustum;
+	frustum.update(glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, NEAR_PLANE, FAR_PLANE));
+
+	std::vector<BoundingBox> viewBoxes(boxes.size());
+
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		viewBoxes[i] = Camera::getViewAABB(boxes[i], viewMat);
+	}
+
+	measure("Camera::getViewAABB " + inputName, "boxes", boxes.size(), [] {}, [&]
+	{
+		float result = 0.0f;
+
+		for (size_t i = 0; i < boxes.size(); i++)
+		{
+			result += Camera::getViewAABB(boxes[i], viewMat).Center.z;
+		}
+
+		sink = sink + result;
+	});
+
+	measure("Frustum::checkBox " + inputName, "boxes", boxes.size(), [] {}, [&]
+	{
+		uint32_t visible = 0;
+
+		for (size_t i = 0; i < viewBoxes.size(); i++)
+		{
+			if (frustum.checkBox(viewBoxes[i]))
+				visible++;
+		}
+
+		sink = sink + static_cast<float>(visible);
+	});
+}
+
+void MicroBenchmark::measureGeometry(std::string inputName, std::vector<const aiMesh*> &meshes)
+{
+	if (meshes.empty())
+		return;
+
+	size_t numVertices = 0;
+	size_t numTriangles = 0;
+
+	//the untouched CPU copies fillTBN starts from in every call
+	std::vector<Geometry> sourceGeoms(meshes.size());
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		numVertices += meshes[i]->mNumVertices;
+		numTriangles += meshes[i]->mNumFaces;
+
+		sourceGeoms[i].setGeometry(meshes[i]);
+	}
+
+	measure("Geometry::setGeometry " + inputName, "vertices", numVertices, [] {}, [&]
+	{
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			Geometry geom;
+			geom.setGeometry(meshes[i]);
+
+			sink = sink + geom.uvSpan;
+		}
+	});
+
+	std::vector<Geometry> geoms;
+
+	measure("Geometry::fillTBN " + inputName, "triangles", numTriangles, [&] { geoms = sourceGeoms; }, [&]
+	{
+		for (size_t i = 0; i < geoms.size(); i++)
+		{
+			geoms[i].fillTBN();
+
+			sink = sink + geoms[i].getVertices()[0].tangents.x;
+		}
+	});
+}
+
+void MicroBenchmark::measureActorUpdate(size_t numActors)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> distribution(-50.0f, 50.0f);
+
+	std::vector<Actor> actors(numActors);
+
+	for (size_t i = 0; i < actors.size(); i++)
+	{
+		actors[i].position = glm::vec3(distribution(random), distribution(random), distribution(random));
+		actors[i].phi = distribution(random) * 3.6f;
+	}
+
+	measure("Actor::update synthetic", "actors", actors.size(), [] {}, [&]
+	{
+		for (size_t i = 0; i < actors.size(); i++)
+		{
+			actors[i].update();
+		}
+
+		sink = sink + actors[0].InvTransposeMat[0][0];
+	});
+}
+
+void MicroBenchmark::measureFindAsset(std::string inputName, std::vector<std::string> &names)
+{
+	if (names.empty())
+		return;
+
+	//a database of its own, the global one stays empty
+	AssetDatabase database;
+
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		database.SaveAsset<Geometry>(new Geometry, names[i]);
+	}
+
+	measure("AssetDatabase::FindAsset " + inputName, "lookups", names.size(), [] {}, [&]
+	{
+		size_t found = 0;
+
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			if (database.FindAsset<Geometry>(names[i]) != nullptr)
+				found++;
+		}
+
+		sink = sink + static_cast<float>(found);
+	});
+
+	//the names are unique, every geometry is released once
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		delete database.FindAsset<Geometry>(names[i]);
+	}
+}
+
+void MicroBenchmark::runAll(std::string scenePath)
+{
+	printf("%-48s %10s %14s %16s\n", "case", "calls", "us/call", "throughput");
+
+	//synthetic
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> extent(0.1f, 5.0f);
+
+		std::vector<BoundingBox> boxes(4096);
+
+		for (size_t i = 0; i < boxes.size(); i++)
+		{
+			boxes[i] = makeBox(glm::vec4(position(random), position(random) * 0.1f, position(random), 1.0f), glm::vec4(extent(random), extent(random), extent(random), 0.0f));
+		}
+
+		measureCulling("synthetic", boxes);
+
+		aiMesh* grid = createGridMesh(256);
+		std::vector<const aiMesh*> meshes(1, grid);
+
+		measureGeometry("synthetic", meshes);
+
+		delete grid;
+
+		measureActorUpdate(4096);
+
+		std::vector<std::string> names;
+
+		for (size_t i = 0; i < 1024; i++)
+		{
+			names.push_back("Asset/Object/synthetic/mesh_" + std::to_string(i) + "_synthetic_" + std::to_string(i));
+		}
+
+		measureFindAsset("synthetic", names);
+	}
+
+	//scene
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(scenePath, OBJECT_IMPORT_FLAGS);
+
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	{
+		std::cout << "skipped " << scenePath << ", " << importer.GetErrorString() << std::endl;
+		return;
+	}
+
+	std::vector<const aiMesh*> meshes;
+	std::vector<BoundingBox> boxes;
+	std::vector<std::string> names;
+
+	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+	{
+		meshes.push_back(scene->mMeshes[i]);
+
+		Geometry geom;
+		geom.setGeometry(scene->mMeshes[i]);
+		boxes.push_back(geom.AABB);
+
+		//named the way Object::processNode names them
+		names.push_back(std::string(scene->mMeshes[i]->mName.C_Str()) + "_scene_" + std::to_string(i));
+	}
+
+	std::string inputName = scenePath.substr(scenePath.find_last_of("/\\") + 1);
+
+	measureCulling(inputName, boxes);
+	measureGeometry(inputName, meshes);
+	measureFindAsset(inputName, names);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Common.h"
+
+#include <functional>
+
+#define MICRO_BENCHMARK_MIN_TIME 0.5 //seconds measured per case
+#define MICRO_BENCHMARK_MIN_CALLS 10
+
+struct aiMesh;
+
+//CPU hot paths measured in isolation, nothing here creates a Vulkan device
+//every case runs over synthetic inputs and, when the scene file can be read, over the meshes of the scene
+class MicroBenchmark
+{
+public:
+
+	MicroBenchmark();
+
+	void runAll(std::string scenePath);
+
+private:
+
+	//times op alone, setup runs before every call outside of the measurement
+	//itemsPerCall inputs are processed by one call, unit names them in the table
+	void measure(std::string name, std::string unit, size_t itemsPerCall, std::function<void()> setup, std::function<void()> op);
+
+	void measureCulling(std::string inputName, std::vector<BoundingBox> &boxes);
+	void measureGeometry(std::string inputName, std::vector<const aiMesh*> &meshes);
+	void measureActorUpdate(size_t numActors);
+	void measureFindAsset(std::string inputName, std::vector<std::string> &names);
+
+	//the results flow into it so that the compiler can not drop the work
+	volatile float sink;
+};
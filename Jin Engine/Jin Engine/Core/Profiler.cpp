@@ -0,0 +1,136 @@
+#include "Profiler.h"
+
+Profiler* Profiler::instance = nullptr;
+
+Profiler::Profiler() : bEnabled(true), gpuBuffer(NULL)
+{
+	startTime = std::chrono::steady_clock::now();
+}
+
+Profiler* Profiler::GetInstance()
+{
+	if (instance == nullptr)
+		instance = new Profiler();
+
+	return instance;
+}
+
+uint64_t Profiler::getTime()
+{
+	//never 0, a zone that started while the profiler was disabled keeps 0
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count()) + 1;
+}
+
+Profiler::ThreadBuffer* Profiler::createBuffer(const char* name)
+{
+	ThreadBuffer* buffer = new ThreadBuffer();
+	buffer->threadName = name;
+	buffer->events.resize(PROFILER_RING_SIZE);
+	buffer->eventCount = 0;
+
+	//kept after the thread exits, its zones are still exported
+	std::lock_guard<std::mutex> lock(mutex);
+	buffer->threadID = static_cast<uint32_t>(threadBuffers.size());
+	threadBuffers.push_back(buffer);
+
+	return buffer;
+}
+
+Profiler::ThreadBuffer* Profiler::getThreadBuffer()
+{
+	static thread_local ThreadBuffer* threadBuffer = NULL;
+
+	if (threadBuffer == NULL)
+		threadBuffer = createBuffer(NULL);
+
+	return threadBuffer;
+}
+
+void Profiler::write(ThreadBuffer* buffer, const char* name, uint64_t startTime, uint64_t endTime)
+{
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+
+	ProfileEvent &event = buffer->events[buffer->eventCount % PROFILER_RING_SIZE];
+	event.name = name;
+	event.startTime = startTime;
+	event.endTime = endTime;
+
+	buffer->eventCount++;
+}
+
+void Profiler::record(const char* name, uint64_t startTime, uint64_t endTime)
+{
+	write(getThreadBuffer(), name, startTime, endTime);
+}
+
+void Profiler::recordGPU(const char* name, uint64_t startTime, uint64_t endTime)
+{
+	//only the main thread resolves the GPU timer
+	if (gpuBuffer == NULL)
+		gpuBuffer = createBuffer("GPU");
+
+	write(gpuBuffer, name, startTime, endTime);
+}
+
+const char* Profiler::internName(std::string name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	//set nodes do not move
+	return names.insert(name).first->c_str();
+}
+
+void Profiler::setThreadName(const char* name)
+{
+	ThreadBuffer* buffer = getThreadBuffer();
+
+	//the export reads the name from another thread
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+	buffer->threadName = name;
+}
+
+bool Profiler::exportChromeTrace(std::string path)
+{
+	std::ofstream file(path);
+
+	if (!file.is_open())
+		return false;
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool bFirst = true;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (size_t i = 0; i < threadBuffers.size(); i++)
+	{
+		ThreadBuffer* threadBuffer = threadBuffers[i];
+
+		std::lock_guard<std::mutex> threadLock(threadBuffer->mutex);
+
+		if (threadBuffer->threadName != NULL)
+		{
+			file << (bFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadBuffer->threadID
+				<< ",\"args\":{\"name\":\"" << threadBuffer->threadName << "\"}}";
+			bFirst = false;
+		}
+
+		//oldest first, once the ring has wrapped it starts right after the newest
+		uint64_t firstEvent = threadBuffer->eventCount > PROFILER_RING_SIZE ? threadBuffer->eventCount - PROFILER_RING_SIZE : 0;
+
+		for (uint64_t j = firstEvent; j < threadBuffer->eventCount; j++)
+		{
+			const ProfileEvent &event = threadBuffer->events[j % PROFILER_RING_SIZE];
+
+			//complete events, timestamps in microseconds
+			file << (bFirst ? "" : ",") << "\n{\"name\":\"" << event.name << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadBuffer->threadID
+				<< ",\"ts\":" << event.startTime / 1000 << "." << (event.startTime % 1000) / 100
+				<< ",\"dur\":" << (event.endTime - event.startTime) / 1000 << "." << ((event.endTime - event.startTime) % 1000) / 100 << "}";
+			bFirst = false;
+		}
+	}
+
+	file << "\n]}\n";
+
+	return file.good();
+}
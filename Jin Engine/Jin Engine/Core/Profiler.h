@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Common.h"
+
+#include <mutex>
+#include <set>
+
+//one closed zone, name has to outlive the profiler, in practice a string literal
+struct ProfileEvent
+{
+	const char* name;
+	uint64_t startTime; //nanoseconds since the profiler started
+	uint64_t endTime;
+};
+
+//scoped CPU zones of every thread, each thread writes into its own ring of the last PROFILER_RING_SIZE zones
+//the rings are exported as a Chrome trace, chrome://tracing or https://ui.perfetto.dev open it
+class Profiler
+{
+public:
+
+	static Profiler* GetInstance();
+
+	uint64_t getTime();
+
+	void record(const char* name, uint64_t startTime, uint64_t endTime);
+
+	//zones of the GPU timer, on their own track already converted to the CPU clock
+	void recordGPU(const char* name, uint64_t startTime, uint64_t endTime);
+
+	//a copy of name that lives as long as the profiler, for zone names that are not literals
+	const char* internName(std::string name);
+
+	//names the calling thread in the trace
+	void setThreadName(const char* name);
+
+	//writes the zones still in the rings, returns false when the file can not be opened
+	bool exportChromeTrace(std::string path);
+
+	bool bEnabled; //zones are skipped at runtime when false
+
+private:
+
+	Profiler();
+
+	struct ThreadBuffer
+	{
+		uint32_t threadID;
+
+		//guarded by mutex, only contended while exporting
+		std::mutex mutex;
+		const char* threadName;
+		std::vector<ProfileEvent> events;
+		uint64_t eventCount; //written so far, the ring index is eventCount % PROFILER_RING_SIZE
+	};
+
+	ThreadBuffer* getThreadBuffer();
+	ThreadBuffer* createBuffer(const char* name);
+
+	void write(ThreadBuffer* buffer, const char* name, uint64_t startTime, uint64_t endTime);
+
+	static Profiler* instance;
+
+	std::chrono::steady_clock::time_point startTime;
+
+	std::mutex mutex;
+	std::vector<ThreadBuffer*> threadBuffers;
+	ThreadBuffer* gpuBuffer;
+
+	std::set<std::string> names; //guarded by mutex
+};
+
+class ProfileZone
+{
+public:
+
+	ProfileZone(const char* nameParam) : name(nameParam)
+	{
+		Profiler* profiler = Profiler::GetInstance();
+		startTime = profiler->bEnabled ? profiler->getTime() : 0;
+	}
+
+	~ProfileZone()
+	{
+		Profiler* profiler = Profiler::GetInstance();
+
+		if (profiler->bEnabled && startTime != 0)
+			profiler->record(name, startTime, profiler->getTime());
+	}
+
+private:
+
+	const char* name;
+	uint64_t startTime;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+//times the rest of the enclosing scope
+#if USE_CPU_PROFILER
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
@@ -0,0 +1,77 @@
+#include "Sky.h"
+
+static float Remap(float value, float original_min, float original_max, float new_min, float new_max)
+{
+	return new_min + ((value - original_min) / (original_max - original_min)) * (new_max - new_min);
+}
+
+void Sky::createOccupancyBuffer(Vulkan* pVulkanApp, std::vector<unsigned char> &lowFreqPixels, int noiseSize)
+{
+	vulkanApp = pVulkanApp;
+
+	VkDeviceSize bufferSize = sizeof(float) * CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE;
+
+	vulkanApp->createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		occupancyBuffer, occupancyBufferMemory);
+
+	//no CPU copy of the noise (compressed volume), every cell is treated as occupied
+	if (lowFreqPixels.size() < static_cast<size_t>(noiseSize) * noiseSize * noiseSize * 4)
+	{
+		std::vector<float> fullOccupancy(CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE, 1.0f);
+		vulkanApp->updateBuffer(fullOccupancy.data(), occupancyBufferMemory, bufferSize);
+		return;
+	}
+
+	//base cloud shape of sky.frag for every texel
+	std::vector<float> baseCloud(static_cast<size_t>(noiseSize) * noiseSize * noiseSize);
+
+	for (size_t i = 0; i < baseCloud.size(); i++)
+	{
+		float r = lowFreqPixels[i * 4 + 0] / 255.0f;
+		float g = lowFreqPixels[i * 4 + 1] / 255.0f;
+		float b = lowFreqPixels[i * 4 + 2] / 255.0f;
+		float a = lowFreqPixels[i * 4 + 3] / 255.0f;
+
+		float lowFreqFBM = g * 0.625f + b * 0.25f + a * 0.125f;
+		baseCloud[i] = glm::clamp(Remap(r, lowFreqFBM - 1.0f, 1.0f, 0.0f, 1.0f), 0.0f, 1.0f);
+	}
+
+	//the remap is quasi-convex, so the max over the texels bounds every trilinear sample in the cell
+	std::vector<float> occupancy(CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE * CLOUD_OCCUPANCY_SIZE, 0.0f);
+
+	for (int z = 0; z < CLOUD_OCCUPANCY_SIZE; z++)
+	{
+		for (int y = 0; y < CLOUD_OCCUPANCY_SIZE; y++)
+		{
+			for (int x = 0; x < CLOUD_OCCUPANCY_SIZE; x++)
+			{
+				glm::ivec3 cell = glm::ivec3(x, y, z);
+
+				//one more texel on each side for the bilinear footprint, wrapped like the sampler
+				glm::ivec3 start = cell * noiseSize / CLOUD_OCCUPANCY_SIZE - glm::ivec3(1);
+				glm::ivec3 end = (cell + glm::ivec3(1)) * noiseSize / CLOUD_OCCUPANCY_SIZE;
+
+				float maxBase = 0.0f;
+
+				for (int tz = start.z; tz <= end.z; tz++)
+				{
+					for (int ty = start.y; ty <= end.y; ty++)
+					{
+						for (int tx = start.x; tx <= end.x; tx++)
+						{
+							int wx = (tx + noiseSize) % noiseSize;
+							int wy = (ty + noiseSize) % noiseSize;
+							int wz = (tz + noiseSize) % noiseSize;
+
+							maxBase = std::max(maxBase, baseCloud[(static_cast<size_t>(wz) * noiseSize + wy) * noiseSize + wx]);
+						}
+					}
+				}
+
+				occupancy[(z * CLOUD_OCCUPANCY_SIZE + y) * CLOUD_OCCUPANCY_SIZE + x] = maxBase;
+			}
+		}
+	}
+
+	vulkanApp->updateBuffer(occupancy.data(), occupancyBufferMemory, bufferSize);
+}
@@ -7,7 +7,7 @@ class Sky
 {
 public:
 	
-	Sky()
+	Sky():vulkanApp(NULL), occupancyBuffer(NULL), occupancyBufferMemory(NULL)
 	{
 		sun.updateOrbit(90.0f, 0.0f, 0.0);
 
@@ -15,17 +15,34 @@ public:
 		highFreqTexture = new Texture;
 	}
 
+	//nothing is created while clouds are off
 	void shutDown()
 	{
-		lowFreqTexture->shutDown();
-		highFreqTexture->shutDown();
+		if (vulkanApp)
+		{
+			lowFreqTexture->shutDown();
+			highFreqTexture->shutDown();
+
+			vkDestroyBuffer(vulkanApp->getDevice(), occupancyBuffer, nullptr);
+			vkFreeMemory(vulkanApp->getDevice(), occupancyBufferMemory, nullptr);
+
+			vulkanApp = NULL;
+		}
 	}
 
+	void createOccupancyBuffer(Vulkan* pVulkanApp, std::vector<unsigned char> &lowFreqPixels, int noiseSize);
+
 	DirectionalLight sun;
 
 	Texture* lowFreqTexture;
 	Texture* highFreqTexture;
 
+	//max density of each cell of the low frequency noise, for empty space skipping
+	VkBuffer occupancyBuffer;
+	VkDeviceMemory occupancyBufferMemory;
+
 private:
 
+	Vulkan* vulkanApp;
+
 };
\ No newline at end of file
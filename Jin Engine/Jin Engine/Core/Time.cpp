@@ -0,0 +1,111 @@
+#include "Time.h"
+
+Time::Time() : previousFrameTime(0), deltaTime(0.0), renderDeltaTime(0.0), accumulator(0.0), simulationTime(FIXED_TIMESTEP), frameCount(0)
+{
+	//the starting state counts as the first step, render times start at 0
+	startTime = std::chrono::steady_clock::now();
+	frameTimes.resize(FRAME_PACING_WINDOW);
+}
+
+uint64_t Time::getTime()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+void Time::beginFrame()
+{
+	uint64_t frameTime = getTime();
+
+	//the first frame starts the clock
+	double frameDelta = frameCount > 0 ? (frameTime - previousFrameTime) * 0.000000001 : 0.0;
+	previousFrameTime = frameTime;
+
+	advance(frameDelta);
+}
+
+void Time::beginFrame(double frameDelta)
+{
+	previousFrameTime = getTime();
+
+	advance(frameDelta);
+}
+
+void Time::advance(double frameDelta)
+{
+	double previousRenderTime = getRenderTime();
+
+	deltaTime = frameDelta;
+
+	if (frameCount > 0)
+		frameTimes[(frameCount - 1) % FRAME_PACING_WINDOW] = frameDelta * 1000.0;
+
+	frameCount++;
+
+	//after a hitch the simulation drops the time it can not catch up with instead of spiralling
+	accumulator = glm::min(accumulator + frameDelta, FIXED_TIMESTEP * MAX_STEPS_PER_FRAME);
+
+	//steps move time from the accumulator to the simulation, the render time of the frame is already final
+	renderDeltaTime = getRenderTime() - previousRenderTime;
+}
+
+bool Time::step()
+{
+	if (accumulator < FIXED_TIMESTEP)
+		return false;
+
+	accumulator -= FIXED_TIMESTEP;
+	simulationTime += FIXED_TIMESTEP;
+
+	return true;
+}
+
+Time::FramePacing Time::getFramePacing()
+{
+	FramePacing pacing = {};
+
+	size_t count = std::min(frameCount > 0 ? frameCount - 1 : 0, static_cast<size_t>(FRAME_PACING_WINDOW));
+
+	if (count == 0)
+		return pacing;
+
+	std::vector<double> times(frameTimes.begin(), frameTimes.begin() + count);
+	std::sort(times.begin(), times.end());
+
+	double sum = 0.0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		sum += times[i];
+	}
+
+	pacing.mean = sum / static_cast<double>(count);
+
+	double squaredSum = 0.0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		squaredSum += (times[i] - pacing.mean) * (times[i] - pacing.mean);
+	}
+
+	//nearest rank
+	auto percentile = [&times](double p)
+	{
+		size_t rank = static_cast<size_t>(std::ceil(p * 0.01 * static_cast<double>(times.size())));
+		return times[rank > 0 ? rank - 1 : 0];
+	};
+
+	pacing.p50 = percentile(50.0);
+	pacing.p99 = percentile(99.0);
+	pacing.min = times.front();
+	pacing.max = times.back();
+	pacing.stdDev = std::sqrt(squaredSum / static_cast<double>(count));
+	pacing.fps = pacing.mean > 0.0 ? 1000.0 / pacing.mean : 0.0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (times[i] > 2.0 * pacing.p50)
+			pacing.hitches++;
+	}
+
+	return pacing;
+}
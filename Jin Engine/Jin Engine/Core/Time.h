@@ -1,32 +1,89 @@
 #pragma once
-#include <chrono>
 
-static unsigned int currentTime = 0;
-static unsigned int deltaTime = 0;
-static unsigned int previousTime = 0;
+#include "Common.h"
 
-static unsigned int fpsPreviosTime = 0;
+//Wall clock of the frame loop, and the fixed step simulation clock it drives.
+//Every frame adds its duration to an accumulator that step() spends FIXED_TIMESTEP at a time,
+//the frame then shows the simulated state blended between the last two steps with getAlpha().
+class Time
+{
+public:
 
+	//frame times in milliseconds over the last FRAME_PACING_WINDOW frames
+	struct FramePacing
+	{
+		double mean;
+		double p50;
+		double p99;
+		double min;
+		double max;
+		double stdDev;
+		double fps;
+		uint32_t hitches; //frames longer than twice the median
+	};
 
+	Time();
 
-using namespace std::chrono;
+	//nanoseconds since the clock was created
+	uint64_t getTime();
 
-class Time
-{
-public:
+	//starts a frame, the wall time since the previous one is handed to the simulation
+	void beginFrame();
 
-	Time()
+	//starts a frame that took frameDelta seconds, for runs that have to see the same times however fast they render
+	void beginFrame(double frameDelta);
+
+	//true while a fixed step is due, the simulation time has then advanced by it
+	bool step();
+
+	//seconds
+	double getDeltaTime()
+	{
+		return deltaTime;
+	}
+
+	double getStepTime()
 	{
-		startTime = high_resolution_clock::now();
+		return FIXED_TIMESTEP;
 	}
 
-	unsigned int getTime()
+	double getSimulationTime()
 	{
-		time_point<steady_clock> currentTime = high_resolution_clock::now();
-		return static_cast<unsigned int>(duration_cast<milliseconds>(currentTime - startTime).count());
+		return simulationTime;
 	}
+
+	//fraction of a step the frame is ahead of the last one, 0 shows the previous step and 1 the last one
+	double getAlpha()
+	{
+		return accumulator / FIXED_TIMESTEP;
+	}
+
+	//simulation time the frame shows, between the last two steps
+	double getRenderTime()
+	{
+		return simulationTime - FIXED_TIMESTEP + accumulator;
+	}
+
+	//render time that passed since the previous frame
+	double getRenderDeltaTime()
+	{
+		return renderDeltaTime;
+	}
+
+	FramePacing getFramePacing();
+
 private:
 
-	time_point<steady_clock> startTime;
+	void advance(double frameDelta);
+
+	std::chrono::steady_clock::time_point startTime;
+	uint64_t previousFrameTime;
+
+	double deltaTime;
+	double renderDeltaTime;
+	double accumulator;
+	double simulationTime;
 
-};
\ No newline at end of file
+	std::vector<double> frameTimes; //ring of the last FRAME_PACING_WINDOW frames
+	size_t frameCount;
+};
@@ -0,0 +1,438 @@
+#include "UploadContext.h"
+#include "Vulkan.h"
+
+UploadContext::UploadContext() : vulkanApp(NULL), arenaBuffer(NULL), arenaMemory(NULL), arenaData(NULL), arenaHead(0), arenaUsed(0), submittedTicket(0), completedTicket(0)
+{
+
+}
+
+void UploadContext::initialize(Vulkan *pVulkanApp)
+{
+	vulkanApp = pVulkanApp;
+
+	QueueFamilyIndices indices = vulkanApp->findQueueFamilies(vulkanApp->getPhysicalDevice(), vulkanApp->getSurface());
+	transferFamily = indices.transferFamily;
+	graphicsFamily = indices.graphicsFamily;
+
+	//only the transfer queue reads the ring
+	vulkanApp->createBuffer(UPLOAD_ARENA_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		arenaBuffer, arenaMemory, VK_SHARING_MODE_EXCLUSIVE);
+
+	void* data;
+	vkMapMemory(vulkanApp->getDevice(), arenaMemory, 0, UPLOAD_ARENA_SIZE, 0, &data);
+	arenaData = static_cast<char*>(data);
+
+	batches.resize(UPLOAD_BATCH_COUNT);
+
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		UploadBatch &batch = batches[i];
+
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = 1;
+
+		allocInfo.commandPool = vulkanApp->getTransferCmdPool();
+
+		if (vkAllocateCommandBuffers(vulkanApp->getDevice(), &allocInfo, &batch.transferCmd) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate command buffers!");
+		}
+
+		allocInfo.commandPool = vulkanApp->getGraphicsCmdPool();
+
+		if (vkAllocateCommandBuffers(vulkanApp->getDevice(), &allocInfo, &batch.graphicsCmd) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate command buffers!");
+		}
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+		if (vkCreateSemaphore(vulkanApp->getDevice(), &semaphoreInfo, nullptr, &batch.transferSemaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create semaphores!");
+		}
+
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if (vkCreateFence(vulkanApp->getDevice(), &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create fence!");
+		}
+
+		batch.bTransferRecording = false;
+		batch.bGraphicsRecording = false;
+		batch.bInFlight = false;
+		batch.arenaBytes = 0;
+	}
+}
+
+void UploadContext::shutDown()
+{
+	if (!vulkanApp)
+		return;
+
+	waitIdle();
+
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		vkFreeCommandBuffers(vulkanApp->getDevice(), vulkanApp->getTransferCmdPool(), 1, &batches[i].transferCmd);
+		vkFreeCommandBuffers(vulkanApp->getDevice(), vulkanApp->getGraphicsCmdPool(), 1, &batches[i].graphicsCmd);
+
+		vkDestroySemaphore(vulkanApp->getDevice(), batches[i].transferSemaphore, nullptr);
+		vkDestroyFence(vulkanApp->getDevice(), batches[i].fence, nullptr);
+	}
+
+	batches.clear();
+
+	vkUnmapMemory(vulkanApp->getDevice(), arenaMemory);
+	vkDestroyBuffer(vulkanApp->getDevice(), arenaBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), arenaMemory, nullptr);
+
+	vulkanApp = NULL;
+}
+
+VkCommandBuffer UploadContext::getTransferCommandBuffer()
+{
+	UploadBatch &batch = getBatch(getOpenTicket());
+
+	if (!batch.bTransferRecording)
+	{
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(batch.transferCmd, &beginInfo);
+		batch.bTransferRecording = true;
+	}
+
+	return batch.transferCmd;
+}
+
+VkCommandBuffer UploadContext::getGraphicsCommandBuffer()
+{
+	UploadBatch &batch = getBatch(getOpenTicket());
+
+	if (!batch.bGraphicsRecording)
+	{
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(batch.graphicsCmd, &beginInfo);
+		batch.bGraphicsRecording = true;
+	}
+
+	return batch.graphicsCmd;
+}
+
+bool UploadContext::isSameQueue()
+{
+	return transferFamily == graphicsFamily;
+}
+
+VkDeviceSize UploadContext::stage(const void *data, VkDeviceSize size, VkBuffer &stagingBuffer)
+{
+	//too large for the ring, it gets a staging buffer of its own
+	if (size > UPLOAD_ARENA_SIZE / 2)
+	{
+		VkDeviceMemory stagingMemory;
+
+		vulkanApp->createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			stagingBuffer, stagingMemory, VK_SHARING_MODE_EXCLUSIVE);
+		vulkanApp->updateBuffer(const_cast<void*>(data), stagingMemory, size);
+
+		UploadBatch &batch = getBatch(getOpenTicket());
+		batch.dedicatedBuffers.push_back(stagingBuffer);
+		batch.dedicatedMemory.push_back(stagingMemory);
+
+		return 0;
+	}
+
+	VkDeviceSize offset;
+	VkDeviceSize required;
+
+	for (;;)
+	{
+		if (arenaUsed == 0)
+			arenaHead = 0;
+
+		offset = (arenaHead + UPLOAD_ALIGNMENT - 1) / UPLOAD_ALIGNMENT * UPLOAD_ALIGNMENT;
+
+		//wraps around, the end of the ring is skipped
+		if (offset + size > UPLOAD_ARENA_SIZE)
+			offset = 0;
+
+		required = (offset >= arenaHead ? offset - arenaHead : UPLOAD_ARENA_SIZE - arenaHead) + size;
+
+		if (arenaUsed + required <= UPLOAD_ARENA_SIZE)
+			break;
+
+		//the ring is full, submit what was recorded and reuse the space of the oldest batch
+		if (completedTicket == submittedTicket)
+			flush();
+
+		wait(completedTicket + 1);
+	}
+
+	memcpy(arenaData + offset, data, static_cast<size_t>(size));
+
+	arenaHead = offset + size;
+	arenaUsed += required;
+	getBatch(getOpenTicket()).arenaBytes += required;
+
+	stagingBuffer = arenaBuffer;
+
+	return offset;
+}
+
+uint64_t UploadContext::uploadImage(const void *data, VkDeviceSize size, VkImage image, std::vector<VkBufferImageCopy> regions, VkImageSubresourceRange subresourceRange)
+{
+	VkBuffer stagingBuffer;
+	VkDeviceSize offset = stage(data, size, stagingBuffer);
+
+	for (size_t i = 0; i < regions.size(); i++)
+	{
+		regions[i].bufferOffset += offset;
+	}
+
+	VkCommandBuffer transferCmd = getTransferCommandBuffer();
+
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = subresourceRange;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	vkCmdCopyBufferToImage(transferCmd, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+	VkPipelineStageFlags readStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	if (isSameQueue())
+	{
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, readStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+	else
+	{
+		//release, the acquire repeats the same layouts and families
+		barrier.srcQueueFamilyIndex = static_cast<uint32_t>(transferFamily);
+		barrier.dstQueueFamilyIndex = static_cast<uint32_t>(graphicsFamily);
+		barrier.dstAccessMask = 0;
+
+		vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		//acquire, ordered after the transfer semaphore wait
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(getGraphicsCommandBuffer(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, readStages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	return getOpenTicket();
+}
+
+uint64_t UploadContext::uploadBuffer(const void *data, VkDeviceSize size, VkBuffer dstBuffer, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+	VkBuffer stagingBuffer;
+	VkDeviceSize offset = stage(data, size, stagingBuffer);
+
+	VkCommandBuffer transferCmd = getTransferCommandBuffer();
+
+	VkBufferCopy copyRegion = {};
+	copyRegion.srcOffset = offset;
+	copyRegion.dstOffset = 0;
+	copyRegion.size = size;
+
+	vkCmdCopyBuffer(transferCmd, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = dstBuffer;
+	barrier.offset = 0;
+	barrier.size = size;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+	if (isSameQueue())
+	{
+		barrier.dstAccessMask = dstAccess;
+
+		vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+	}
+	else
+	{
+		barrier.srcQueueFamilyIndex = static_cast<uint32_t>(transferFamily);
+		barrier.dstQueueFamilyIndex = static_cast<uint32_t>(graphicsFamily);
+		barrier.dstAccessMask = 0;
+
+		vkCmdPipelineBarrier(transferCmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = dstAccess;
+
+		vkCmdPipelineBarrier(getGraphicsCommandBuffer(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+	}
+
+	return getOpenTicket();
+}
+
+uint64_t UploadContext::flush()
+{
+	UploadBatch &batch = getBatch(getOpenTicket());
+
+	if (!batch.bTransferRecording && !batch.bGraphicsRecording)
+	{
+		//nothing recorded, a good time to hand back the staging space of finished batches
+		isComplete(submittedTicket);
+		return submittedTicket;
+	}
+
+	if (batch.bTransferRecording)
+		vkEndCommandBuffer(batch.transferCmd);
+
+	if (batch.bGraphicsRecording)
+		vkEndCommandBuffer(batch.graphicsCmd);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+	if (batch.bTransferRecording && batch.bGraphicsRecording && !isSameQueue())
+	{
+		//the graphics half acquires what the transfer half released
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.transferCmd;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &batch.transferSemaphore;
+
+		if (vkQueueSubmit(vulkanApp->getTransferQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit upload command buffer!");
+		}
+
+		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &batch.transferSemaphore;
+		submitInfo.pWaitDstStageMask = &waitStage;
+		submitInfo.pCommandBuffers = &batch.graphicsCmd;
+		submitInfo.signalSemaphoreCount = 0;
+		submitInfo.pSignalSemaphores = NULL;
+
+		if (vkQueueSubmit(vulkanApp->getGraphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit upload command buffer!");
+		}
+	}
+	else
+	{
+		//one queue, the barriers order the two halves
+		std::vector<VkCommandBuffer> cmds;
+
+		if (batch.bTransferRecording)
+			cmds.push_back(batch.transferCmd);
+
+		if (batch.bGraphicsRecording)
+			cmds.push_back(batch.graphicsCmd);
+
+		submitInfo.commandBufferCount = static_cast<uint32_t>(cmds.size());
+		submitInfo.pCommandBuffers = cmds.data();
+
+		//frame work on the graphics queue is ordered after it
+		VkQueue queue = (isSameQueue() || batch.bGraphicsRecording) ? vulkanApp->getGraphicsQueue() : vulkanApp->getTransferQueue();
+
+		if (vkQueueSubmit(queue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to submit upload command buffer!");
+		}
+	}
+
+	batch.bTransferRecording = false;
+	batch.bGraphicsRecording = false;
+	batch.bInFlight = true;
+
+	submittedTicket++;
+
+	//the next batch reuses a slot, its previous submit has to be done
+	if (getBatch(getOpenTicket()).bInFlight)
+		wait(getOpenTicket() - UPLOAD_BATCH_COUNT);
+
+	return submittedTicket;
+}
+
+bool UploadContext::isComplete(uint64_t ticket)
+{
+	if (ticket > submittedTicket)
+		return false;
+
+	while (completedTicket < ticket)
+	{
+		if (vkGetFenceStatus(vulkanApp->getDevice(), getBatch(completedTicket + 1).fence) != VK_SUCCESS)
+			return false;
+
+		retire(completedTicket + 1);
+	}
+
+	return true;
+}
+
+void UploadContext::wait(uint64_t ticket)
+{
+	if (ticket > submittedTicket)
+		flush();
+
+	ticket = std::min(ticket, submittedTicket);
+
+	while (completedTicket < ticket)
+	{
+		UploadBatch &batch = getBatch(completedTicket + 1);
+
+		vkWaitForFences(vulkanApp->getDevice(), 1, &batch.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+
+		retire(completedTicket + 1);
+	}
+}
+
+void UploadContext::waitIdle()
+{
+	flush();
+	wait(submittedTicket);
+}
+
+void UploadContext::retire(uint64_t ticket)
+{
+	UploadBatch &batch = getBatch(ticket);
+
+	vkResetFences(vulkanApp->getDevice(), 1, &batch.fence);
+
+	for (size_t i = 0; i < batch.dedicatedBuffers.size(); i++)
+	{
+		vkDestroyBuffer(vulkanApp->getDevice(), batch.dedicatedBuffers[i], nullptr);
+		vkFreeMemory(vulkanApp->getDevice(), batch.dedicatedMemory[i], nullptr);
+	}
+
+	batch.dedicatedBuffers.clear();
+	batch.dedicatedMemory.clear();
+
+	arenaUsed -= batch.arenaBytes;
+	batch.arenaBytes = 0;
+
+	batch.bInFlight = false;
+	completedTicket = ticket;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Common.h"
+
+class Vulkan;
+
+//everything that goes from the CPU to device local memory is staged in one persistently mapped ring buffer,
+//recorded into the open batch and submitted with the batch, instead of one blocking submit per copy
+class UploadContext
+{
+public:
+
+	UploadContext();
+
+	void initialize(Vulkan *pVulkanApp);
+	void shutDown();
+
+	//command buffers of the open batch, begun on first use
+	//the transfer one runs on the transfer family, the graphics one waits for it on the graphics queue
+	VkCommandBuffer getTransferCommandBuffer();
+	VkCommandBuffer getGraphicsCommandBuffer();
+
+	//the image has to be created VK_SHARING_MODE_EXCLUSIVE, it ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL on the graphics family
+	//regions are relative to data, returns the ticket of the batch the upload was recorded in
+	uint64_t uploadImage(const void *data, VkDeviceSize size, VkImage image, std::vector<VkBufferImageCopy> regions, VkImageSubresourceRange subresourceRange);
+
+	//the buffer has to be created VK_SHARING_MODE_EXCLUSIVE with VK_BUFFER_USAGE_TRANSFER_DST_BIT
+	uint64_t uploadBuffer(const void *data, VkDeviceSize size, VkBuffer dstBuffer, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+
+	//submits the open batch without waiting for it, returns its ticket
+	uint64_t flush();
+
+	bool isComplete(uint64_t ticket);
+	void wait(uint64_t ticket);
+
+	//flushes and waits for every batch in flight
+	void waitIdle();
+
+	uint64_t getOpenTicket()
+	{
+		return submittedTicket + 1;
+	}
+
+private:
+
+	struct UploadBatch
+	{
+		VkCommandBuffer transferCmd;
+		VkCommandBuffer graphicsCmd;
+
+		bool bTransferRecording;
+		bool bGraphicsRecording;
+		bool bInFlight;
+
+		VkSemaphore transferSemaphore;
+		VkFence fence;
+
+		VkDeviceSize arenaBytes; //ring space of this batch, including the padding skipped at the wrap
+
+		//uploads larger than half of the ring get their own staging buffer, destroyed with the batch
+		std::vector<VkBuffer> dedicatedBuffers;
+		std::vector<VkDeviceMemory> dedicatedMemory;
+	};
+
+	VkDeviceSize stage(const void *data, VkDeviceSize size, VkBuffer &stagingBuffer);
+
+	UploadBatch& getBatch(uint64_t ticket)
+	{
+		return batches[(ticket - 1) % UPLOAD_BATCH_COUNT];
+	}
+
+	void retire(uint64_t ticket);
+
+	bool isSameQueue();
+
+	Vulkan *vulkanApp;
+
+	int transferFamily;
+	int graphicsFamily;
+
+	VkBuffer arenaBuffer;
+	VkDeviceMemory arenaMemory;
+	char *arenaData;
+
+	VkDeviceSize arenaHead;
+	VkDeviceSize arenaUsed;
+
+	std::vector<UploadBatch> batches;
+
+	uint64_t submittedTicket;
+	uint64_t completedTicket;
+};
\ No newline at end of file
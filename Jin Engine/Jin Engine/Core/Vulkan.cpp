@@ -2,7 +2,7 @@
 
 #include "../Asset/AssetDB.h"
 
-Vulkan::Vulkan()
+Vulkan::Vulkan() : surface(VK_NULL_HANDLE), bHeadless(false)
 {
 	
 }
@@ -14,28 +14,50 @@ Vulkan::~Vulkan()
 
 void Vulkan::initialize(Interface &interface)
 {	
-	deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	bHeadless = interface.bHeadless;
+
+	if (!bHeadless)
+		deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
 	createInstance(interface.getEngineName(), 1, 0, 0);
 	setupDebugCallback();
-	createSurface(interface);
+
+	if (!bHeadless)
+		createSurface(interface);
 
 	pickPhysicalDevice();
 	createLogicalDevice();
 
-	createCommandPool(transferCmdPool);
-
 	QueueFamilyIndices indices = findQueueFamilies(physicalDevice, surface);
+
+	createCommandPool(graphicsCmdPool, indices.graphicsFamily);
+	createCommandPool(transferCmdPool, indices.transferFamily);
+
+	vkGetDeviceQueue(device, indices.graphicsFamily, 0, &graphicsQueue);
 	vkGetDeviceQueue(device, indices.transferFamily, 0, &transferQueue);	
+
+	concurrentQueueFamilies.push_back(static_cast<uint32_t>(indices.graphicsFamily));
+
+	if (indices.computeFamily != indices.graphicsFamily)
+		concurrentQueueFamilies.push_back(static_cast<uint32_t>(indices.computeFamily));
+
+	uploadContext.initialize(this);
+	gpuTimer.initialize(this);
 }
 
 void Vulkan::shutDown()
 {
+	gpuTimer.shutDown();
+	uploadContext.shutDown();
 
+	vkDestroyCommandPool(device, graphicsCmdPool, nullptr);
 	vkDestroyCommandPool(device, transferCmdPool, nullptr);	
 	vkDestroyDevice(device, nullptr);
 	DestroyDebugReportCallbackEXT(instance, callback, nullptr);
-	vkDestroySurfaceKHR(instance, surface, nullptr);
+
+	if (surface != VK_NULL_HANDLE)
+		vkDestroySurfaceKHR(instance, surface, nullptr);
+
 	vkDestroyInstance(instance, nullptr);
 }
 
@@ -78,8 +100,11 @@ std::vector<const char*> Vulkan::getRequiredExtensions()
 	std::vector<const char*> extensions;
 
 	unsigned int glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	const char** glfwExtensions = NULL;
+
+	//GLFW is not initialized without a window
+	if (!bHeadless)
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
 
 	for (unsigned int i = 0; i < glfwExtensionCount; i++) {
 		extensions.push_back(glfwExtensions[i]);
@@ -269,7 +294,7 @@ bool Vulkan::isDeviceSuitable(VkPhysicalDevice physicalDevice)
 	bool extensionsSupported = checkDeviceExtensionSupport(physicalDevice);
 
 	bool swapChainAdequate = false;
-	if (extensionsSupported)
+	if (extensionsSupported && surface != VK_NULL_HANDLE)
 	{
 		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
 		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -278,7 +303,7 @@ bool Vulkan::isDeviceSuitable(VkPhysicalDevice physicalDevice)
 	VkPhysicalDeviceFeatures supportedFeatures;
 	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
 
-	return indices.isComplete() && extensionsSupported && supportedFeatures.samplerAnisotropy;
+	return indices.isComplete() && extensionsSupported && supportedFeatures.samplerAnisotropy && supportedFeatures.textureCompressionBC;
 }
 
 bool Vulkan::checkDeviceExtensionSupport(VkPhysicalDevice device)
@@ -321,6 +346,7 @@ void Vulkan::createLogicalDevice()
 	VkPhysicalDeviceFeatures deviceFeatures = {};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
 	deviceFeatures.geometryShader = VK_TRUE;
+	deviceFeatures.textureCompressionBC = VK_TRUE;
 
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -360,30 +386,59 @@ QueueFamilyIndices Vulkan::findQueueFamilies(VkPhysicalDevice device, VkSurfaceK
 	int i = 0;
 	for (const auto& queueFamily : queueFamilies)
 	{
-
-		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+		if (queueFamily.queueCount == 0)
 		{
-			indices.computeFamily = i;
-			indices.graphicsFamily = i;
-			indices.presentFamily = i;
-			indices.transferFamily = i;
+			i++;
+			continue;
 		}
 
+		bool bGraphics = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+		bool bCompute = (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+		bool bTransfer = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
+
 		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
-		if (queueFamily.queueCount > 0 && presentSupport)
+		if (surface != VK_NULL_HANDLE)
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+
+		//graphics, moved to a family that can also present if the first one cannot
+		if (bGraphics && (indices.graphicsFamily < 0 || (presentSupport && indices.presentFamily != indices.graphicsFamily)))
+		{
+			indices.graphicsFamily = i;
+		}
+
+		if (presentSupport && (indices.presentFamily < 0 || indices.graphicsFamily == i))
 		{
 			indices.presentFamily = i;
 		}
 
-		if (indices.isComplete()) {
-			break;
+		//async compute, a compute family without graphics
+		if (bCompute && !bGraphics && indices.computeFamily < 0)
+		{
+			indices.computeFamily = i;
+		}
+
+		//uploads, a transfer only family (copy engine) first, then any family without graphics
+		if (bTransfer && !bGraphics)
+		{
+			if (indices.transferFamily < 0 || (!bCompute && (queueFamilies[indices.transferFamily].queueFlags & VK_QUEUE_COMPUTE_BIT)))
+				indices.transferFamily = i;
 		}
 
 		i++;
 	}
 
+	//devices with a single family run everything on the graphics queue
+	if (indices.computeFamily < 0)
+		indices.computeFamily = indices.graphicsFamily;
+
+	if (indices.transferFamily < 0)
+		indices.transferFamily = indices.graphicsFamily;
+
+	//headless, nothing is presented
+	if (surface == VK_NULL_HANDLE)
+		indices.presentFamily = indices.graphicsFamily;
+
 	return indices;
 }
 
@@ -391,9 +446,14 @@ void Vulkan::createCommandPool(VkCommandPool &cmdPool)
 {
 	QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice, surface);
 
+	createCommandPool(cmdPool, queueFamilyIndices.graphicsFamily);
+}
+
+void Vulkan::createCommandPool(VkCommandPool &cmdPool, int queueFamilyIndex)
+{
 	VkCommandPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
+	poolInfo.queueFamilyIndex = static_cast<uint32_t>(queueFamilyIndex);
 	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; // Optional
 
 	if (vkCreateCommandPool(device, &poolInfo, nullptr, &cmdPool) != VK_SUCCESS)
@@ -404,13 +464,14 @@ void Vulkan::createCommandPool(VkCommandPool &cmdPool)
 
 
 void Vulkan::createImageView(VkImage image, VkImageViewType type, VkFormat format, VkImageAspectFlags aspectFlags,
-	uint32_t baseMipLevel, uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount, VkImageView &imageView)
+	uint32_t baseMipLevel, uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount, VkImageView &imageView, VkComponentMapping components)
 {
 	VkImageViewCreateInfo viewInfo = {};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = image;
 	viewInfo.viewType = type;
 	viewInfo.format = format;
+	viewInfo.components = components;
 	viewInfo.subresourceRange.aspectMask = aspectFlags;
 	viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
 	viewInfo.subresourceRange.levelCount = levelCount;
@@ -504,7 +565,7 @@ void Vulkan::recordCommandBuffers(std::vector<VkCommandBuffer> *cmdBuffers,
 	VkRenderPass renderPass, VkExtent2D extent, std::vector<VkClearValue> *clearValues,
 	int drawMode,	
 	VkBuffer vertexBuffer, uint32_t vertexOffset, uint32_t vertexCount,
-	uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+	uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, std::string timerName)
 {
 	AssetDatabase* DBInstance = AssetDatabase::GetInstance();
 
@@ -519,6 +580,10 @@ void Vulkan::recordCommandBuffers(std::vector<VkCommandBuffer> *cmdBuffers,
 
 		vkBeginCommandBuffer(thisCmd, &beginInfo);
 
+		//passes submitted more than once a frame, like the per object frustum culling, are left untimed
+		if (!timerName.empty())
+			gpuTimer.beginPass(thisCmd, timerName);
+
 		if (renderPass)
 		{
 			VkRenderPassBeginInfo renderPassInfo = {};
@@ -534,19 +599,7 @@ void Vulkan::recordCommandBuffers(std::vector<VkCommandBuffer> *cmdBuffers,
 
 			vkCmdBeginRenderPass(thisCmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-			if (drawMode == 0)
-			{
-				Material *pMaterial = DBInstance->FindAsset<Material>(materialName);
-
-				vkCmdBindDescriptorSets(thisCmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pMaterial->getPipelineLayout(), 0, 1, pMaterial->getDescSetPointer(), 0, nullptr);
-				vkCmdBindPipeline(thisCmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pMaterial->getPipeline());
-
-				VkDeviceSize offsets[] = { vertexOffset };
-
-				vkCmdBindVertexBuffers(thisCmd, 0, 1, &vertexBuffer, offsets);
-				vkCmdDraw(thisCmd, vertexCount, 1, 0, 0);
-			}
-			else if (drawMode == 1)
+			if (drawMode == 1)
 			{
 				for (size_t j = 0; j < DBInstance->objectManager.size(); j++)
 				{
@@ -646,6 +699,56 @@ void Vulkan::recordCommandBuffers(std::vector<VkCommandBuffer> *cmdBuffers,
 			pMaterial->updateCPUsideWork();
 		}
 
+		if (!timerName.empty())
+			gpuTimer.endPass(thisCmd, timerName);
+
+		if (vkEndCommandBuffer(thisCmd) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to record command buffer!");
+		}
+	}
+}
+
+void Vulkan::recordFullscreenCommandBuffers(std::vector<VkCommandBuffer> *cmdBuffers, std::vector<VkFramebuffer> *Framebuffers, std::string materialName,
+	VkRenderPass renderPass, VkExtent2D extent, std::vector<VkClearValue> *clearValues, std::string timerName)
+{
+	Material *pMaterial = AssetDatabase::GetInstance()->FindAsset<Material>(materialName);
+
+	if (timerName.empty())
+		timerName = materialName;
+
+	for (size_t i = 0; i < (*cmdBuffers).size(); i++)
+	{
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+		beginInfo.pInheritanceInfo = nullptr; // Optional
+
+		VkCommandBuffer thisCmd = (*cmdBuffers)[i];
+
+		vkBeginCommandBuffer(thisCmd, &beginInfo);
+
+		gpuTimer.beginPass(thisCmd, timerName);
+
+		VkRenderPassBeginInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = renderPass;
+		renderPassInfo.framebuffer = (*Framebuffers)[i];
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = extent;
+		renderPassInfo.clearValueCount = static_cast<uint32_t>((*clearValues).size());
+		renderPassInfo.pClearValues = (*clearValues).data();
+
+		vkCmdBeginRenderPass(thisCmd, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		vkCmdBindDescriptorSets(thisCmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pMaterial->getPipelineLayout(), 0, 1, pMaterial->getDescSetPointer(), 0, nullptr);
+		vkCmdBindPipeline(thisCmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pMaterial->getPipeline());
+		vkCmdDraw(thisCmd, pMaterial->drawVertexCount, pMaterial->drawInstanceCount, 0, 0);
+
+		vkCmdEndRenderPass(thisCmd);
+
+		gpuTimer.endPass(thisCmd, timerName);
+
 		if (vkEndCommandBuffer(thisCmd) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to record command buffer!");
@@ -691,7 +794,8 @@ uint32_t Vulkan::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags prope
 
 VkFormat Vulkan::findDepthFormat()
 {
-	return findSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT },
+	//reverse-Z needs float depth, a 24 bit unorm buffer would lose the precision it gains
+	return findSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT },
 		VK_IMAGE_TILING_OPTIMAL,
 		VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
 	);
@@ -703,44 +807,9 @@ bool Vulkan::hasStencilComponent(VkFormat format)
 }
 
 
-VkCommandBuffer Vulkan::beginSingleTimeCommands(VkCommandPool commandPool)
-{
-	VkCommandBufferAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandPool = commandPool;
-	allocInfo.commandBufferCount = 1;
-
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-	VkCommandBufferBeginInfo beginInfo = {};
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-	return commandBuffer;
-}
-
-void Vulkan::endSingleTimeCommands(VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkQueue queue)
+void Vulkan::bufferMemoryBarrier(VkBuffer buffer, VkDeviceSize size, VkAccessFlags src, VkAccessFlags dst)
 {
-	vkEndCommandBuffer(commandBuffer);
-
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-
-	vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(queue);
-
-	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
-}
-
-void Vulkan::bufferMemoryBarrier(VkBuffer buffer, VkDeviceSize size, VkAccessFlags src, VkAccessFlags dst, VkCommandPool commandPool, VkQueue queue)
-{
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands(commandPool);
+	VkCommandBuffer commandBuffer = uploadContext.getGraphicsCommandBuffer();
 
 	VkBufferMemoryBarrier barrier = {};
 	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -780,15 +849,12 @@ void Vulkan::bufferMemoryBarrier(VkBuffer buffer, VkDeviceSize size, VkAccessFla
 		1, &barrier,
 		0, nullptr
 	);
-
-	endSingleTimeCommands(commandPool, commandBuffer, queue);
-
 }
 
 
-void Vulkan::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkCommandPool commandPool, VkQueue queue)
+void Vulkan::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
 {
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands(commandPool);
+	VkCommandBuffer commandBuffer = uploadContext.getGraphicsCommandBuffer();
 
 	
 
@@ -922,13 +988,11 @@ void Vulkan::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 		0, nullptr,
 		1, &barrier
 	);
-
-	endSingleTimeCommands(commandPool, commandBuffer, queue);
 }
 
-void Vulkan::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkCommandPool commandPool, VkQueue queue, VkImageSubresourceRange subresourceRange)
+void Vulkan::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageSubresourceRange subresourceRange)
 {
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands(commandPool);
+	VkCommandBuffer commandBuffer = uploadContext.getGraphicsCommandBuffer();
 
 	VkImageMemoryBarrier barrier = {};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -1036,17 +1100,26 @@ void Vulkan::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout
 		0, nullptr,
 		1, &barrier
 	);
-
-	endSingleTimeCommands(commandPool, commandBuffer, queue);
 }
 
-void Vulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+void Vulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+	VkSharingMode sharingMode)
 {
 	VkBufferCreateInfo bufferInfo = {};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferInfo.size = size;
 	bufferInfo.usage = usage;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (sharingMode == VK_SHARING_MODE_CONCURRENT && concurrentQueueFamilies.size() > 1)
+	{
+		bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(concurrentQueueFamilies.size());
+		bufferInfo.pQueueFamilyIndices = concurrentQueueFamilies.data();
+	}
+	else
+	{
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
 
 	if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
 	{
@@ -1069,67 +1142,75 @@ void Vulkan::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryP
 	vkBindBufferMemory(device, buffer, bufferMemory, 0);
 }
 
-void Vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkCommandPool cmdPool, VkQueue queue)
+void Vulkan::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 {
-	VkCommandBufferAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandPool = cmdPool;
-	allocInfo.commandBufferCount = 1;
-
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
-
-	VkCommandBufferBeginInfo beginInfo = {};
-	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-	vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
 	VkBufferCopy copyRegion = {};
 	copyRegion.srcOffset = 0; // Optional
 	copyRegion.dstOffset = 0; // Optional
 	copyRegion.size = size;
-	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-	vkEndCommandBuffer(commandBuffer);
-
-	VkSubmitInfo submitInfo = {};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-
-	vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-	vkQueueWaitIdle(queue);
-
-	vkFreeCommandBuffers(device, cmdPool, 1, &commandBuffer);
+	vkCmdCopyBuffer(uploadContext.getGraphicsCommandBuffer(), srcBuffer, dstBuffer, 1, &copyRegion);
 }
 
-void Vulkan::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevel)
+void Vulkan::copyImageToBuffer(VkImage image, VkImageLayout layout, uint32_t width, uint32_t height, VkBuffer dstBuffer)
 {
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands(transferCmdPool);
+	VkCommandBuffer commandBuffer = uploadContext.getGraphicsCommandBuffer();
+
+	//whatever pass wrote the image last, readbacks are rare enough to wait for all of them
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = layout;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
 	VkBufferImageCopy region = {};
 	region.bufferOffset = 0;
 	region.bufferRowLength = 0;
 	region.bufferImageHeight = 0;
 	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = mipLevel;
+	region.imageSubresource.mipLevel = 0;
 	region.imageSubresource.baseArrayLayer = 0;
 	region.imageSubresource.layerCount = 1;
 	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = { width, height, depth };
+	region.imageExtent = { width, height, 1 };
 
-	vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstBuffer, 1, &region);
 
-	endSingleTimeCommands(transferCmdPool, commandBuffer, transferQueue);
-}
+	//the copy is made visible to the host before the batch fence is signaled
+	VkBufferMemoryBarrier bufferBarrier = {};
+	bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.buffer = dstBuffer;
+	bufferBarrier.offset = 0;
+	bufferBarrier.size = VK_WHOLE_SIZE;
 
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+	barrier.newLayout = layout;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
 
 VkDeviceSize Vulkan::createImage(VkImageType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevelParam, uint32_t arrayLayersParam,
 	VkFormat format, VkImageTiling tiling, VkImageLayout imageLayout, VkImageUsageFlags usage, VkSampleCountFlagBits sampleCount,
 	VkMemoryPropertyFlags properties,
-	VkImage& image, VkDeviceMemory& imageMemory)
+	VkImage& image, VkDeviceMemory& imageMemory, VkSharingMode sharingMode)
 {
 	VkImageCreateInfo imageInfo = {};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -1144,7 +1225,17 @@ VkDeviceSize Vulkan::createImage(VkImageType type, uint32_t width, uint32_t heig
 	imageInfo.initialLayout = imageLayout;
 	imageInfo.usage = usage;
 	imageInfo.samples = sampleCount;
-	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (sharingMode == VK_SHARING_MODE_CONCURRENT && concurrentQueueFamilies.size() > 1)
+	{
+		imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+		imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(concurrentQueueFamilies.size());
+		imageInfo.pQueueFamilyIndices = concurrentQueueFamilies.data();
+	}
+	else
+	{
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	}
 
 	if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
 	{
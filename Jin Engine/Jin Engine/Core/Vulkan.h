@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Interface.h"
+#include "UploadContext.h"
+#include "GpuTimer.h"
+#include "Profiler.h"
 
 struct QueueFamilyIndices
 {
@@ -98,6 +101,7 @@ public:
 		uint32_t width, uint32_t height, uint32_t layerCount, uint32_t numColorAttachment);
 
 	void createCommandPool(VkCommandPool &cmdPool);
+	void createCommandPool(VkCommandPool &cmdPool, int queueFamilyIndex);
 
 	void createCommandBuffers(VkCommandBufferLevel cmdLevel, std::vector<VkFramebuffer> &Framebuffers, std::vector<VkCommandBuffer> &cmdBuffers,
 		VkCommandPool &cmdPool);
@@ -108,16 +112,18 @@ public:
 		VkRenderPass renderPass, VkExtent2D extent, std::vector<VkClearValue> *clearValues,
 		int drawMode,
 		VkBuffer vertexBuffer, uint32_t vertexOffset, uint32_t vertexCount,
-		uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+		uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ, std::string timerName = "");
+
+	//binds the material and draws the fullscreen triangle generated in postProcess.vert, no vertex buffer
+	//the pass is timed under the material name unless a timer name is given
+	void recordFullscreenCommandBuffers(std::vector<VkCommandBuffer> *cmdBuffers, std::vector<VkFramebuffer> *Framebuffers, std::string materialName,
+		VkRenderPass renderPass, VkExtent2D extent, std::vector<VkClearValue> *clearValues, std::string timerName = "");
 
 	VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 	VkFormat findDepthFormat();
 	bool hasStencilComponent(VkFormat format);
 
-	VkCommandBuffer beginSingleTimeCommands(VkCommandPool commandPool);
-	void endSingleTimeCommands(VkCommandPool commandPool, VkCommandBuffer commandBuffer, VkQueue queue);
-
 	void createBufferView(VkBuffer buffer, VkFormat format, VkDeviceSize offset, VkDeviceSize size, VkBufferView bufferView)
 	{
 		VkBufferViewCreateInfo view_info = {};
@@ -136,8 +142,16 @@ public:
 		bufferView = NULL;
 	}
 
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkCommandPool cmdPool, VkQueue queue);
+	//CONCURRENT resources are shared by the graphics and the async compute family, the transfer queue only touches EXCLUSIVE ones
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory,
+		VkSharingMode sharingMode = VK_SHARING_MODE_CONCURRENT);
+
+	//recorded into the open batch of the upload context, submitted with its next flush
+	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+
+	//the first level and layer of a color image, tightly packed, the image is left in the layout it was found in
+	//it needs VK_IMAGE_USAGE_TRANSFER_SRC_BIT, recorded into the open batch of the upload context like copyBuffer
+	void copyImageToBuffer(VkImage image, VkImageLayout layout, uint32_t width, uint32_t height, VkBuffer dstBuffer);
 
 	void updateBuffer(void* srcData, VkDeviceMemory deviceMemory, VkDeviceSize size)
 	{
@@ -147,27 +161,23 @@ public:
 		vkUnmapMemory(device, deviceMemory);
 	}
 
-	void bufferMemoryBarrier(VkBuffer buffer, VkDeviceSize size, VkAccessFlags src, VkAccessFlags dst, VkCommandPool commandPool, VkQueue queue);
-	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkCommandPool commandPool, VkQueue queue);
-	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkCommandPool commandPool, VkQueue queue, VkImageSubresourceRange subresourceRange);
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevel);
+	void bufferMemoryBarrier(VkBuffer buffer, VkDeviceSize size, VkAccessFlags src, VkAccessFlags dst);
+	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, VkImageSubresourceRange subresourceRange);
 
-	void blitImage(VkImage srcImage, VkImageLayout srcLayout, VkImage dstImage, VkImageLayout dstLayout, uint32_t regionCount, VkFilter filter, VkImageBlit imageBlit, VkCommandPool commandPool, VkQueue queue)
+	void blitImage(VkImage srcImage, VkImageLayout srcLayout, VkImage dstImage, VkImageLayout dstLayout, uint32_t regionCount, VkFilter filter, VkImageBlit imageBlit)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands(commandPool);
-		vkCmdBlitImage(commandBuffer, srcImage,	srcLayout, dstImage, dstLayout, regionCount, &imageBlit, filter);
-
-		endSingleTimeCommands(commandPool, commandBuffer, queue);
+		vkCmdBlitImage(uploadContext.getGraphicsCommandBuffer(), srcImage, srcLayout, dstImage, dstLayout, regionCount, &imageBlit, filter);
 	}
 
 	VkDeviceSize createImage(VkImageType type, uint32_t width, uint32_t height, uint32_t depth, uint32_t mipLevelParam, uint32_t arrayLayersParam,
 		VkFormat format, VkImageTiling tiling, VkImageLayout imageLayout, VkImageUsageFlags usage, VkSampleCountFlagBits sampleCount,
 		VkMemoryPropertyFlags properties,
-		VkImage& image, VkDeviceMemory& imageMemory);
+		VkImage& image, VkDeviceMemory& imageMemory, VkSharingMode sharingMode = VK_SHARING_MODE_CONCURRENT);
 
 
 	void createImageView(VkImage image, VkImageViewType type, VkFormat format, VkImageAspectFlags aspectFlags,
-		uint32_t baseMipLevel, uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount, VkImageView &imageView);
+		uint32_t baseMipLevel, uint32_t levelCount, uint32_t baseArrayLayer, uint32_t layerCount, VkImageView &imageView, VkComponentMapping components = {});
 
 
 	void createTextureSampler(VkFilter filter, VkSamplerAddressMode wrappingMode, VkBool32 anisotropy, float maxAnisotropy, VkBorderColor color, VkBool32 unnormalizedCoords,
@@ -201,6 +211,18 @@ public:
 	}
 	*/
 
+	//one time layout transitions and blits, they need a graphics capable queue
+	VkCommandPool getGraphicsCmdPool()
+	{
+		return graphicsCmdPool;
+	}
+
+	VkQueue getGraphicsQueue()
+	{
+		return graphicsQueue;
+	}
+
+	//copies only, on a dedicated transfer family when the device has one
 	VkCommandPool getTransferCmdPool()
 	{
 		return transferCmdPool;
@@ -211,6 +233,22 @@ public:
 		return transferQueue;
 	}
 
+	UploadContext* getUploadContext()
+	{
+		return &uploadContext;
+	}
+
+	GpuTimer* getGpuTimer()
+	{
+		return &gpuTimer;
+	}
+
+	//no surface and no swapchain extension, the renderer draws into offscreen images
+	bool isHeadless()
+	{
+		return bHeadless;
+	}
+
 private:
 
 	VkInstance instance;
@@ -221,12 +259,22 @@ private:
 
 	std::vector<const char*> deviceExtensions;
 
-	VkSurfaceKHR surface;
+	VkSurfaceKHR surface; //VK_NULL_HANDLE when headless
 	//VkSwapchainKHR swapChain;
 
+	bool bHeadless;
+
 	
 
+	VkCommandPool graphicsCmdPool;
+	VkQueue graphicsQueue;
+
 	VkCommandPool transferCmdPool;
 	VkQueue transferQueue;
+
+	UploadContext uploadContext;
+	GpuTimer gpuTimer;
+
+	std::vector<uint32_t> concurrentQueueFamilies; //graphics and async compute, when they are different families
 };
 
@@ -1,21 +1,23 @@
 #include "Postprocess.h"
 
-PostProcess::PostProcess(Vulkan* pVulkanApp, std::string materialNameParam, VkFormat frameBufferFormat, uint32_t layerCountParam, VkBuffer vertexBuffer, VkFilter filterParam, VkSamplerMipmapMode mipParam,
+PostProcess::PostProcess(Vulkan* pVulkanApp, std::string materialNameParam, VkFormat frameBufferFormat, uint32_t layerCountParam, VkFilter filterParam, VkSamplerMipmapMode mipParam,
 	bool bComputeParam, int numRenderTargetParam) : renderPass(NULL)
 {
 	vulkanApp = pVulkanApp;
 	materialName = materialNameParam;
 	format = frameBufferFormat;
 	layerCount = layerCountParam;
-	singleTriangularVertexBuffer = vertexBuffer;
 
 	filter = filterParam;
 	mipmapMode = mipParam;
 
 	bCompute = bComputeParam;
+	bAsyncCompute = false;
 
 	numRenderTarget = numRenderTargetParam;
 
+	dispatchSize = glm::uvec3(0);
+
 	createRenderTargets();
 	createSemaphores();
 	createQueues();
@@ -77,7 +79,13 @@ void PostProcess::initialize(glm::vec4 sizeScaleParam)
 
 	updateRenderTargets();
 
-	vulkanApp->createCommandPool(cmdPool);
+	if (bAsyncCompute)
+	{
+		QueueFamilyIndices indices = vulkanApp->findQueueFamilies(vulkanApp->getPhysicalDevice(), vulkanApp->getSurface());
+		vulkanApp->createCommandPool(cmdPool, indices.computeFamily);
+	}
+	else
+		vulkanApp->createCommandPool(cmdPool);
 
 	if (!bCompute)
 		createRenderpass();
@@ -92,7 +100,17 @@ void PostProcess::initialize(glm::vec4 sizeScaleParam)
 	if (!bCompute)
 	{
 		vulkanApp->createFramebuffers(collectedImageViews, NULL, framebuffers, renderPass, extent.width, extent.height, layerCount, 1);
-		vulkanApp->createCommandBuffers(VK_COMMAND_BUFFER_LEVEL_PRIMARY, framebuffers, cmds, cmdPool);
+
+		if (frameMaterialNames.empty())
+		{
+			vulkanApp->createCommandBuffers(VK_COMMAND_BUFFER_LEVEL_PRIMARY, framebuffers, cmds, cmdPool);
+		}
+		else
+		{
+			std::vector<VkFramebuffer> frameSlots;
+			frameSlots.resize(frameMaterialNames.size());
+			vulkanApp->createCommandBuffers(VK_COMMAND_BUFFER_LEVEL_PRIMARY, frameSlots, cmds, cmdPool);
+		}
 	}
 	else
 	{
@@ -104,7 +122,8 @@ void PostProcess::initialize(glm::vec4 sizeScaleParam)
 
 void PostProcess::createSemaphores()
 {
-	semaphores.resize(1);
+	//0 - the pass is done, 1 - fork of an async compute pass
+	semaphores.resize(2);
 
 	for (size_t i = 0; i < semaphores.size(); i++)
 	{
@@ -134,7 +153,7 @@ void PostProcess::createQueues()
 
 	for (size_t i = 0; i < queues.size(); i++)
 	{
-		vkGetDeviceQueue(vulkanApp->getDevice(), indices.graphicsFamily, 0, &queues[i]);
+		vkGetDeviceQueue(vulkanApp->getDevice(), bAsyncCompute ? indices.computeFamily : indices.graphicsFamily, 0, &queues[i]);
 	}
 }
 
@@ -144,14 +163,31 @@ void PostProcess::recordCommandBuffer()
 	std::vector<VkClearValue> clearValues;
 	clearValues.resize(2);
 	clearValues[0].color = { 0.0f, 0.0f, 0.0f, 0.0f };
-	clearValues[1].depthStencil = { 1.0f, 0 };
+	clearValues[1].depthStencil = { 0.0f, 0 };
 
-	if (bCompute)
+	if (bCompute && dispatchSize.x > 0)
 	{
-		vulkanApp->recordCommandBuffers(&cmds, cmdPool, NULL, materialName, NULL, extent, NULL, 1, NULL, 0, 0, (extent.width * extent.height) / 32 + 1, 1, 1);
+		vulkanApp->recordCommandBuffers(&cmds, cmdPool, NULL, materialName, NULL, extent, NULL, 1, NULL, 0, 0, dispatchSize.x, dispatchSize.y, dispatchSize.z, materialName);
+	}
+	else if (bCompute)
+	{
+		//compute post processes work on COMPUTE_TILE_SIZE x COMPUTE_TILE_SIZE screen tiles
+		vulkanApp->recordCommandBuffers(&cmds, cmdPool, NULL, materialName, NULL, extent, NULL, 1, NULL, 0, 0,
+			(extent.width + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE, (extent.height + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE, 1, materialName);
+	}
+	else if (!frameMaterialNames.empty())
+	{
+		//every frame material gets its own command buffer, all of them are timed as this pass
+		for (size_t i = 0; i < cmds.size(); i++)
+		{
+			std::vector<VkCommandBuffer> frameCmd(1, cmds[i]);
+			std::vector<VkFramebuffer> frameFramebuffer(1, framebuffers[glm::min(i, framebuffers.size() - 1)]);
+
+			vulkanApp->recordFullscreenCommandBuffers(&frameCmd, &frameFramebuffer, frameMaterialNames[i], renderPass, extent, &clearValues, materialName);
+		}
 	}
 	else
-		vulkanApp->recordCommandBuffers(&cmds, cmdPool, &framebuffers, materialName, renderPass, extent, &clearValues, 0, singleTriangularVertexBuffer, 0, 3, 0, 0, 0);
+		vulkanApp->recordFullscreenCommandBuffers(&cmds, &framebuffers, materialName, renderPass, extent, &clearValues);
 
 	
 }
@@ -179,7 +215,7 @@ void PostProcess::createRenderpass()
 	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	attachments[0].finalLayout = getTargetLayout();
 
 	std::vector<VkSubpassDependency> dependencies = {};
 	dependencies.resize(1);
@@ -206,18 +242,21 @@ void PostProcess::createRenderTargets()
 
 void PostProcess::updateRenderTargets()
 {
+	//headless, the golden image test copies the targets out
+	VkImageUsageFlags readbackUsage = vulkanApp->isHeadless() ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0;
+
 	for (uint32_t i = 0; i < renderTargets.size(); i++)
 	{
 		if (bCompute)
 		{
 			vulkanApp->createImage(VK_IMAGE_TYPE_2D, extent.width, extent.height, 1, 1, 1, format, VK_IMAGE_TILING_OPTIMAL,
-				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | readbackUsage, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 				renderTargets[i]->textureImage, renderTargets[i]->textureImageMemory);
 		}
 		else
 		{
 			vulkanApp->createImage(VK_IMAGE_TYPE_2D, extent.width, extent.height, 1, 1, 1, format, VK_IMAGE_TILING_OPTIMAL,
-				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | readbackUsage, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 				renderTargets[i]->textureImage, renderTargets[i]->textureImageMemory);			
 		}
 
@@ -227,9 +266,11 @@ void PostProcess::updateRenderTargets()
 		vulkanApp->createTextureSampler(filter, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FALSE, 1, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE,
 			mipmapMode, 0.0f, 0.0f, 0.0f, renderTargets[i]->textureSampler);
 
+		//compute targets are written as storage images and sampled in place by the passes behind them
 		if (bCompute)
 		{
-			vulkanApp->transitionImageLayout(renderTargets[i]->textureImage, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
+			vulkanApp->transitionImageLayout(renderTargets[i]->textureImage, format, VK_IMAGE_LAYOUT_UNDEFINED, getTargetLayout());
+			renderTargets[i]->sampledLayout = getTargetLayout();
 		}
 		
 	}
@@ -247,11 +288,26 @@ VkExtent2D PostProcess::getExtent()
 	return extent;
 }
 
+VkImageLayout PostProcess::getTargetLayout()
+{
+	//compute passes write their targets as storage images
+	if (bCompute)
+		return VK_IMAGE_LAYOUT_GENERAL;
+
+	//without a swapchain there is nothing to present, the next passes sample the targets
+	return vulkanApp->isHeadless() ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+}
+
 VkSemaphore* PostProcess::getFirstSM()
 {
 	return &semaphores[0];
 }
 
+VkSemaphore* PostProcess::getForkSM()
+{
+	return &semaphores[1];
+}
+
 VkQueue PostProcess::getFirstQueue()
 {
 	return queues[0];
@@ -8,7 +8,7 @@ class PostProcess
 {
 public:
 
-	PostProcess(Vulkan* pVulkanApp, std::string materialNameParam, VkFormat frameBufferFormat, uint32_t layerCountParam, VkBuffer vertexBuffer, VkFilter filterParam, VkSamplerMipmapMode mipParam,
+	PostProcess(Vulkan* pVulkanApp, std::string materialNameParam, VkFormat frameBufferFormat, uint32_t layerCountParam, VkFilter filterParam, VkSamplerMipmapMode mipParam,
 		bool bComputeParam, int numRenderTargetParam);
 
 	void shutDown();
@@ -26,6 +26,38 @@ public:
 
 	void recordCommandBuffer();
 
+	//compute post processes that do not cover the screen, like reductions, dispatch a fixed number of workgroups
+	void setDispatchSize(uint32_t x, uint32_t y, uint32_t z)
+	{
+		dispatchSize = glm::uvec3(x, y, z);
+	}
+
+	//compute post processes can run on the compute queue next to the graphics passes behind them, call before initialize
+	//an async pass starts after the pass in front of it and has to be joined by a later pass with waitForAsyncCompute
+	void setAsyncCompute()
+	{
+		bAsyncCompute = true;
+		createQueues();
+	}
+
+	void waitForAsyncCompute(PostProcess *pAsyncPostProcess)
+	{
+		asyncDependencies.push_back(pAsyncPostProcess);
+	}
+
+	//passes that alternate between per frame resources record one command buffer per material, call before initialize
+	//cmds[i] draws with the i-th material into renderTargets[i], or into the only target
+	void setFrameMaterials(std::vector<std::string> materialNames)
+	{
+		frameMaterialNames = materialNames;
+	}
+
+	//command buffer submitted on this frame
+	VkCommandBuffer *getFrameCmd(unsigned int frameIndex)
+	{
+		return &cmds[frameIndex % cmds.size()];
+	}
+
 	void createRenderpass();
 	
 	void createRenderTargets();
@@ -42,8 +74,19 @@ public:
 
 	VkExtent2D getExtent();
 
+	VkFormat getFormat()
+	{
+		return format;
+	}
+
+	//layout the targets are left in once the pass has run
+	VkImageLayout getTargetLayout();
+
 	VkSemaphore *getFirstSM();
 
+	//signaled by the pass in front of an async compute pass
+	VkSemaphore *getForkSM();
+
 	VkQueue getFirstQueue();
 
 	std::vector<VkCommandBuffer> cmds;
@@ -52,6 +95,9 @@ public:
 	glm::vec4 sizeScale;
 
 	bool bCompute;
+	bool bAsyncCompute;
+
+	std::vector<PostProcess*> asyncDependencies;
 private:
 	
 	Vulkan *vulkanApp;
@@ -61,8 +107,6 @@ private:
 	VkRenderPass renderPass;
 	VkCommandPool cmdPool;
 	
-	VkBuffer singleTriangularVertexBuffer;
-	
 	std::vector<VkFramebuffer> framebuffers;
 
 	std::vector<VkSemaphore> semaphores;
@@ -79,5 +123,8 @@ private:
 
 	int numRenderTarget;
 
+	glm::uvec3 dispatchSize; //0 - one workgroup per COMPUTE_TILE_SIZE screen tile
+
+	std::vector<std::string> frameMaterialNames;
 
 };
\ No newline at end of file
@@ -6,7 +6,7 @@
 #include "../Actor/Light.h"
 #include "../Core/Sky.h"
 
-#include "PostProcess.h"
+#include "Postprocess.h"
 
 static Time timer;
 
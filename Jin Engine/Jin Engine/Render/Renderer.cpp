@@ -1,9 +1,16 @@
 #include "Renderer.h"
 
 #include "../Asset/AssetDB.h"
+#include "../Asset/TextureCooker.h"
 
 void Renderer::createSwapChain()
 {
+	if (interface.bHeadless)
+	{
+		createOffscreenImages();
+		return;
+	}
+
 	SwapChainSupportDetails swapChainSupport = vulkanApp->querySwapChainSupport(vulkanApp->getPhysicalDevice());
 
 	VkSurfaceFormatKHR surfaceFormat = vulkanApp->chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -64,6 +71,36 @@ void Renderer::createSwapChain()
 	swapChainExtent = extent;
 }
 
+void Renderer::createOffscreenImages()
+{
+	//the format chooseSwapSurfaceFormat prefers, present_mat writes the same values as into a window
+	swapChainImageFormat = VK_FORMAT_B8G8R8A8_UNORM;
+	swapChainExtent = { static_cast<uint32_t>(interface.window_Width), static_cast<uint32_t>(interface.window_Height) };
+
+	//a frame has finished before the next one is recorded, one image is enough
+	swapChainImages.resize(1);
+	offscreenImageMemories.resize(1);
+
+	for (size_t i = 0; i < swapChainImages.size(); i++)
+	{
+		vulkanApp->createImage(VK_IMAGE_TYPE_2D, swapChainExtent.width, swapChainExtent.height, 1, 1, layerCount, swapChainImageFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			swapChainImages[i], offscreenImageMemories[i], VK_SHARING_MODE_EXCLUSIVE);
+	}
+}
+
+void Renderer::releaseOffscreenImages()
+{
+	for (size_t i = 0; i < swapChainImages.size(); i++)
+	{
+		vkDestroyImage(vulkanApp->getDevice(), swapChainImages[i], nullptr);
+		vkFreeMemory(vulkanApp->getDevice(), offscreenImageMemories[i], nullptr);
+	}
+
+	swapChainImages.clear();
+	offscreenImageMemories.clear();
+}
+
 void Renderer::assignRenderpassID(Material* pMat, VkRenderPass renderPass, uint32_t postProcessIndex)
 {
 	if (renderPass == gbufferRenderPass)
@@ -600,6 +637,10 @@ void Renderer::setGlobalLights()
 
 void Renderer::initialize(Vulkan* pVulkanApp)
 {
+	Profiler::GetInstance()->setThreadName("Main");
+
+	PROFILE_ZONE("Renderer::initialize");
+
 	interface.initWindow();
 
 	if (pVulkanApp == NULL)
@@ -618,10 +659,9 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 	createSwapChain();
 	createSwapChainImageViews();	
 
-	createSingleTriangularVertexBuffer();
-
 	createGbufferCommandPool();
 	createFrustumCullingCommandPool();
+	createLightCullingCommandPool();
 
 	//createGUICommandPool();
 
@@ -696,7 +736,7 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		{
 			DepthMipmapMaterial* depth_mipmap_Mat = new DepthMipmapMaterial;
 
-			PostProcess *Depth_mip_PP = new PostProcess(vulkanApp, "depth_mat_" + std::to_string(d), depthFormat, 1, singleTriangularVertexBuffer, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, false);
+			PostProcess *Depth_mip_PP = new PostProcess(vulkanApp, "depth_mat_" + std::to_string(d), depthFormat, 1, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, false);
 
 			//for ReleaseMode
 			glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width)/(uint32_t)glm::max(pow(2, d-1), 1.0), static_cast<float>(swapChainExtent.height)/ (uint32_t)glm::max(pow(2, d - 1), 1.0), 1.0f, 1.0f);
@@ -720,11 +760,26 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 
 	createPerFrameBuffer();
 
+	//LightCullingMaterial
+	{
+		LightCullingMaterial* lightCulling_Mat = new LightCullingMaterial;
+		lightCulling_Mat->createPipeline("lightCulling", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer, &pointLightUniformBuffer, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL, glm::vec2(0.0), glm::vec4(swapChainExtent.width, swapChainExtent.height, 1.0, 1.0),
+			NULL, NULL, depthTexture);
+
+		pLightCullingMaterial = lightCulling_Mat;
+
+		updateClusterInfoBuffer();
+	}
+
 	//PBR material
 	{
 		UberMaterial* temp_uber_Mat = new UberMaterial;
+
+		temp_uber_Mat->addBuffer(&(pLightCullingMaterial->clusterInfoBuffer));
+		temp_uber_Mat->addBuffer(&(pLightCullingMaterial->lightGridBuffer));
+		temp_uber_Mat->addBuffer(&(pLightCullingMaterial->lightIndexBuffer));
 		
-		PostProcess *PBR_PP = new PostProcess(vulkanApp, "uber_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		PostProcess *PBR_PP = new PostProcess(vulkanApp, "uber_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 
 		//for ReleaseMode
 		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
@@ -741,20 +796,123 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		postProcessChain.push_back(PBR_PP);
 	}
 
-	PlaneInfoPack planeInfoPack;
-	planeInfoPack.numPlanes = 1;
+	//Volumetric clouds, marched at 1 / CLOUD_DOWNSAMPLE resolution and accumulated over frames
+	if (interface.bRenderClouds)
+	{
+		//cloud noise volumes are baked from their slices once, then loaded in a single read
+		std::string lowFreqVolume = "Asset/Texture/cloudTextures/lowFreq.vol";
+		std::string highFreqVolume = "Asset/Texture/cloudTextures/highFreq.vol";
+
+		if (!TextureCooker::isCooked(lowFreqVolume, "Asset/Texture/cloudTextures/lowFreq/lowFreq_0.tga"))
+			TextureCooker::cookVolumeTexture("Asset/Texture/cloudTextures/lowFreq/lowFreq", ".tga", lowFreqVolume);
+
+		if (!TextureCooker::isCooked(highFreqVolume, "Asset/Texture/cloudTextures/highFreq/highFreq_0.tga"))
+			TextureCooker::cookVolumeTexture("Asset/Texture/cloudTextures/highFreq/highFreq", ".tga", highFreqVolume);
+
+		std::vector<unsigned char> lowFreqPixels;
+
+		skySystem.lowFreqTexture->connectDevice(pVulkanApp);
+		skySystem.lowFreqTexture->loadVolumeTexture(lowFreqVolume, &lowFreqPixels);
+		skySystem.createOccupancyBuffer(pVulkanApp, lowFreqPixels, skySystem.lowFreqTexture->getWidth());
+
+		skySystem.highFreqTexture->connectDevice(pVulkanApp);
+		skySystem.highFreqTexture->loadVolumeTexture(highFreqVolume);
+
+		AssetDatabase::GetInstance()->SaveTexture("Asset/Texture/cloudTextures/wheather.tga");
+
+		createCloudInfoBuffer();
+
+		//for ReleaseMode
+		glm::vec4 lowResSizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), static_cast<float>(CLOUD_DOWNSAMPLE), static_cast<float>(CLOUD_DOWNSAMPLE));
+		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
+
+		PostProcess *SKY_PP = new PostProcess(vulkanApp, "SkyRendering_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		PostProcess *CT_PP = new PostProcess(vulkanApp, "CloudTemporal_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		PostProcess *CH_PP = new PostProcess(vulkanApp, "CloudHistory_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		PostProcess *CU_PP = new PostProcess(vulkanApp, "CloudUpsample_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+
+		SKY_PP->initialize(lowResSizeScale);
+		CT_PP->initialize(lowResSizeScale);
+		CH_PP->initialize(lowResSizeScale);
+		CU_PP->initialize(sizeScale);
+
+		Texture* sceneTexture = postProcessChain[postProcessChain.size() - 1]->renderTargets[0];
+
+		//Ray march
+		{
+			SkyRenderingMaterial* temp_sky_Mat = new SkyRenderingMaterial;
+
+			temp_sky_Mat->addBuffer(&cloudInfoBuffer);
+			temp_sky_Mat->addBuffer(&(skySystem.occupancyBuffer));
+
+			std::vector<Texture*> tempRenderTargets;
+
+			tempRenderTargets.push_back(sceneTexture);
+			tempRenderTargets.push_back(skySystem.lowFreqTexture);
+			tempRenderTargets.push_back(skySystem.highFreqTexture);
+
+			temp_sky_Mat->createPipeline("SkyRendering_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), SKY_PP->sizeScale, SKY_PP->getRenderPass(), &tempRenderTargets, NULL);
+			assignRenderpassID(temp_sky_Mat, SKY_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+
+			SKY_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(SKY_PP);
+		}
+
+		//Temporal reprojection
+		{
+			CloudTemporalMaterial* temp_ct_Mat = new CloudTemporalMaterial;
+
+			std::vector<Texture*> tempRenderTargets;
+
+			tempRenderTargets.push_back(SKY_PP->renderTargets[0]); //current clouds
+			tempRenderTargets.push_back(CH_PP->renderTargets[0]); //history
+
+			temp_ct_Mat->createPipeline("CloudTemporal_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), CT_PP->sizeScale, CT_PP->getRenderPass(), &tempRenderTargets, NULL);
+			assignRenderpassID(temp_ct_Mat, CT_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+
+			CT_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(CT_PP);
+		}
+
+		//History for the next frame
+		{
+			PresentMaterial* temp_ch_Mat = new PresentMaterial;
+
+			temp_ch_Mat->createPipeline("CloudHistory_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+				glm::vec2(0.0), CH_PP->sizeScale, CH_PP->getRenderPass(), &CT_PP->renderTargets, NULL);
+			assignRenderpassID(temp_ch_Mat, CH_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+
+			CH_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(CH_PP);
+		}
+
+		//Upsample and compose with the scene
+		{
+			CloudUpsampleMaterial* temp_cu_Mat = new CloudUpsampleMaterial;
+
+			std::vector<Texture*> tempRenderTargets;
 
-	planeInfoPack.planeInfo[0].centerPoint = glm::vec4(0.0, 0.0, 0.0, 0.0);
-	planeInfoPack.planeInfo[0].size = glm::vec4(100.0);
+			tempRenderTargets.push_back(sceneTexture);
+			tempRenderTargets.push_back(CT_PP->renderTargets[0]); //resolved clouds
 
-	//planeInfoPack.planeInfo[0].centerPoint = glm::vec4(4.5, 0.0, -0.5, 0.0);
-	//planeInfoPack.planeInfo[0].size = glm::vec4(7.0, 1.5, 0.0, 0.0);
+			temp_cu_Mat->createPipeline("CloudUpsample_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), CU_PP->sizeScale, CU_PP->getRenderPass(), &tempRenderTargets, depthTexture);
+			assignRenderpassID(temp_cu_Mat, CU_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
 
-	planeInfoPack.planeInfo[1].centerPoint = glm::vec4(4.5, 0.3, 1.0, 0.0);
-	planeInfoPack.planeInfo[1].size = glm::vec4(7.0, 1.5, 0.0, 0.0);
+			CU_PP->recordCommandBuffer();
 
-	planeInfoPack.planeInfo[2].centerPoint = glm::vec4(4.5, 0.3, -2.0, 0.0);
-	planeInfoPack.planeInfo[2].size = glm::vec4(7.0, 1.5, 0.0, 0.0);
+			postProcessChain.push_back(CU_PP);
+		}
+	}
 
 	glm::mat4 basicMat;
 	basicMat[0] = glm::vec4(1.0, 0.0, 0.0, 0.0); //tan
@@ -762,30 +920,108 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 	basicMat[2] = glm::vec4(0.0, 0.0, 1.0, 0.0); //normal
 	basicMat[3] = glm::vec4(0.0, 0.0, 0.0, 1.0);
 
-	planeInfoPack.planeInfo[0].rotMat = glm::rotate(basicMat, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
+	reflectivePlanes.clear();
 
-	planeInfoPack.planeInfo[1].rotMat = glm::rotate(basicMat, glm::radians(-110.0f), glm::vec3(1.0, 0.0, 0.0));
+	addReflectivePlane(glm::vec4(0.0, 0.0, 0.0, 0.0), glm::vec4(100.0), glm::rotate(basicMat, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0)));
 
-	planeInfoPack.planeInfo[2].rotMat = glm::rotate(basicMat, glm::radians(-70.0f), glm::vec3(1.0, 0.0, 0.0));
+	//addReflectivePlane(glm::vec4(4.5, 0.0, -0.5, 0.0), glm::vec4(7.0, 1.5, 0.0, 0.0), glm::rotate(basicMat, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0)));
+	//addReflectivePlane(glm::vec4(4.5, 0.3, 1.0, 0.0), glm::vec4(7.0, 1.5, 0.0, 0.0), glm::rotate(basicMat, glm::radians(-110.0f), glm::vec3(1.0, 0.0, 0.0)));
+	//addReflectivePlane(glm::vec4(4.5, 0.3, -2.0, 0.0), glm::vec4(7.0, 1.5, 0.0, 0.0), glm::rotate(basicMat, glm::radians(-70.0f), glm::vec3(1.0, 0.0, 0.0)));
 
+	createPlaneInfoBuffer();
 	createSSRInfoBuffer();
 
+	Texture *SSRSceneTexture = postProcessChain[postProcessChain.size() - 1]->renderTargets[0];
+
+	//SSRP only reads the scene and the depth, so it is projected on the compute queue while PlaneID renders
+	PostProcess *SSRP_PP = NULL;
+
+	if (!interface.bUseBruteForce)
+	{
+		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0, 1.0);
+
+		ScreenSpaceProjectionMaterial* SSRP_Mat = new ScreenSpaceProjectionMaterial;
+		//ScreenSpaceProjectionMaterial2* SSRP_Mat = new ScreenSpaceProjectionMaterial2;
+
+		SSRP_PP = new PostProcess(vulkanApp, "ssrp_mat", VK_FORMAT_R32_UINT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 1);
+		//PostProcess *SSRP_PP = new PostProcess(vulkanApp, "ssrp_mat", VK_FORMAT_R8G8B8A8_UNORM, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+
+		SSRP_PP->setAsyncCompute();
+		SSRP_PP->initialize(sizeScale);
+		
+		std::vector<Texture*> tempSSRPRenderTargets;
+		tempSSRPRenderTargets.push_back(SSRSceneTexture); //Scene image
+		tempSSRPRenderTargets.push_back(SSRP_PP->renderTargets[0]); //Scene image
+
+		SSRP_Mat->addBuffer(&planeInfoBuffer);
+		
+		SSRP_Mat->createPipeline("ssrp_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer, NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+			glm::vec2(0.0), sizeScale,
+			NULL, &tempSSRPRenderTargets, depthTexture);
+
+		SSRP_PP->recordCommandBuffer();
+
+		postProcessChain.push_back(SSRP_PP);
+	}
+
+	//PlaneID, lets the reflection passes evaluate only the plane under each pixel
+	PostProcess *PlaneID_PP = new PostProcess(vulkanApp, "planeID_mat", VK_FORMAT_R32_UINT, 1, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, false, 1);
+	{
+		PlaneIDMaterial* planeID_Mat = new PlaneIDMaterial;
+
+		PlaneID_PP->initialize(glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0, 1.0));
+
+		planeID_Mat->addBuffer(&planeInfoBuffer);
+
+		planeID_Mat->createPipeline("planeID_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+			NULL, 0, NULL, 0, NULL,
+			glm::vec2(0.0), PlaneID_PP->sizeScale, PlaneID_PP->getRenderPass(), NULL, depthTexture);
+		assignRenderpassID(planeID_Mat, PlaneID_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+
+		PlaneID_PP->recordCommandBuffer();
+
+		postProcessChain.push_back(PlaneID_PP);
+	}
+
 	if (interface.bUseBruteForce)
 	{
 		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0, 1.0);
 
+		//Hi-Z pyramid, each level keeps the nearest depth of a 2x2 footprint of the level below
+		std::vector<Texture*> hiZTextures;
+
+		for (int d = 1; d < DEPTH_MIP_SIZE; d++)
+		{
+			DepthMipmapMaterial* depth_mipmap_Mat = new DepthMipmapMaterial;
+
+			PostProcess *Depth_mip_PP = new PostProcess(vulkanApp, "depth_mat_" + std::to_string(d), VK_FORMAT_R32_SFLOAT, 1, VK_FILTER_NEAREST, VK_SAMPLER_MIPMAP_MODE_NEAREST, false, 1);
+
+			float levelScale = static_cast<float>(1 << d);
+			Depth_mip_PP->initialize(glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), levelScale, levelScale));
+
+			depth_mipmap_Mat->createPipeline("depth_mat_" + std::to_string(d), "", "", "", "", NULL, NULL,
+				NULL, 0, NULL, 0, NULL,
+				glm::vec2(0.0), Depth_mip_PP->sizeScale, Depth_mip_PP->getRenderPass(), NULL, d == 1 ? depthTexture : hiZTextures.back());
+			assignRenderpassID(depth_mipmap_Mat, Depth_mip_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+
+			Depth_mip_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(Depth_mip_PP);
+			hiZTextures.push_back(Depth_mip_PP->renderTargets[0]);
+		}
+
 		BruteForceMaterial * BR_Mat = new BruteForceMaterial;
 
-		PostProcess *BR_PP = new PostProcess(vulkanApp, "BR_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		PostProcess *BR_PP = new PostProcess(vulkanApp, "BR_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 
 		BR_PP->initialize(sizeScale);
 
-		//BR_Mat->addBuffer(&(BR_PP->planeInfoBuffer));
 		BR_Mat->addBuffer(&SSRInfoBuffer);
+		BR_Mat->addBuffer(&planeInfoBuffer);
 
 		std::vector<Texture*> tempRenderTargets;
 
-		tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]);  //Scene
+		tempRenderTargets.push_back(SSRSceneTexture);  //Scene
 		//tempRenderTargets.push_back( gbuffers[NORMAL_COLOR]);  //world Normal
 
 		tempRenderTargets.push_back(AssetDatabase::GetInstance()->LoadAsset<Texture>("Asset/Texture/sponza/floor/floor_albedo.png"));
@@ -793,13 +1029,14 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		tempRenderTargets.push_back(AssetDatabase::GetInstance()->LoadAsset<Texture>("Asset/Texture/sponza/floor/floor_norm.png"));
 
 
+		BR_Mat->setHiZTextures(hiZTextures);
+		BR_Mat->setPlaneIDTexture(PlaneID_PP->renderTargets[0]);
+
 		BR_Mat->createPipeline("BR_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
 			&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), NULL,
 			glm::vec2(0.0), BR_PP->sizeScale, BR_PP->getRenderPass(), &tempRenderTargets, depthTexture);
 		assignRenderpassID(BR_Mat, BR_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
 
-		BR_Mat->updatePlaneInfoPackBuffer(planeInfoPack);
-
 		BR_PP->recordCommandBuffer();
 
 		postProcessChain.push_back(BR_PP);
@@ -810,33 +1047,6 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		//for ReleaseMode
 		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0, 1.0);
 
-		//SSRP
-		ScreenSpaceProjectionMaterial* SSRP_Mat = new ScreenSpaceProjectionMaterial;
-		//ScreenSpaceProjectionMaterial2* SSRP_Mat = new ScreenSpaceProjectionMaterial2;
-
-		PostProcess *SSRP_PP = new PostProcess(vulkanApp, "ssrp_mat", VK_FORMAT_R32_UINT, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 1);
-		//PostProcess *SSRP_PP = new PostProcess(vulkanApp, "ssrp_mat", VK_FORMAT_R8G8B8A8_UNORM, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
-
-		SSRP_PP->initialize(sizeScale);
-		
-		std::vector<Texture*> tempSSRPRenderTargets;
-		tempSSRPRenderTargets.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]); //Scene image
-		tempSSRPRenderTargets.push_back(SSRP_PP->renderTargets[0]); //Scene image
-
-		
-		SSRP_Mat->createPipeline("ssrp_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer, NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
-			glm::vec2(0.0), sizeScale,
-			NULL, &tempSSRPRenderTargets, depthTexture);
-
-		
-
-		SSRP_Mat->updatePlaneInfoPackBuffer(planeInfoPack);
-
-		SSRP_PP->recordCommandBuffer();
-
-		postProcessChain.push_back(SSRP_PP);
-
-
 		//SSR
 		
 
@@ -845,18 +1055,21 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 
 		ScreenSpaceReflectionMaterial* temp_ssr_Mat = new ScreenSpaceReflectionMaterial;
 
-		PostProcess *SSR_PP = new PostProcess(vulkanApp, "ssr_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		PostProcess *SSR_PP = new PostProcess(vulkanApp, "ssr_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 
 
 
-		SSR_PP->initialize(sizeScale);
+		//reflections are traced and patched at 1 / SSRDownsample resolution, the hash above stays at full resolution
+		glm::vec4 reflectionSizeScale = glm::vec4(sizeScale.x, sizeScale.y, static_cast<float>(interface.SSRDownsample), static_cast<float>(interface.SSRDownsample));
 
-		temp_ssr_Mat->addBuffer(&(SSRP_Mat->planeInfoBuffer));
+		SSR_PP->initialize(reflectionSizeScale);
+
+		temp_ssr_Mat->addBuffer(&planeInfoBuffer);
 		temp_ssr_Mat->addBuffer(&SSRInfoBuffer);
 
 		std::vector<Texture*> tempRenderTargets;
 
-		tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 2]->renderTargets[0]);  //Scene
+		tempRenderTargets.push_back(SSRSceneTexture);  //Scene
 		tempRenderTargets.push_back(SSRP_PP->renderTargets[0]);  //Scene
 
 		tempRenderTargets.push_back(AssetDatabase::GetInstance()->LoadAsset<Texture>("Asset/Texture/sponza/floor/floor_albedo.png"));
@@ -864,12 +1077,15 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		tempRenderTargets.push_back(AssetDatabase::GetInstance()->LoadAsset<Texture>("Asset/Texture/sponza/floor/floor_norm.png"));
 		tempRenderTargets.push_back(AssetDatabase::GetInstance()->LoadAsset<Texture>(noiseTex));
 
+		temp_ssr_Mat->setPlaneIDTexture(PlaneID_PP->renderTargets[0]);
 
 		temp_ssr_Mat->createPipeline("ssr_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
 			&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), NULL,
 			glm::vec2(0.0), SSR_PP->sizeScale, SSR_PP->getRenderPass(), &tempRenderTargets, depthTexture);
 		assignRenderpassID(temp_ssr_Mat, SSR_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
 
+		SSR_PP->waitForAsyncCompute(SSRP_PP);
+
 		glm::vec4 info = glm::vec4(1.0, 1.0, 1.0, 1.0);
 		
 
@@ -881,32 +1097,100 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		HolePatchingMaterial * temp_hole_Mat = new HolePatchingMaterial;
 
 		PostProcess *HPP = new PostProcess(vulkanApp, "HolePatchingMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1,
-			singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+			VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 1);
 
 		//for ReleaseMode
 		//glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
 
-		HPP->initialize(sizeScale);
+		HPP->initialize(reflectionSizeScale);
 
 		std::vector<Texture*> tempRenderTargets2;
 
 		tempRenderTargets2.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]); //SSR
+		tempRenderTargets2.push_back(HPP->renderTargets[0]); //patched image
 
 		temp_hole_Mat->addBuffer(&SSRInfoBuffer);
 
-		temp_hole_Mat->createPipeline("HolePatchingMat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
-			&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
-			glm::vec2(0.0), glm::vec4(HPP->getExtent().width, HPP->getExtent().height, 1.0, 1.0), HPP->getRenderPass(), &tempRenderTargets2, NULL);
-
-		
-
-		assignRenderpassID(temp_hole_Mat, HPP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+		temp_hole_Mat->createPipeline("HolePatchingMat", "", "", "", "", NULL, NULL, NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+			glm::vec2(0.0), HPP->sizeScale,
+			NULL, &tempRenderTargets2, NULL);
 
 		HPP->recordCommandBuffer();
 
 		postProcessChain.push_back(HPP);
+
+		//Upsample
+		if (interface.SSRDownsample > 1)
+		{
+			SSRUpsampleMaterial* temp_upsample_Mat = new SSRUpsampleMaterial;
+
+			PostProcess *SU_PP = new PostProcess(vulkanApp, "SSRUpsampleMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1,
+				VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+
+			SU_PP->initialize(sizeScale);
+
+			std::vector<Texture*> tempRenderTargets3;
+
+			tempRenderTargets3.push_back(HPP->renderTargets[0]); //low resolution SSR
+			tempRenderTargets3.push_back(gbuffers[NORMAL_COLOR]);
+
+			temp_upsample_Mat->createPipeline("SSRUpsampleMat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), SU_PP->sizeScale, SU_PP->getRenderPass(), &tempRenderTargets3, depthTexture);
+
+			assignRenderpassID(temp_upsample_Mat, SU_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+
+			SU_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(SU_PP);
+		}
 	}
 
+	//SSR temporal resolve, ping-pongs between two targets, each frame reads the one written by the frame before
+	std::vector<Texture*> SSRResolvedTargets;
+
+	if (interface.bUseSSRTemporal)
+	{
+		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0, 1.0);
+
+		Texture *currentReflection = postProcessChain[postProcessChain.size() - 1]->renderTargets[0];
+
+		PostProcess *ST_PP = new PostProcess(vulkanApp, "SSRTemporalMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 2);
+
+		std::vector<std::string> frameMaterialNames;
+		frameMaterialNames.push_back("SSRTemporalMat_0");
+		frameMaterialNames.push_back("SSRTemporalMat_1");
+
+		ST_PP->setFrameMaterials(frameMaterialNames);
+		ST_PP->initialize(sizeScale);
+
+		for (size_t i = 0; i < frameMaterialNames.size(); i++)
+		{
+			SSRTemporalMaterial* temp_st_Mat = new SSRTemporalMaterial;
+
+			temp_st_Mat->addBuffer(&SSRInfoBuffer);
+
+			std::vector<Texture*> tempRenderTargets;
+
+			tempRenderTargets.push_back(currentReflection);
+			tempRenderTargets.push_back(ST_PP->renderTargets[1 - i]); //history
+
+			temp_st_Mat->createPipeline(frameMaterialNames[i], "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), ST_PP->sizeScale, ST_PP->getRenderPass(), &tempRenderTargets, depthTexture);
+			assignRenderpassID(temp_st_Mat, ST_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+		}
+
+		ST_PP->recordCommandBuffer();
+
+		postProcessChain.push_back(ST_PP);
+
+		SSRResolvedTargets = ST_PP->renderTargets;
+	}
+	else
+	{
+		SSRResolvedTargets.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]);
+	}
 	
 	
 
@@ -916,7 +1200,7 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		HorizontalBlurMaterial * temp_horizon_Mat = new HorizontalBlurMaterial;
 
 		PostProcess *HBP = new PostProcess(vulkanApp, "HorizonBlurMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1,
-			singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+			VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 
 		//for ReleaseMode
 		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
@@ -945,7 +1229,7 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 		VerticalBlurMaterial * temp_vertical_Mat = new VerticalBlurMaterial;
 
 		PostProcess *VBP = new PostProcess(vulkanApp, "VerticalBlurMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1,
-			singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+			VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 
 		//for ReleaseMode
 		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
@@ -969,104 +1253,199 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 	
 	*/
 
-	skySystem.lowFreqTexture->connectDevice(pVulkanApp);
-	skySystem.lowFreqTexture->loadTexture2DArrayImage("Asset/Texture/cloudTextures/lowFreq/lowFreq", ".tga");
+	//Composite Post Process
+	{
+		PostProcess *C_PP = new PostProcess(vulkanApp, "CompositePostProcessMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1,
+			VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 
-	skySystem.highFreqTexture->connectDevice(pVulkanApp);
-	skySystem.highFreqTexture->loadTexture2DArrayImage("Asset/Texture/cloudTextures/highFreq/highFreq", ".tga");
+		createSSRBuffer();
 
-	AssetDatabase::GetInstance()->SaveTexture("Asset/Texture/cloudTextures/wheather.tga");
+		//one material per resolved SSR target, the composite follows the temporal ping-pong
+		std::vector<std::string> frameMaterialNames;
 
-	/*
-	//SkyRendering material
-	{			
-		SkyRenderingMaterial* temp_sky_Mat = new SkyRenderingMaterial;
+		if (SSRResolvedTargets.size() > 1)
+		{
+			for (size_t i = 0; i < SSRResolvedTargets.size(); i++)
+				frameMaterialNames.push_back("CompositePostProcessMat_" + std::to_string(i));
+
+			C_PP->setFrameMaterials(frameMaterialNames);
+		}
+		else
+			frameMaterialNames.push_back("CompositePostProcessMat");
 
-		PostProcess *SKY_PP = new PostProcess(vulkanApp, "SkyRendering_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR);
-		
 		//for ReleaseMode
 		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
-		
-		SKY_PP->initialize(sizeScale);
 
-		std::vector<Texture*> tempRenderTargets;
+		C_PP->initialize(sizeScale);
+
+		for (size_t i = 0; i < frameMaterialNames.size(); i++)
+		{
+			CompositePostProcessMaterial* temp_cpp_Mat = new CompositePostProcessMaterial;
 
-		tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]);
-		tempRenderTargets.push_back(skySystem.lowFreqTexture);
-		tempRenderTargets.push_back(skySystem.highFreqTexture);
+			temp_cpp_Mat->addBuffer(&SSRDepthBuffer);
 
-		temp_sky_Mat->createPipeline("SkyRendering_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
-			&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
-			glm::vec2(0.0), glm::vec4(SKY_PP->getExtent().width, SKY_PP->getExtent().height, 1.0, 1.0), SKY_PP->getRenderPass(), &tempRenderTargets, NULL);
-		assignRenderpassID(temp_sky_Mat, SKY_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+			std::vector<Texture*> tempRenderTargets;
 
-		SKY_PP->recordCommandBuffer();
+			tempRenderTargets.push_back(SSRSceneTexture); //Scene
+			tempRenderTargets.push_back(SSRResolvedTargets[i]); //SSR
 
-		postProcessChain.push_back(SKY_PP);
+			temp_cpp_Mat->createPipeline(frameMaterialNames[i], "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), glm::vec4(C_PP->getExtent().width, C_PP->getExtent().height, 1.0, 1.0), C_PP->getRenderPass(), &tempRenderTargets, NULL);
+
+			assignRenderpassID(temp_cpp_Mat, C_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+		}
+
+		C_PP->recordCommandBuffer();
+
+		postProcessChain.push_back(C_PP);
 	}
-	*/
 
-	//Composite Post Process
+	Texture *HDRSceneTexture = postProcessChain[postProcessChain.size() - 1]->renderTargets[0];
+	Texture *bloomTexture = NULL;
+
+	createBloomInfoBuffer();
+
+	//Bloom pyramid, every level is a compute pass on a target half the size of the previous one
+	//it is only built while bloom is on, tone mapping then reads the scene in its place with a zero intensity
+	if (interface.bUseBloom)
 	{
-		CompositePostProcessMaterial* temp_cpp_Mat = new CompositePostProcessMaterial;
+		std::vector<PostProcess*> bloomPyramid;
 
-		PostProcess *C_PP = new PostProcess(vulkanApp, "CompositePostProcessMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1,
-			singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
+		//Downsample
+		for (uint32_t i = 0; i < BLOOM_LEVELS; i++)
+		{
+			float scale = static_cast<float>(2 << i);
+			glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), scale, scale);
 
-		createSSRBuffer();
+			std::string matName = "BloomDownsampleMat" + std::to_string(i);
 
-		temp_cpp_Mat->addBuffer(&SSRDepthBuffer);
+			PostProcess *BD_PP = new PostProcess(vulkanApp, matName, VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 1);
+			BD_PP->initialize(sizeScale);
 
-		//for ReleaseMode
-		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
+			BloomDownsampleMaterial* temp_bd_Mat = new BloomDownsampleMaterial;
 
-		C_PP->initialize(sizeScale);
+			std::vector<Texture*> tempRenderTargets;
+			tempRenderTargets.push_back(i == 0 ? HDRSceneTexture : bloomPyramid[i - 1]->renderTargets[0]);
+			tempRenderTargets.push_back(BD_PP->renderTargets[0]);
 
-		std::vector<Texture*> tempRenderTargets;
+			temp_bd_Mat->createPipeline(matName, "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+				glm::vec2(0.0), BD_PP->sizeScale, NULL, &tempRenderTargets, NULL);
+
+			BD_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(BD_PP);
+			bloomPyramid.push_back(BD_PP);
+		}
 
-		if (interface.bUseBruteForce)
+		//Upsample, back up to half resolution, the last tent upsample happens in tone mapping
+		Texture *lowerLevel = bloomPyramid[BLOOM_LEVELS - 1]->renderTargets[0];
+
+		for (int i = BLOOM_LEVELS - 2; i >= 0; i--)
 		{
-			tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 2]->renderTargets[0]); //Scene
-			tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]); //SSR
+			std::string matName = "BloomUpsampleMat" + std::to_string(i);
+
+			PostProcess *BU_PP = new PostProcess(vulkanApp, matName, VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 1);
+			BU_PP->initialize(bloomPyramid[i]->sizeScale);
+
+			BloomUpsampleMaterial* temp_bu_Mat = new BloomUpsampleMaterial;
+
+			temp_bu_Mat->addBuffer(&bloomInfoBuffer);
+
+			std::vector<Texture*> tempRenderTargets;
+			tempRenderTargets.push_back(lowerLevel);
+			tempRenderTargets.push_back(bloomPyramid[i]->renderTargets[0]);
+			tempRenderTargets.push_back(BU_PP->renderTargets[0]);
+
+			temp_bu_Mat->createPipeline(matName, "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+				glm::vec2(0.0), BU_PP->sizeScale, NULL, &tempRenderTargets, NULL);
+
+			BU_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(BU_PP);
+
+			lowerLevel = BU_PP->renderTargets[0];
 		}
-		else
+
+		bloomTexture = lowerLevel;
+	}
+	else
+		bloomTexture = HDRSceneTexture;
+
+	//Auto exposure, the histogram and the exposure never leave the GPU
+	{
+		createExposureBuffers();
+
+		glm::vec4 sizeScale = glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f);
+
+		//compute passes without render targets, they only write exposureBuffer
+		PostProcess *LH_PP = new PostProcess(vulkanApp, "LuminanceHistogramMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 0);
+		PostProcess *EA_PP = new PostProcess(vulkanApp, "ExposureAdaptationMat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, true, 0);
+
+		LH_PP->initialize(sizeScale);
+		EA_PP->initialize(sizeScale);
+
+		//Luminance histogram
 		{
-			tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 4]->renderTargets[0]); //Scene
-			tempRenderTargets.push_back(postProcessChain[postProcessChain.size() - 1]->renderTargets[0]); //SSR
+			LuminanceHistogramMaterial* temp_lh_Mat = new LuminanceHistogramMaterial;
+
+			temp_lh_Mat->addBuffer(&exposureBuffer);
+
+			std::vector<Texture*> tempRenderTargets;
+			tempRenderTargets.push_back(HDRSceneTexture);
+
+			temp_lh_Mat->createPipeline("LuminanceHistogramMat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+				glm::vec2(0.0), LH_PP->sizeScale, NULL, &tempRenderTargets, NULL);
+
+			LH_PP->recordCommandBuffer();
+
+			postProcessChain.push_back(LH_PP);
 		}
 
-		
+		//Exposure adaptation
+		{
+			ExposureAdaptationMaterial* temp_ea_Mat = new ExposureAdaptationMaterial;
 
-		temp_cpp_Mat->createPipeline("CompositePostProcessMat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
-			&pointLightUniformBuffer, pointLightInfo.size(), &directionalLightUniformBuffer, directionalLightInfo.size(), &perFrameBuffer,
-			glm::vec2(0.0), glm::vec4(C_PP->getExtent().width, C_PP->getExtent().height, 1.0, 1.0), C_PP->getRenderPass(), &tempRenderTargets, NULL);
+			temp_ea_Mat->addBuffer(&exposureBuffer);
+			temp_ea_Mat->addBuffer(&exposureSettingBuffer);
 
-		assignRenderpassID(temp_cpp_Mat, C_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
+			temp_ea_Mat->createPipeline("ExposureAdaptationMat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
+				NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), &perFrameBuffer,
+				glm::vec2(0.0), EA_PP->sizeScale, NULL, NULL, NULL);
 
-		C_PP->recordCommandBuffer();
+			EA_PP->setDispatchSize(1, 1, 1);
+			EA_PP->recordCommandBuffer();
 
-		postProcessChain.push_back(C_PP);
+			postProcessChain.push_back(EA_PP);
+		}
 	}
 
-	/*
 	//ToneMapping material
 	{
 		ToneMappingMaterial* temp_tone_Mat = new ToneMappingMaterial;
 
-		//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! VK_FORMAT_R16G16B16A16_SFLOAT
-		PostProcess *tone_PP = new PostProcess(vulkanApp, "tonemapping_mat", swapChainImageFormat, 1, singleTriangularVertexBuffer, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR);
+		PostProcess *tone_PP = new PostProcess(vulkanApp, "tonemapping_mat", VK_FORMAT_R16G16B16A16_SFLOAT, 1, VK_FILTER_LINEAR, VK_SAMPLER_MIPMAP_MODE_LINEAR, false, 1);
 		tone_PP->initialize(glm::vec4(static_cast<float>(swapChainExtent.width), static_cast<float>(swapChainExtent.height), 1.0f, 1.0f));
 
+		temp_tone_Mat->addBuffer(&exposureBuffer);
+		temp_tone_Mat->addBuffer(&bloomInfoBuffer);
+
+		std::vector<Texture*> tempRenderTargets;
+		tempRenderTargets.push_back(HDRSceneTexture);
+		tempRenderTargets.push_back(bloomTexture);
+
 		temp_tone_Mat->createPipeline("tonemapping_mat", "", "", "", "", NULL, &mainCamera.uniformCameraBuffer,
-			NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(),
-			glm::vec2(0.0), tone_PP->sizeScale, tone_PP->getRenderPass(), &postProcessChain[postProcessChain.size() - 1]->renderTargets, NULL);
+			NULL, pointLightInfo.size(), NULL, directionalLightInfo.size(), NULL,
+			glm::vec2(0.0), tone_PP->sizeScale, tone_PP->getRenderPass(), &tempRenderTargets, NULL);
 		assignRenderpassID(temp_tone_Mat, tone_PP->getRenderPass(), static_cast<uint32_t>(postProcessChain.size()));
 
 		tone_PP->recordCommandBuffer();
 
 		postProcessChain.push_back(tone_PP);
 	}
-	*/
 
 	//Present material
 	{
@@ -1099,14 +1478,19 @@ void Renderer::initialize(Vulkan* pVulkanApp)
 
 	createGbufferCommandBuffers();
 	createFrustumCullingCommandBuffers();
+	createLightCullingCommandBuffers();
 	createMainCommandBuffers();
 
 	//createGUICommandBuffers();
 
 
 	//record static CommandBuffers;
+	recordLightCullingCommandBuffers();
 	recordMainCommandBuffers();
 	//recordGUICommandBuffers();
+
+	//geometry and texture placeholders go out in a few batches, waited for once, full textures stream in from the main loop
+	vulkanApp->getUploadContext()->waitIdle();
 }
 
 /*
@@ -1127,7 +1511,8 @@ void Renderer::updateDepthMipmapBuffers()
 
 void Renderer::createPointLightBuffer()
 {
-	vulkanApp->createBuffer(sizeof(LightInfo) * pointLightInfo.size(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+	//sized for MAX_POINT_LIGHTS so lights can be added without reallocating
+	vulkanApp->createBuffer(sizeof(LightInfo) * MAX_POINT_LIGHTS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 		pointLightUniformBuffer, pointLightUniformMemory);
 	
 	updatePointLightBuffer();
@@ -1135,7 +1520,17 @@ void Renderer::createPointLightBuffer()
 
 void Renderer::updatePointLightBuffer()
 {
-	vulkanApp->updateBuffer(pointLightInfo.data(), pointLightUniformMemory, sizeof(LightInfo)* pointLightInfo.size());
+	size_t numPointLights = std::min(pointLightInfo.size(), static_cast<size_t>(MAX_POINT_LIGHTS));
+	vulkanApp->updateBuffer(pointLightInfo.data(), pointLightUniformMemory, sizeof(LightInfo)* numPointLights);
+}
+
+void Renderer::updateClusterInfoBuffer()
+{
+	ClusterInfo clusterInfo;
+	clusterInfo.depthInfo = glm::vec4(mainCamera.nearPlane, mainCamera.farPlane, CLUSTER_Z / log(mainCamera.farPlane / mainCamera.nearPlane), 0.0f);
+	clusterInfo.lightInfo = glm::uvec4(static_cast<uint32_t>(std::min(pointLightInfo.size(), static_cast<size_t>(MAX_POINT_LIGHTS))), 0, 0, 0);
+
+	pLightCullingMaterial->updateClusterInfoBuffer(clusterInfo);
 }
 
 void Renderer::createDirectionalLightBuffer()
@@ -1168,7 +1563,7 @@ void Renderer::updateSSRBuffer()
 
 void Renderer::createSSRInfoBuffer()
 {
-	vulkanApp->createBuffer(sizeof(glm::vec4), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+	vulkanApp->createBuffer(sizeof(glm::vec4) * 4, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 		SSRInfoBuffer, SSRInfoBufferMem);
 
 	updateSSRInfoBuffer();
@@ -1176,11 +1571,143 @@ void Renderer::createSSRInfoBuffer()
 
 void Renderer::updateSSRInfoBuffer()
 {
-	glm::vec4 tempSSRInfo = glm::vec4(interface.gRoughness, interface.gIntensity, interface.bUseNormalMap == true ? 1.0 : 0.0, interface.bUseHolePatching == true ? 1.0 : 0.0);
-	vulkanApp->updateBuffer(&tempSSRInfo, SSRInfoBufferMem, sizeof(glm::vec4));
+	glm::vec4 tempSSRInfo[4];
+	tempSSRInfo[0] = glm::vec4(interface.gRoughness, interface.gIntensity, interface.bUseNormalMap == true ? 1.0 : 0.0, interface.bUseHolePatching == true ? 1.0 : 0.0);
+	tempSSRInfo[1] = glm::vec4(interface.bUseHiZ == true ? 1.0 : 0.0, static_cast<float>(interface.SSRHiZMaxIterations), interface.SSRThickness, static_cast<float>(interface.SSRDownsample));
+	//the frame index rotates the SSR noise so the temporal resolve sees new samples every frame
+	tempSSRInfo[2] = glm::vec4(interface.bUseSSRTemporal == true ? 1.0 : 0.0, interface.SSRTemporalBlend, static_cast<float>(frameIndex % 64), 0.0);
+	tempSSRInfo[3] = glm::vec4(static_cast<float>(interface.SSRPatchRadius), 0.0, 0.0, 0.0);
+	vulkanApp->updateBuffer(tempSSRInfo, SSRInfoBufferMem, sizeof(glm::vec4) * 4);
 }
 
-void Renderer::createPerFrameBuffer()
+void Renderer::addReflectivePlane(glm::vec4 centerPoint, glm::vec4 size, glm::mat4 rotMat)
+{
+	PlaneInfo planeInfo;
+	planeInfo.rotMat = rotMat;
+	planeInfo.centerPoint = centerPoint;
+	planeInfo.size = size;
+
+	reflectivePlanes.push_back(planeInfo);
+}
+
+void Renderer::createPlaneInfoBuffer()
+{
+	//sized for MAX_REFLECTIVE_PLANES so planes can be added without reallocating
+	vulkanApp->createBuffer(sizeof(PlaneInfoPack) + sizeof(PlaneInfo) * MAX_REFLECTIVE_PLANES, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		planeInfoBuffer, planeInfoBufferMem);
+
+	updatePlaneInfoBuffer();
+}
+
+void Renderer::updatePlaneInfoBuffer()
+{
+	std::vector<PlaneInfo> visiblePlanes;
+
+	for (size_t i = 0; i < reflectivePlanes.size() && visiblePlanes.size() < MAX_REFLECTIVE_PLANES; i++)
+	{
+		PlaneInfo &thisPlane = reflectivePlanes[i];
+
+		//the camera has to be on the reflective side
+		glm::vec3 viewNormal = glm::mat3(mainCamera.viewMat) * glm::vec3(thisPlane.rotMat[2]);
+		glm::vec3 viewCenter = glm::vec3(mainCamera.viewMat * glm::vec4(glm::vec3(thisPlane.centerPoint), 1.0f));
+
+		if (glm::dot(viewNormal, viewCenter) >= 0.0f)
+			continue;
+
+		BoundingBox viewAABB;
+		viewAABB.minPt = glm::vec4(std::numeric_limits<float>::max());
+		viewAABB.maxPt = glm::vec4(-std::numeric_limits<float>::max());
+
+		for (int c = 0; c < 4; c++)
+		{
+			glm::vec3 corner = glm::vec3(thisPlane.centerPoint)
+				+ glm::vec3(thisPlane.rotMat[0]) * (((c & 1) == 0 ? -0.5f : 0.5f) * thisPlane.size.x)
+				+ glm::vec3(thisPlane.rotMat[1]) * (((c & 2) == 0 ? -0.5f : 0.5f) * thisPlane.size.y);
+
+			glm::vec4 viewCorner = mainCamera.viewMat * glm::vec4(corner, 1.0f);
+
+			viewAABB.minPt = glm::min(viewAABB.minPt, viewCorner);
+			viewAABB.maxPt = glm::max(viewAABB.maxPt, viewCorner);
+		}
+
+		if (mainCamera.frustum.checkBox(viewAABB))
+			visiblePlanes.push_back(thisPlane);
+	}
+
+	//planeID.vert draws the planes in this order without a depth buffer, so the nearer ones are drawn last and win
+	std::sort(visiblePlanes.begin(), visiblePlanes.end(), [this](const PlaneInfo &a, const PlaneInfo &b)
+	{
+		glm::vec3 viewCenterA = glm::vec3(mainCamera.viewMat * glm::vec4(glm::vec3(a.centerPoint), 1.0f));
+		glm::vec3 viewCenterB = glm::vec3(mainCamera.viewMat * glm::vec4(glm::vec3(b.centerPoint), 1.0f));
+
+		return glm::dot(viewCenterA, viewCenterA) > glm::dot(viewCenterB, viewCenterB);
+	});
+
+	PlaneInfoPack planeInfoPack = {};
+	planeInfoPack.numPlanes = static_cast<uint32_t>(visiblePlanes.size());
+
+	VkDeviceSize bufferSize = sizeof(PlaneInfoPack) + sizeof(PlaneInfo) * visiblePlanes.size();
+
+	void* data;
+	vkMapMemory(vulkanApp->getDevice(), planeInfoBufferMem, 0, bufferSize, 0, &data);
+	memcpy(data, &planeInfoPack, sizeof(PlaneInfoPack));
+	if (!visiblePlanes.empty())
+		memcpy(static_cast<char*>(data) + sizeof(PlaneInfoPack), visiblePlanes.data(), sizeof(PlaneInfo) * visiblePlanes.size());
+	vkUnmapMemory(vulkanApp->getDevice(), planeInfoBufferMem);
+}
+
+void Renderer::createCloudInfoBuffer()
+{
+	vulkanApp->createBuffer(sizeof(glm::vec4), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		cloudInfoBuffer, cloudInfoBufferMem);
+
+	updateCloudInfoBuffer();
+}
+
+void Renderer::updateCloudInfoBuffer()
+{
+	glm::vec4 tempCloudInfo = glm::vec4(static_cast<float>(interface.cloudMarchSteps), interface.cloudSearchStepScale, interface.cloudMinTransmittance, static_cast<float>(interface.cloudMaxZeroDensitySamples));
+	vulkanApp->updateBuffer(&tempCloudInfo, cloudInfoBufferMem, sizeof(glm::vec4));
+}
+
+void Renderer::createExposureBuffers()
+{
+	vulkanApp->createBuffer(sizeof(ExposureInfo), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		exposureBuffer, exposureBufferMem);
+
+	//only the initial state is uploaded, the GPU owns it afterwards
+	ExposureInfo initialExposure = {};
+	initialExposure.exposure = 1.0f;
+	initialExposure.averageLuminance = 0.18f;
+	vulkanApp->updateBuffer(&initialExposure, exposureBufferMem, sizeof(ExposureInfo));
+
+	vulkanApp->createBuffer(sizeof(glm::vec4), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		exposureSettingBuffer, exposureSettingBufferMem);
+
+	updateExposureSettingBuffer();
+}
+
+void Renderer::updateExposureSettingBuffer()
+{
+	glm::vec4 tempExposureSetting = glm::vec4(interface.bUseAutoExposure == true ? 1.0 : 0.0, interface.exposureCompensation, interface.exposureAdaptationSpeed, 0.0);
+	vulkanApp->updateBuffer(&tempExposureSetting, exposureSettingBufferMem, sizeof(glm::vec4));
+}
+
+void Renderer::createBloomInfoBuffer()
+{
+	vulkanApp->createBuffer(sizeof(glm::vec4), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		bloomInfoBuffer, bloomInfoBufferMem);
+
+	updateBloomInfoBuffer();
+}
+
+void Renderer::updateBloomInfoBuffer()
+{
+	glm::vec4 tempBloomInfo = glm::vec4(interface.bUseBloom == true ? interface.bloomIntensity : 0.0f, interface.bloomRadius, static_cast<float>(BLOOM_LEVELS), 0.0f);
+	vulkanApp->updateBuffer(&tempBloomInfo, bloomInfoBufferMem, sizeof(glm::vec4));
+}
+
+void Renderer::createPerFrameBuffer()
 {
 	vulkanApp->createBuffer(sizeof(perframeBuffer), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 		perFrameBuffer, perFrameBufferMemory);
@@ -1192,7 +1719,7 @@ void Renderer::createPerFrameBuffer()
 void Renderer::updatePerFrameBuffer()
 {
 	perframeBuffer perFrameBuffer;
-	perFrameBuffer.timeInfo = glm::vec4(currentTime*0.001f, deltaTime*0.001f, 0.0f, 0.0f);
+	perFrameBuffer.timeInfo = glm::vec4(static_cast<float>(timer.getRenderTime()), static_cast<float>(timer.getRenderDeltaTime()), static_cast<float>(frameIndex), 0.0f);
 	vulkanApp->updateBuffer(&perFrameBuffer, perFrameBufferMemory, sizeof(perframeBuffer));
 }
 
@@ -1217,11 +1744,9 @@ void Renderer::reInitializeRenderer()
 
 	vkDestroyCommandPool(vulkanApp->getDevice(), gbufferCmdPool, nullptr);
 	vkDestroyCommandPool(vulkanApp->getDevice(), frustumCullingPool, nullptr);
+	vkDestroyCommandPool(vulkanApp->getDevice(), lightCullingPool, nullptr);
 	vkDestroyCommandPool(vulkanApp->getDevice(), mainCmdPool, nullptr);
 
-	vkDestroyBuffer(vulkanApp->getDevice(), singleTriangularVertexBuffer, nullptr);
-	vkFreeMemory(vulkanApp->getDevice(), singleTriangularVertexMemory, nullptr);
-
 	mainCamera.shutDown();
 
 	//delete[] SSROforReset;
@@ -1243,8 +1768,19 @@ void Renderer::reInitializeRenderer()
 	vkDestroyBuffer(vulkanApp->getDevice(), perFrameBuffer, nullptr);
 	vkFreeMemory(vulkanApp->getDevice(), perFrameBufferMemory, nullptr);
 
+	//the cloud resources only exist while clouds were on, the toggle rebuilds them through this reset
+	vkDestroyBuffer(vulkanApp->getDevice(), cloudInfoBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), cloudInfoBufferMem, nullptr);
+	cloudInfoBuffer = NULL;
+	cloudInfoBufferMem = NULL;
+
+	skySystem.shutDown();
+
 	DELETE_SAFE(vulkanApp);
 
+	//the temporal histories are created again and hold nothing yet
+	frameIndex = 0;
+
 	initialize(NULL);
 
 	interface.windowResetFlag = false;
@@ -1252,6 +1788,8 @@ void Renderer::reInitializeRenderer()
 
 void Renderer::culling()
 {
+	PROFILE_ZONE("Renderer::culling");
+
 	AssetDatabase* DBInstance = AssetDatabase::GetInstance();
 
 	//Culling
@@ -1320,144 +1858,418 @@ void Renderer::culling()
 	}
 }
 
-void Renderer::mainloop()
+void Renderer::updateTextureStreaming()
 {
-	unsigned int simulationTime = 0;
+	PROFILE_ZONE("Renderer::updateTextureStreaming");
 
-	//mainCamera.updateOrbit(0.0f, 0.0f, 0.0f);
+	AssetDatabase* DBInstance = AssetDatabase::GetInstance();
 
-	while (!glfwWindowShouldClose(interface.getWindow()))
+	//world units that fill the viewport height at a view distance of one
+	float viewHeight = 2.0f * glm::tan(glm::radians(mainCamera.fovY) * 0.5f);
+
+	for (size_t i = 0; i < DBInstance->objectManager.size(); i++)
 	{
-		glfwPollEvents();
+		Object *thisOBJ = DBInstance->objectManager[i];
 
-		if (interface.windowResetFlag)
+		if (thisOBJ->AABB.cullingInfo.x >= 1.0f)
+			continue;
+
+		glm::mat4 modelViewMat = mainCamera.viewMat * thisOBJ->modelMat;
+
+		for (size_t j = 0; j < thisOBJ->geoms.size(); j++)
 		{
-			reInitializeRenderer();
-		}
+			Geometry *thisGeom = thisOBJ->geoms[j];
 
-		unsigned int realTime = timer.getTime();
-		deltaTime = realTime - previousTime;
-		currentTime += deltaTime;
+			//geomAABB carries the result of the GPU culling
+			if (USE_GPU_CULLING && thisOBJ->geomAABB[j].cullingInfo.x >= 1.0f)
+				continue;
 
+			if (thisGeom->uvSpan <= 0.0f)
+				continue;
 
-		interface.fpstracker++;
+			BoundingBox viewGeoAABB = mainCamera.getViewAABB(thisGeom->AABB, modelViewMat);
 
-		double fpsElapsedTime = (realTime - fpsPreviosTime) * 0.001;
+			//the nearest point of the box, the camera looks down -z
+			float distance = glm::max(-viewGeoAABB.maxPt.z, mainCamera.nearPlane);
+			float size = 2.0f * glm::max(viewGeoAABB.Extents.x, glm::max(viewGeoAABB.Extents.y, viewGeoAABB.Extents.z));
 
-		if (fpsElapsedTime >= 1.0)
-		{
+			float pixels = size / (distance * viewHeight) * mainCamera.viewPortSize.y;
 
-			interface.fps = static_cast<int>(interface.fpstracker / fpsElapsedTime);
-			interface.fpstracker = 0;
-			fpsPreviosTime = realTime;
+			Material *pMaterial = thisOBJ->materials[thisGeom->getMaterialID()];
 
-			std::string title = "Jin Engine | " + std::to_string(interface.fps) + " fps | " + std::to_string(1000.0 / (double)interface.fps) + " ms";
-			interface.setWindowTitle(title);
+			for (size_t k = 0; k < pMaterial->textures.size(); k++)
+			{
+				DBInstance->textureStreamer.requestPixelDensity(pMaterial->textures[k], pixels / thisGeom->uvSpan);
+			}
 		}
+	}
+}
 
+void Renderer::updateFrame()
+{
+	culling();
+	updateTextureStreaming();
+
+	AssetDatabase* DBInstance = AssetDatabase::GetInstance();
 
-		double sensitivity = 20.0;
-		double deltaTimeSec = deltaTime * 0.001;
-		double currentTimeSec = currentTime * 0.001;
+	for (size_t i = 0; i < DBInstance->objectManager.size(); i++)
+	{
+		Object *thisOBJ = DBInstance->objectManager[i];
 
-		if (interface.mouseDeltaX != 0.0 || interface.mouseDeltaY != 0.0 || interface.mouseDeltaZ != 0.0)
+		if (thisOBJ->bRoll)
 		{
-			mainCamera.updateOrbit(static_cast<float>(interface.mouseDeltaX * deltaTimeSec * sensitivity),
-				static_cast<float>(interface.mouseDeltaY * deltaTimeSec * sensitivity),
-					static_cast<float>(interface.mouseDeltaZ * deltaTimeSec * sensitivity));
-			
-			interface.mouseDeltaX = 0.0;
-			interface.mouseDeltaY = 0.0;
-			interface.mouseDeltaZ = 0.0;
+			//0.05 degrees per millisecond, a constant rate needs no blending between steps
+			thisOBJ->updateOrbit(0.0f, static_cast<float>(timer.getRenderDeltaTime() * 50.0), 0.0f);
+			thisOBJ->updateObjectBuffer();
 		}
-		
-		interface.getAsynckeyState();
+	}
 
-		if( (interface.bFoward || interface.bBackward)) 
-		{
-			if (interface.bFoward)
-			{
-				mainCamera.updatePosition(0.0f, 0.0f, -static_cast<float>(deltaTimeSec * sensitivity));
-			}
-			else if (interface.bBackward)
-			{
-				mainCamera.updatePosition(0.0f, 0.0f, static_cast<float>(deltaTimeSec * sensitivity));
-			}
+	{
+		PROFILE_ZONE("Renderer::updateUniformBuffers");
+
+		//update SkySystem
+		//skySystem.sun.updateOrbit(deltaTime * 0.05f, 0.0f, 0.0f);
+		skySystem.sun.lightInfo.direction = skySystem.sun.getViewVector4();
+		updateDirectionalLightBuffer();
+	
+	
+		updateSSRBuffer();
+		updateSSRInfoBuffer();
+		updatePlaneInfoBuffer();
+
+		if (interface.bRenderClouds)
+			updateCloudInfoBuffer();
+
+		updateExposureSettingBuffer();
+		updateBloomInfoBuffer();
+	
 
-			interface.bFoward = false;
-			interface.bBackward = false;
+
+		updatePerFrameBuffer();
+	}
+
+	//the previous frame is done, textures that finished streaming rewrite their descriptors
+	//and the command buffers recorded once bind the rewritten sets again
+	if (DBInstance->textureStreamer.update(static_cast<VkDeviceSize>(interface.textureStreamingBudgetMB) * 1024 * 1024))
+	{
+		for (size_t i = 0; i < postProcessChain.size(); i++)
+		{
+			postProcessChain[i]->recordCommandBuffer();
 		}
 
-		if ((interface.bLeft || interface.bRight))
+		recordMainCommandBuffers();
+	}
+}
+
+void Renderer::mainloop()
+{
+	//the simulated camera, the frames show it blended between the last two steps
+	CameraPath::CameraKey cameraPose = { 0.0, mainCamera.position, mainCamera.theta, mainCamera.phi };
+	CameraPath::CameraKey previousCameraPose = cameraPose;
+
+	uint64_t titleTime = 0;
+
+	//mainCamera.updateOrbit(0.0f, 0.0f, 0.0f);
+
+	while (!glfwWindowShouldClose(interface.getWindow()))
+	{
+		PROFILE_ZONE("Frame");
+
+		glfwPollEvents();
+
+		if (interface.bCaptureProfile)
 		{
-			if (interface.bLeft)
-			{
-				mainCamera.updatePosition(-static_cast<float>(deltaTimeSec * sensitivity), 0.0f, 0.0f);
-			}
-			else if (interface.bRight)
-			{
-				mainCamera.updatePosition(static_cast<float>(deltaTimeSec * sensitivity), 0.0f, 0.0f);
-			}
+			if (Profiler::GetInstance()->exportChromeTrace("profile.json"))
+				std::cout << "wrote profile.json" << std::endl;
+
+			vulkanApp->getGpuTimer()->printPassTimes();
+
+			Time::FramePacing pacing = timer.getFramePacing();
 
-			interface.bLeft = false;
-			interface.bRight = false;
+			std::cout << "frame pacing over the last " << FRAME_PACING_WINDOW << " frames | mean " << pacing.mean << " ms | p50 " << pacing.p50 << " ms | p99 " << pacing.p99
+				<< " ms | min " << pacing.min << " ms | max " << pacing.max << " ms | std dev " << pacing.stdDev << " ms | " << pacing.hitches << " hitches" << std::endl;
+
+			interface.bCaptureProfile = false;
 		}
 
-		if(interface.bRotate)
+		if (interface.windowResetFlag)
 		{
-			//interface.gRoughness = (glm::sin(currentTimeSec * 0.25f) + 1.f) * 0.3f;
-			mainCamera.updateOrbit(static_cast<float>( glm::sin(-currentTimeSec * 0.25f) * deltaTimeSec * 9.0f), 0.0f, 0.0f);
+			reInitializeRenderer();
 		}
 
-		if (interface.bMoveForward)
+		timer.beginFrame();
+
+		//keep last frame's matrix before the camera moves
+		mainCamera.updatePrevViewProjMatrix();
+
+		if (timer.getTime() - titleTime >= 1000000000)
 		{
-			mainCamera.updatePosition(0.0f, 0.0f, static_cast<float>(glm::sin(currentTimeSec * 0.5f) * deltaTimeSec * 2.0f));
+			Time::FramePacing pacing = timer.getFramePacing();
+
+			interface.fps = static_cast<int>(pacing.fps);
+			titleTime = timer.getTime();
+
+			std::string title = "Jin Engine | " + std::to_string(interface.fps) + " fps | " + std::to_string(pacing.mean) + " ms | p99 " + std::to_string(pacing.p99) + " ms | GPU " +
+				std::to_string(vulkanApp->getGpuTimer()->getFrameTime()) + " ms";
+			interface.setWindowTitle(title);
 		}
-		
-		culling();
 
-		AssetDatabase* DBInstance = AssetDatabase::GetInstance();
+		interface.getAsynckeyState();
 
-		for (size_t i = 0; i < DBInstance->objectManager.size(); i++)
+		while (timer.step())
 		{
-			Object *thisOBJ = DBInstance->objectManager[i];
+			previousCameraPose = cameraPose;
 
-			if (thisOBJ->bRoll)
-			{
-				thisOBJ->updateOrbit(0.0f, deltaTime * 0.05f, 0.0f);
-				thisOBJ->updateObjectBuffer();
-			}
+			mainCamera.setPose(cameraPose.position, cameraPose.theta, cameraPose.phi);
+			updateSimulation(timer.getStepTime(), timer.getSimulationTime());
+
+			cameraPose.position = mainCamera.position;
+			cameraPose.theta = mainCamera.theta;
+			cameraPose.phi = mainCamera.phi;
 		}
 
-		//update SkySystem
-		//skySystem.sun.updateOrbit(deltaTime * 0.05f, 0.0f, 0.0f);
-		skySystem.sun.lightInfo.direction = skySystem.sun.getViewVector4();
-		updateDirectionalLightBuffer();
-		
-		
-		updateSSRBuffer();
-		updateSSRInfoBuffer();
+		//held keys move the camera in every step of the frame
+		interface.bFoward = false;
+		interface.bBackward = false;
+		interface.bLeft = false;
+		interface.bRight = false;
+
+		float alpha = static_cast<float>(timer.getAlpha());
+
+		mainCamera.setPose(glm::mix(previousCameraPose.position, cameraPose.position, alpha), glm::mix(previousCameraPose.theta, cameraPose.theta, alpha),
+			glm::mix(previousCameraPose.phi, cameraPose.phi, alpha));
 		
+		//K starts and stops recording, the benchmark replays the file
+		if (interface.bRecordCameraPath)
+		{
+			recordedCameraPath.addKey(timer.getRenderTime(), mainCamera.position, mainCamera.theta, mainCamera.phi);
+		}
+		else if (!recordedCameraPath.empty())
+		{
+			if (recordedCameraPath.save("camera_path.txt"))
+				std::cout << "wrote camera_path.txt" << std::endl;
 
+			recordedCameraPath.clear();
+		}
 
-		updatePerFrameBuffer();
+		updateFrame();
+
+		//the previous frame has finished, its timestamps are read before the passes reset them
+		vulkanApp->getGpuTimer()->resolve();
 
 		//record it per everyframe but can do frustum culling
 		recordGbufferCommandBuffers();
+
+		//uploads recorded since the last frame go ahead of it on the graphics queue
+		vulkanApp->getUploadContext()->flush();
 		
 
-		draw(deltaTime);
+		draw();
 
-		previousTime = realTime;
+		frameIndex++;
 	}
 
 	vkDeviceWaitIdle(vulkanApp->getDevice());
 }
 
-void Renderer::draw(unsigned int deltaTime)
+void Renderer::updateSimulation(double stepTime, double simulationTime)
+{
+	double sensitivity = 20.0;
+
+	//the mouse has moved since the last step, a pixel turns the camera by the same angle at any frame rate, the angle it used to at 60 fps
+	double mouseSensitivity = sensitivity / 60.0;
+
+	if (interface.mouseDeltaX != 0.0 || interface.mouseDeltaY != 0.0 || interface.mouseDeltaZ != 0.0)
+	{
+		mainCamera.updateOrbit(static_cast<float>(interface.mouseDeltaX * mouseSensitivity),
+			static_cast<float>(interface.mouseDeltaY * mouseSensitivity),
+				static_cast<float>(interface.mouseDeltaZ * mouseSensitivity));
+		
+		interface.mouseDeltaX = 0.0;
+		interface.mouseDeltaY = 0.0;
+		interface.mouseDeltaZ = 0.0;
+	}
+
+	if (interface.bFoward)
+	{
+		mainCamera.updatePosition(0.0f, 0.0f, -static_cast<float>(stepTime * sensitivity));
+	}
+	else if (interface.bBackward)
+	{
+		mainCamera.updatePosition(0.0f, 0.0f, static_cast<float>(stepTime * sensitivity));
+	}
+
+	if (interface.bLeft)
+	{
+		mainCamera.updatePosition(-static_cast<float>(stepTime * sensitivity), 0.0f, 0.0f);
+	}
+	else if (interface.bRight)
+	{
+		mainCamera.updatePosition(static_cast<float>(stepTime * sensitivity), 0.0f, 0.0f);
+	}
+
+	if(interface.bRotate)
+	{
+		//interface.gRoughness = (glm::sin(simulationTime * 0.25f) + 1.f) * 0.3f;
+		mainCamera.updateOrbit(static_cast<float>( glm::sin(-simulationTime * 0.25f) * stepTime * 9.0f), 0.0f, 0.0f);
+	}
+
+	if (interface.bMoveForward)
+	{
+		mainCamera.updatePosition(0.0f, 0.0f, static_cast<float>(glm::sin(simulationTime * 0.5f) * stepTime * 2.0f));
+	}
+}
+
+void Renderer::runBenchmark(Benchmark &benchmark)
+{
+	//without a recorded path the camera turns once in place from where it starts
+	if (benchmark.cameraPath.empty())
+	{
+		double duration = benchmark.frameCount * benchmark.frameStep * 0.001;
+
+		benchmark.cameraPath.addKey(0.0, mainCamera.position, mainCamera.theta, mainCamera.phi);
+		benchmark.cameraPath.addKey(duration, mainCamera.position, mainCamera.theta + 360.0f, mainCamera.phi);
+	}
+
+	Profiler* profiler = Profiler::GetInstance();
+	GpuTimer* gpuTimer = vulkanApp->getGpuTimer();
+	AssetDatabase* DBInstance = AssetDatabase::GetInstance();
+
+	uint32_t warmupFrame = 0;
+	uint32_t measuredFrame = 0;
+	bool bMeasuring = false;
+
+	while (measuredFrame < benchmark.frameCount)
+	{
+		PROFILE_ZONE("Frame");
+
+		//the first pose is held until the warmup is over and no texture is streaming in anymore
+		if (!bMeasuring && warmupFrame >= benchmark.warmupFrames && DBInstance->textureStreamer.getPendingCount() == 0)
+			bMeasuring = true;
+
+		uint64_t startTime = profiler->getTime();
+
+		//simulated time, the frames see the same poses and shader times however fast they render
+		//the pose comes from the path, the steps only move the clock
+		timer.beginFrame(benchmark.frameStep * 0.001);
+		while (timer.step());
+
+		CameraPath::CameraKey pose = benchmark.cameraPath.sample(bMeasuring ? measuredFrame * benchmark.frameStep * 0.001 : 0.0);
+
+		mainCamera.updatePrevViewProjMatrix();
+		mainCamera.setPose(pose.position, pose.theta, pose.phi);
+
+		updateFrame();
+
+		recordGbufferCommandBuffers();
+
+		vulkanApp->getUploadContext()->flush();
+
+		draw();
+
+		uint64_t submitTime = profiler->getTime();
+
+		vkDeviceWaitIdle(vulkanApp->getDevice());
+
+		uint64_t endTime = profiler->getTime();
+
+		//the frame has finished, its own timestamps are read before the next one resets them
+		gpuTimer->resolve();
+
+		if (bMeasuring)
+		{
+			benchmark.addFrame((submitTime - startTime) * 0.000001, (endTime - startTime) * 0.000001, gpuTimer->isSupported() ? gpuTimer->getFrameTime() : -1.0);
+			measuredFrame++;
+		}
+		else
+		{
+			warmupFrame++;
+		}
+
+		frameIndex++;
+	}
+}
+
+void Renderer::runGoldenTest(GoldenTest &goldenTest)
+{
+	//without poses the starting view is the only one
+	if (goldenTest.cameraPath.empty())
+		goldenTest.cameraPath.addKey(0.0, mainCamera.position, mainCamera.theta, mainCamera.phi);
+
+	AssetDatabase* DBInstance = AssetDatabase::GetInstance();
+
+	const char* gbufferNames[NUM_GBUFFERS] = { "gbuffer_basic", "gbuffer_specular", "gbuffer_normal", "gbuffer_emissive" };
+
+	for (size_t p = 0; p < goldenTest.cameraPath.size(); p++)
+	{
+		CameraPath::CameraKey pose = goldenTest.cameraPath.getKey(p);
+
+		//the pose is held until the temporal passes have converged and no texture is streaming in anymore
+		for (uint32_t settleFrame = 0; settleFrame < goldenTest.settleFrames || DBInstance->textureStreamer.getPendingCount() > 0; settleFrame++)
+		{
+			//simulated time, every run sees the same shader times
+			timer.beginFrame(goldenTest.frameStep * 0.001);
+			while (timer.step());
+
+			mainCamera.updatePrevViewProjMatrix();
+			mainCamera.setPose(pose.position, pose.theta, pose.phi);
+
+			updateFrame();
+
+			recordGbufferCommandBuffers();
+
+			vulkanApp->getUploadContext()->flush();
+
+			draw();
+
+			vkDeviceWaitIdle(vulkanApp->getDevice());
+
+			vulkanApp->getGpuTimer()->resolve();
+
+			frameIndex++;
+		}
+
+		uint32_t poseIndex = static_cast<uint32_t>(p);
+		CapturedImage captured;
+
+		for (uint32_t i = 0; i < gbuffers.size(); i++)
+		{
+			if (GoldenTest::readImage(vulkanApp, gbuffers[i]->textureImage, VK_FORMAT_R16G16B16A16_SFLOAT, swapChainExtent, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, captured))
+				goldenTest.addImage(poseIndex, gbufferNames[i], captured);
+		}
+
+		for (size_t i = 0; i < postProcessChain.size(); i++)
+		{
+			PostProcess *postProcess = postProcessChain[i];
+
+			for (size_t j = 0; j < postProcess->renderTargets.size(); j++)
+			{
+				std::string passName = postProcess->getMaterialName();
+
+				if (postProcess->renderTargets.size() > 1)
+					passName += "_" + std::to_string(j);
+
+				if (GoldenTest::readImage(vulkanApp, postProcess->renderTargets[j]->textureImage, postProcess->getFormat(), postProcess->getExtent(), postProcess->getTargetLayout(), captured))
+					goldenTest.addImage(poseIndex, passName, captured);
+			}
+		}
+
+		//the main pass leaves the offscreen image ready to be copied
+		if (GoldenTest::readImage(vulkanApp, swapChainImages[0], swapChainImageFormat, swapChainExtent, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, captured))
+			goldenTest.addImage(poseIndex, "final", captured);
+	}
+}
+
+void Renderer::draw()
 {
-	uint32_t imageIndex;
-	int result = vkAcquireNextImageKHR(vulkanApp->getDevice(), swapChain, std::numeric_limits<uint64_t>::max(), gbufferSemaphore, VK_NULL_HANDLE, &imageIndex);
+	PROFILE_ZONE("Renderer::draw");
+
+	uint32_t imageIndex = 0;
+	int result = VK_SUCCESS;
+
+	//headless, the offscreen image is free once the previous frame has finished
+	if (!interface.bHeadless)
+		result = vkAcquireNextImageKHR(vulkanApp->getDevice(), swapChain, std::numeric_limits<uint64_t>::max(), gbufferSemaphore, VK_NULL_HANDLE, &imageIndex);
 
 	if (result == VK_ERROR_OUT_OF_DATE_KHR)
 	{
@@ -1470,13 +2282,15 @@ void Renderer::draw(unsigned int deltaTime)
 	}
 
 
+	vulkanApp->getGpuTimer()->markSubmit();
+
 	//Draw G-buffer
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
 	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 
-	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.waitSemaphoreCount = interface.bHeadless ? 0 : 1;
 	submitInfo.pWaitSemaphores = &gbufferSemaphore;
 	submitInfo.pWaitDstStageMask = waitStages;
 	submitInfo.commandBufferCount = 1;
@@ -1489,29 +2303,78 @@ void Renderer::draw(unsigned int deltaTime)
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
 
-	VkSemaphore *prevSM = &pbrSemaphore;
-	VkSemaphore *currentSM = NULL;	
+	//Light Culling
+	VkPipelineStageFlags computeWaitStages[] = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = &pbrSemaphore;
+	submitInfo.pWaitDstStageMask = computeWaitStages;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &lightCullingCmd[0];
+
+	std::vector<VkSemaphore> signalSMs;
+	signalSMs.push_back(lightCullingSemaphore);
+	collectForkSemaphores(0, signalSMs);
+
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSMs.size());
+	submitInfo.pSignalSemaphores = signalSMs.data();
+
+	if (vkQueueSubmit(lightCullingQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to submit light culling command buffer!");
+	}
+
+	VkSemaphore *prevSM = &lightCullingSemaphore;
+
+	std::vector<VkSemaphore> waitSMs;
+	std::vector<VkPipelineStageFlags> waitSMStages;
 	
 	//PostProcess
 	for (size_t i = 0; i < postProcessChain.size(); i++)
 	{
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = prevSM;
-		submitInfo.pWaitDstStageMask = waitStages;
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &postProcessChain[i]->cmds[0];
-		submitInfo.signalSemaphoreCount = 1;
+		PostProcess *thisPP = postProcessChain[i];
 
-		currentSM = postProcessChain[i]->getFirstSM();
+		waitSMs.clear();
+		waitSMStages.clear();
+		signalSMs.clear();
 
-		submitInfo.pSignalSemaphores = currentSM;
+		signalSMs.push_back(*thisPP->getFirstSM());
 
-		if (vkQueueSubmit(postProcessChain[i]->getFirstQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		if (thisPP->bAsyncCompute)
+		{
+			//the graphics chain goes on without it until a pass joins it
+			waitSMs.push_back(*thisPP->getForkSM());
+			waitSMStages.push_back(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		}
+		else
+		{
+			waitSMs.push_back(*prevSM);
+			waitSMStages.push_back(waitStages[0]);
+
+			for (size_t j = 0; j < thisPP->asyncDependencies.size(); j++)
+			{
+				waitSMs.push_back(*thisPP->asyncDependencies[j]->getFirstSM());
+				waitSMStages.push_back(VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+			}
+
+			collectForkSemaphores(i + 1, signalSMs);
+		}
+
+		submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSMs.size());
+		submitInfo.pWaitSemaphores = waitSMs.data();
+		submitInfo.pWaitDstStageMask = waitSMStages.data();
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = thisPP->getFrameCmd(frameIndex);
+		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSMs.size());
+		submitInfo.pSignalSemaphores = signalSMs.data();
+
+		if (vkQueueSubmit(thisPP->getFirstQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to submit draw command buffer!");
 		}
 
-		prevSM = currentSM;
+		if (!thisPP->bAsyncCompute)
+			prevSM = thisPP->getFirstSM();
 	}
 
 	//guiQueue
@@ -1541,7 +2404,7 @@ void Renderer::draw(unsigned int deltaTime)
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &mainCmd[imageIndex];
 
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = interface.bHeadless ? 0 : 1;
 	submitInfo.pSignalSemaphores = &presentSemaphore;
 
 	vkQueueWaitIdle(pbrQueue);
@@ -1551,6 +2414,10 @@ void Renderer::draw(unsigned int deltaTime)
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
 
+	//nothing to present, the benchmark waits for the frame itself
+	if (interface.bHeadless)
+		return;
+
 	
 
 
@@ -1583,6 +2450,14 @@ void Renderer::draw(unsigned int deltaTime)
 
 }
 
+void Renderer::collectForkSemaphores(size_t first, std::vector<VkSemaphore> &signalSMs)
+{
+	for (size_t i = first; i < postProcessChain.size() && postProcessChain[i]->bAsyncCompute; i++)
+	{
+		signalSMs.push_back(*postProcessChain[i]->getForkSM());
+	}
+}
+
 void Renderer::reCreateRenderer()
 {
 	vkDeviceWaitIdle(vulkanApp->getDevice());
@@ -1647,10 +2522,12 @@ void Renderer::reCreateRenderer()
 
 	createGbufferCommandBuffers();
 	createFrustumCullingCommandBuffers();
+	createLightCullingCommandBuffers();
 	createMainCommandBuffers();
 	//createGUICommandBuffers();
 
 	//record static CommandBuffers;
+	recordLightCullingCommandBuffers();
 	recordMainCommandBuffers();
 	//recordGUICommandBuffers();
 }
@@ -1688,6 +2565,15 @@ void Renderer::releaseRenderPart()
 	frustumCmd.clear();
 
 
+	for (size_t i = 0; i < lightCullingCmd.size(); i++)
+	{
+		vkFreeCommandBuffers(vulkanApp->getDevice(), lightCullingPool, 1, &lightCullingCmd[i]);
+		lightCullingCmd[i] = NULL;
+	}
+
+	lightCullingCmd.clear();
+
+
 	for (size_t i = 0; i < gbufferFramebuffers.size(); i++)
 	{
 		vkDestroyFramebuffer(vulkanApp->getDevice(), gbufferFramebuffers[i], nullptr);
@@ -1748,7 +2634,10 @@ void Renderer::releaseRenderPart()
 
 	swapChainImageViews.clear();
 
-	vkDestroySwapchainKHR(vulkanApp->getDevice(), swapChain, nullptr);
+	if (interface.bHeadless)
+		releaseOffscreenImages();
+	else
+		vkDestroySwapchainKHR(vulkanApp->getDevice(), swapChain, nullptr);
 }
 
 
@@ -1771,11 +2660,9 @@ void Renderer::shutDown()
 
 	vkDestroyCommandPool(vulkanApp->getDevice(), gbufferCmdPool, nullptr);
 	vkDestroyCommandPool(vulkanApp->getDevice(), frustumCullingPool, nullptr);
+	vkDestroyCommandPool(vulkanApp->getDevice(), lightCullingPool, nullptr);
 	vkDestroyCommandPool(vulkanApp->getDevice(), mainCmdPool, nullptr);
 
-	vkDestroyBuffer(vulkanApp->getDevice(), singleTriangularVertexBuffer, nullptr);
-	vkFreeMemory(vulkanApp->getDevice(), singleTriangularVertexMemory, nullptr);
-
 	mainCamera.shutDown();
 
 	//except Sun
@@ -1818,6 +2705,21 @@ void Renderer::shutDown()
 
 	vkDestroyBuffer(vulkanApp->getDevice(), SSRInfoBuffer, nullptr);
 	vkFreeMemory(vulkanApp->getDevice(), SSRInfoBufferMem, nullptr);
+
+	vkDestroyBuffer(vulkanApp->getDevice(), planeInfoBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), planeInfoBufferMem, nullptr);
+
+	vkDestroyBuffer(vulkanApp->getDevice(), cloudInfoBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), cloudInfoBufferMem, nullptr);
+
+	vkDestroyBuffer(vulkanApp->getDevice(), exposureBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), exposureBufferMem, nullptr);
+
+	vkDestroyBuffer(vulkanApp->getDevice(), exposureSettingBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), exposureSettingBufferMem, nullptr);
+
+	vkDestroyBuffer(vulkanApp->getDevice(), bloomInfoBuffer, nullptr);
+	vkFreeMemory(vulkanApp->getDevice(), bloomInfoBufferMem, nullptr);
 	
 	skySystem.shutDown();
 
@@ -1881,7 +2783,7 @@ void Renderer::createGbuffers()
 		gbuffers[i] = new Texture;
 		gbuffers[i]->connectDevice(vulkanApp);
 		vulkanApp->createImage(VK_IMAGE_TYPE_2D, swapChainExtent.width, swapChainExtent.height, 1, 1, 1, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, getGbufferUsage(), VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			gbuffers[i]->textureImage, gbuffers[i]->textureImageMemory);
 
 		vulkanApp->createImageView(gbuffers[i]->textureImage, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount, gbuffers[i]->textureImageView);
@@ -1896,7 +2798,7 @@ void Renderer::updateGbuffers()
 	for (uint32_t i = 0; i < gbuffers.size(); i++)
 	{
 		vulkanApp->createImage(VK_IMAGE_TYPE_2D, swapChainExtent.width, swapChainExtent.height, 1, 1, 1, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			VK_IMAGE_LAYOUT_UNDEFINED, getGbufferUsage(), VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			gbuffers[i]->textureImage, gbuffers[i]->textureImageMemory);
 
 		vulkanApp->createImageView(gbuffers[i]->textureImage, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount, gbuffers[i]->textureImageView);
@@ -1944,31 +2846,6 @@ void Renderer::deleteGbuffers()
 	gbuffers.clear();
 }
 
-void  Renderer::createSingleTriangularVertexBuffer()
-{
-	VkDeviceSize bufferSize = sizeof(Vertex) * 3;
-
-	vulkanApp->createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, singleTriangularVertexBuffer, singleTriangularVertexMemory);
-
-	//Vulkan's Y coord is opposite
-
-	Vertex Vertices[3];
-	Vertices[0].positions = glm::vec4(-1.0, -3.0, 0.5, 1.0);
-	Vertices[0].texcoords = glm::vec2(0.0, -1.0);
-
-	Vertices[1].positions = glm::vec4(-1.0, 1.0, 0.5, 1.0);
-	Vertices[1].texcoords = glm::vec2(0.0, 1.0);
-
-	Vertices[2].positions = glm::vec4(3.0, 1.0, 0.5, 1.0);
-	Vertices[2].texcoords = glm::vec2(2.0, 1.0);
-
-	void* data;
-	vkMapMemory(vulkanApp->getDevice(), singleTriangularVertexMemory, 0, bufferSize, 0, &data);
-	memcpy(data, Vertices, (size_t)bufferSize);
-	vkUnmapMemory(vulkanApp->getDevice(), singleTriangularVertexMemory);
-}
-
-
 void Renderer::createGbufferCommandPool()
 {
 	vulkanApp->createCommandPool(gbufferCmdPool);
@@ -1981,20 +2858,25 @@ void Renderer::createGbufferCommandBuffers()
 
 void Renderer::recordGbufferCommandBuffers()
 {
+	PROFILE_ZONE("Renderer::recordGbufferCommandBuffers");
+
 	std::vector<VkClearValue> clearValues;
 	clearValues.resize(NUM_GBUFFERS + 1);
 	clearValues[BASIC_COLOR].color = { 0.0f, 0.0f, 0.0f, 0.0f };
 	clearValues[SPECULAR_COLOR].color = { 0.0f, 0.0f, 0.0f, 0.0f };
 	clearValues[NORMAL_COLOR].color = { 0.0f, 0.0f, 0.0f, 0.0f };
 	clearValues[EMISSIVE_COLOR].color = { 0.0f, 0.0f, 0.0f, 0.0f };
-	clearValues[NUM_GBUFFERS].depthStencil = { 1.0f, 0 };
+	clearValues[NUM_GBUFFERS].depthStencil = { 0.0f, 0 }; //reverse-Z, 0 is the far plane
 
-	vulkanApp->recordCommandBuffers(&gbufferCmd, gbufferCmdPool, &gbufferFramebuffers, "", gbufferRenderPass, swapChainExtent, &clearValues, 1, NULL, 0, 0, 0, 0, 0);
+	vulkanApp->recordCommandBuffers(&gbufferCmd, gbufferCmdPool, &gbufferFramebuffers, "", gbufferRenderPass, swapChainExtent, &clearValues, 1, NULL, 0, 0, 0, 0, 0, "gbuffer");
 }
 
 void Renderer::createFrustumCullingCommandPool()
 {
-	vulkanApp->createCommandPool(frustumCullingPool);
+	QueueFamilyIndices indices = vulkanApp->findQueueFamilies(vulkanApp->getPhysicalDevice(), vulkanApp->getSurface());
+
+	//frustumQueue is on the compute family
+	vulkanApp->createCommandPool(frustumCullingPool, indices.computeFamily);
 }
 
 void Renderer::createFrustumCullingCommandBuffers()
@@ -2010,6 +2892,28 @@ void Renderer::recordFrustumCullingCommandBuffers(int groupSizeX, int groupSizeY
 	vulkanApp->recordCommandBuffers(&frustumCmd, frustumCullingPool, NULL, "frustumCulling", NULL, swapChainExtent, NULL, 1, NULL, 0, 0, 500, 1, 1);
 }
 
+void Renderer::createLightCullingCommandPool()
+{
+	QueueFamilyIndices indices = vulkanApp->findQueueFamilies(vulkanApp->getPhysicalDevice(), vulkanApp->getSurface());
+
+	//lightCullingQueue is on the compute family
+	vulkanApp->createCommandPool(lightCullingPool, indices.computeFamily);
+}
+
+void Renderer::createLightCullingCommandBuffers()
+{
+	std::vector<VkFramebuffer> dummyFrameBuffer;
+	dummyFrameBuffer.resize(1);
+
+	vulkanApp->createCommandBuffers(VK_COMMAND_BUFFER_LEVEL_PRIMARY, dummyFrameBuffer, lightCullingCmd, lightCullingPool);
+}
+
+void Renderer::recordLightCullingCommandBuffers()
+{
+	//one workgroup per screen tile
+	vulkanApp->recordCommandBuffers(&lightCullingCmd, lightCullingPool, NULL, "lightCulling", NULL, swapChainExtent, NULL, 1, NULL, 0, 0, CLUSTER_X, CLUSTER_Y, 1, "lightCulling");
+}
+
 void Renderer::createGbufferRenderPass()
 {
 	std::vector<VkAttachmentReference> attachmentRefs = {};
@@ -2126,7 +3030,9 @@ void Renderer::createMainRenderPass()
 	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	//offscreen images are not presented, they are left ready to be copied out
+	attachments[0].finalLayout = interface.bHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	std::vector<VkSubpassDependency> dependencies = {};
 	dependencies.resize(1);
@@ -2149,7 +3055,7 @@ void Renderer::createDepthResources()
 		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SAMPLE_COUNT_1_BIT,  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthTexture->textureImage, depthTexture->textureImageMemory);
 	vulkanApp->createImageView(depthTexture->textureImage, VK_IMAGE_VIEW_TYPE_2D, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1, depthTexture->textureImageView);
 	
-	vulkanApp->transitionImageLayout(depthTexture->textureImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, gbufferCmdPool, vulkanApp->getTransferQueue());
+	vulkanApp->transitionImageLayout(depthTexture->textureImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
 	vulkanApp->createTextureSampler(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FALSE, 1, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE,
 		VK_SAMPLER_MIPMAP_MODE_NEAREST, 0.0f, 0.0f, 0.0f, depthTexture->textureSampler);
@@ -2163,7 +3069,7 @@ void Renderer::createDepthResources()
 
 	vulkanApp->createImageView(depthMipmapTexture->textureImage, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1, depthMipmapTexture->textureImageView);
 
-	vulkanApp->transitionImageLayout(depthMipmapTexture->textureImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, gbufferCmdPool, vulkanApp->getTransferQueue());
+	vulkanApp->transitionImageLayout(depthMipmapTexture->textureImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
 	vulkanApp->createTextureSampler(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FALSE, 1, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE,
 		VK_SAMPLER_MIPMAP_MODE_NEAREST, 0.0f, 0.0f, 0.0f, depthMipmapTexture->textureSampler);
@@ -2231,7 +3137,7 @@ void Renderer::createSSRDepthResources()
 		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_USAGE_STORAGE_BIT , VK_SAMPLE_COUNT_1_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, SSRDepthTexture->textureImage, SSRDepthTexture->textureImageMemory);
 	vulkanApp->createImageView(SSRDepthTexture->textureImage, VK_IMAGE_VIEW_TYPE_2D, VK_FORMAT_R32_UINT, VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1, SSRDepthTexture->textureImageView);
 
-	vulkanApp->transitionImageLayout(SSRDepthTexture->textureImage, VK_FORMAT_R32_UINT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, vulkanApp->getTransferCmdPool(), vulkanApp->getTransferQueue());
+	vulkanApp->transitionImageLayout(SSRDepthTexture->textureImage, VK_FORMAT_R32_UINT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
 
 	vulkanApp->createTextureSampler(VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_FALSE, 1, VK_BORDER_COLOR_INT_OPAQUE_BLACK, VK_FALSE,
 		VK_SAMPLER_MIPMAP_MODE_NEAREST, 0.0f, 0.0f, 0.0f, SSRDepthTexture->textureSampler);
@@ -2283,7 +3189,7 @@ void Renderer::recordMainCommandBuffers()
 	std::vector<VkClearValue> clearValues;
 	clearValues.resize(2);
 	clearValues[0].color = { 0.0f, 0.6f, 0.8f, 0.0f };
-	clearValues[1].depthStencil = { 1.0f, 0 };
+	clearValues[1].depthStencil = { 0.0f, 0 };
 
-	vulkanApp->recordCommandBuffers(&mainCmd, mainCmdPool, &swapChainFramebuffers, "present_mat", mainRenderPass, swapChainExtent, &clearValues, 0, singleTriangularVertexBuffer, 0, 3, 0, 0, 0);
+	vulkanApp->recordFullscreenCommandBuffers(&mainCmd, &swapChainFramebuffers, "present_mat", mainRenderPass, swapChainExtent, &clearValues);
 }
\ No newline at end of file
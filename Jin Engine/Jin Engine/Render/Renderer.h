@@ -5,12 +5,12 @@
 #include "../Actor/Object.h"
 #include "../Actor/Light.h"
 #include "../Core/Sky.h"
+#include "../Core/Benchmark.h"
+#include "../Core/GoldenTest.h"
 
-#include "PostProcess.h"
+#include "Postprocess.h"
 #include "../UI/GUI.h"
 
-static Time timer;
-
 enum RenderPassID
 {
 	GBUFFER = 0, MAIN
@@ -21,7 +21,7 @@ class Renderer
 public:
 
 	Renderer() :vulkanApp(NULL), layerCount(1), directionalLightUniformBuffer(NULL), directionalLightUniformMemory(NULL), pointLightUniformBuffer(NULL), pointLightUniformMemory(NULL),
-		perFrameBuffer(NULL), perFrameBufferMemory(NULL)// , screenSpaceNoise(NULL)
+		perFrameBuffer(NULL), perFrameBufferMemory(NULL), frameIndex(0), cloudInfoBuffer(NULL), cloudInfoBufferMem(NULL)// , screenSpaceNoise(NULL)
 	{
 		/*
 		if (screenSpaceNoise == NULL)
@@ -46,6 +46,14 @@ public:
 	void initialize(Vulkan* pVulkanApp);
 	void reInitializeRenderer();
 
+	//before initialize, renders into offscreen images instead of a window
+	void setHeadless(int width, int height)
+	{
+		interface.bHeadless = true;
+		interface.window_Width = width;
+		interface.window_Height = height;
+	}
+
 	void createSemaphore(VkSemaphore &semaphore)
 	{
 		VkSemaphoreCreateInfo semaphoreInfo = {};
@@ -61,6 +69,7 @@ public:
 	{
 		createSemaphore(gbufferSemaphore);
 		createSemaphore(pbrSemaphore);
+		createSemaphore(lightCullingSemaphore);
 		createSemaphore(guiSemaphore);
 		createSemaphore(presentSemaphore);
 	}
@@ -69,6 +78,7 @@ public:
 	{
 		vkDestroySemaphore(vulkanApp->getDevice(), gbufferSemaphore, nullptr);
 		vkDestroySemaphore(vulkanApp->getDevice(), pbrSemaphore, nullptr);
+		vkDestroySemaphore(vulkanApp->getDevice(), lightCullingSemaphore, nullptr);
 
 		vkDestroySemaphore(vulkanApp->getDevice(), guiSemaphore, nullptr);
 
@@ -84,6 +94,7 @@ public:
 		vkGetDeviceQueue(vulkanApp->getDevice(), indices.computeFamily, 0, &frustumQueue);
 		vkGetDeviceQueue(vulkanApp->getDevice(), indices.graphicsFamily, 0, &gbufferQueue);
 		vkGetDeviceQueue(vulkanApp->getDevice(), indices.graphicsFamily, 0, &pbrQueue);
+		vkGetDeviceQueue(vulkanApp->getDevice(), indices.computeFamily, 0, &lightCullingQueue);
 
 		vkGetDeviceQueue(vulkanApp->getDevice(), indices.graphicsFamily, 0, &guiQueue);		
 
@@ -93,10 +104,16 @@ public:
 
 	void createGbuffers();
 	void updateGbuffers();
+
+	//headless, the golden image test copies the G-buffers out
+	VkImageUsageFlags getGbufferUsage()
+	{
+		return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (interface.bHeadless ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+	}
+
 	void releaseGbuffers();
 	void deleteGbuffers();
 
-	void createSingleTriangularVertexBuffer();
 
 
 	void createGbufferRenderPass();
@@ -109,9 +126,17 @@ public:
 	void createFrustumCullingCommandBuffers();
 	void recordFrustumCullingCommandBuffers(int groupSizeX, int groupSizeY, int groupSizeZ);
 
+	void createLightCullingCommandPool();
+	void createLightCullingCommandBuffers();
+	void recordLightCullingCommandBuffers();
+
 	void createSwapChain();
 	void createSwapChainImageViews();
 
+	//headless, stand-ins for the swapchain images that the main pass leaves ready to be copied out
+	void createOffscreenImages();
+	void releaseOffscreenImages();
+
 	void createDepthResources();
 	void releaseDepthResources();
 	void shutdownDepthResources();
@@ -144,7 +169,7 @@ public:
 		clearValues[0].color = { 0.0f, 0.0f, 0.0f, 0.0f };
 		//clearValues[1].depthStencil = { 1.0f, 0 };
 
-		vulkanApp->recordCommandBuffers(&guiCmd, guiCmdPool, &guiFramebuffers, "NEEDTOFIX", gui.init_data.render_pass, swapChainExtent, &clearValues, 0, singleTriangularVertexBuffer, 0, 3, 0, 0, 0);
+		vulkanApp->recordFullscreenCommandBuffers(&guiCmd, &guiFramebuffers, "NEEDTOFIX", gui.init_data.render_pass, swapChainExtent, &clearValues);
 	}
 	*/
 
@@ -164,14 +189,24 @@ public:
 
 	void mainloop();
 
-	void updateUniformBuffers(unsigned int deltaTime)
-	{
-		//mainCamera.updateCameraBuffer();
-	}
+	//headless, moves the camera along the benchmark path with a fixed time step and measures every frame after the warmup
+	void runBenchmark(Benchmark &benchmark);
 
-	void draw(unsigned int deltaTime);
+	//headless, renders every pose of the test until it has settled and captures or compares the G-buffers, the post process targets and the final image
+	void runGoldenTest(GoldenTest &goldenTest);
+
+	//culling, streaming requests and the per frame buffers for the current camera, and the streamed textures that have landed
+	void updateFrame();
+
+	//one fixed step of the camera, from the input since the last step
+	void updateSimulation(double stepTime, double simulationTime);
+
+	void draw();
 	void shutDown();
 
+	//fork semaphores of the async compute passes that directly follow chain position first
+	void collectForkSemaphores(size_t first, std::vector<VkSemaphore> &signalSMs);
+
 	void createPointLightBuffer();
 	void updatePointLightBuffer();
 
@@ -184,11 +219,29 @@ public:
 	void createSSRInfoBuffer();
 	void updateSSRInfoBuffer();
 
+	void addReflectivePlane(glm::vec4 centerPoint, glm::vec4 size, glm::mat4 rotMat);
+	void createPlaneInfoBuffer();
+	void updatePlaneInfoBuffer();
+
+	void createCloudInfoBuffer();
+	void updateCloudInfoBuffer();
+
+	void createExposureBuffers();
+	void updateExposureSettingBuffer();
+
+	void createBloomInfoBuffer();
+	void updateBloomInfoBuffer();
+
 	void createPerFrameBuffer();
 	void updatePerFrameBuffer();
 
+	void updateClusterInfoBuffer();
+
 	void culling();
 
+	//asks the texture streamer for the mips the visible geometries need at their screen size
+	void updateTextureStreaming();
+
 	Camera mainCamera;
 	
 
@@ -201,6 +254,8 @@ private:
 
 	Interface interface;
 
+	Time timer;
+
 	/*
 	GUI gui;
 	std::vector<Texture*> guiCanvas;
@@ -217,6 +272,10 @@ private:
 	std::vector<VkImageView> swapChainImageViews;
 	std::vector<VkFramebuffer> swapChainFramebuffers;
 
+	std::vector<VkDeviceMemory> offscreenImageMemories; //headless, backs swapChainImages
+
+	CameraPath recordedCameraPath;
+
 	Texture *depthTexture;
 	
 	/*
@@ -243,27 +302,31 @@ private:
 	VkCommandPool frustumCullingPool;
 	std::vector<VkCommandBuffer> frustumCmd;
 
+	VkCommandPool lightCullingPool;
+	std::vector<VkCommandBuffer> lightCullingCmd;
+
 	VkRenderPass mainRenderPass;
 	VkCommandPool mainCmdPool;
 	std::vector<VkCommandBuffer> mainCmd;
 
-	VkBuffer singleTriangularVertexBuffer;
-	VkDeviceMemory singleTriangularVertexMemory;
 
 	
 
 	VkSemaphore gbufferSemaphore;
 	VkSemaphore pbrSemaphore;	
+	VkSemaphore lightCullingSemaphore;
 	VkSemaphore guiSemaphore;
 	VkSemaphore presentSemaphore;
 	
 	VkQueue frustumQueue;
 	VkQueue gbufferQueue;
 	VkQueue pbrQueue;
+	VkQueue lightCullingQueue;
 	VkQueue guiQueue;
 	VkQueue presentQueue;
 
 	FrustumCullingMaterial* pfrustumCullingMaterial;
+	LightCullingMaterial* pLightCullingMaterial;
 
 	std::vector<DirectionalLight*> directionalLights;
 	std::vector<LightInfo> directionalLightInfo;
@@ -287,11 +350,31 @@ private:
 
 	VkBuffer perFrameBuffer;
 	VkDeviceMemory perFrameBufferMemory;
+	unsigned int frameIndex;
 
 	//glm::vec4 *screenSpaceNoise;
 
 	VkBuffer SSRInfoBuffer;
 	VkDeviceMemory SSRInfoBufferMem;
 
+	//every reflective plane of the scene, only the ones in the view frustum reach planeInfoBuffer
+	std::vector<PlaneInfo> reflectivePlanes;
+
+	VkBuffer planeInfoBuffer;
+	VkDeviceMemory planeInfoBufferMem;
+
+	VkBuffer cloudInfoBuffer;
+	VkDeviceMemory cloudInfoBufferMem;
+
+	//luminance histogram and adapted exposure, filled and consumed on the GPU without readback
+	VkBuffer exposureBuffer;
+	VkDeviceMemory exposureBufferMem;
+
+	VkBuffer exposureSettingBuffer;
+	VkDeviceMemory exposureSettingBufferMem;
+
+	VkBuffer bloomInfoBuffer;
+	VkDeviceMemory bloomInfoBufferMem;
+
 	std::vector<PostProcess*> postProcessChain;
 };
\ No newline at end of file
@@ -9,11 +9,18 @@ layout(binding = 3) uniform sampler2D normalMap;
 
 layout(binding = 4) uniform sampler2D depthTexture;
 
-#define MAX_PLANES 4
+#define DEPTH_MIP_SIZE 8
+
+#define NEAR_PLANE 0.1
+#define FAR_PLANE 1000.0
+#define INFINITE_FAR_PLANE 1 //must match Camera.h
+
+#define MIN_HIT_DISTANCE 0.001 //alpha is the hit distance, it stays above 0 on reflective texels to keep the SSR mask
 
 layout(set = 0, binding = 5) uniform SSRInfoBuffer
 {
 	vec4 SSRInfo; //x : global Roughness, y : Intensity, z : bUseNormalmap, w : holePatching
+	vec4 SSRTraceInfo; //x : bUseHiZ, y : max Hi-Z iterations, z : thickness, w : reflection resolution divisor
 };
 
 
@@ -35,25 +42,129 @@ struct PlaneInfo
 	vec4 size;
 };
 
-layout(set = 0, binding = 7) uniform planeInfoBuffer
+//visible planes only, culled on the CPU every frame
+layout(std430, set = 0, binding = 7) readonly buffer planeInfoBuffer
 {	
-	PlaneInfo planeInfo[MAX_PLANES];
 	uint numPlanes;
 	uint pad00;
 	uint pad01;
 	uint pad02;
+	PlaneInfo planeInfo[];
 };
 
+//level 0 is the depth buffer, each following level holds the nearest, so the max reverse-Z depth of 2x2 texels
+layout(binding = 8) uniform sampler2D hiZMap[DEPTH_MIP_SIZE];
+
+//index + 1 of the plane under each pixel, 0 if there is none
+layout(binding = 9) uniform usampler2D planeIDMap;
+
 layout(location = 0) in vec2 fragUV;
 layout(location = 0) out vec4 outColor;
 
 
 
+//reverse-Z, 1 on the near plane and 0 on the far plane or at infinity
+float linearEyeDepth(float depth)
+{
+#if INFINITE_FAR_PLANE
+	return NEAR_PLANE / max(depth, 1e-7);
+#else
+	return NEAR_PLANE * FAR_PLANE / (NEAR_PLANE + depth * (FAR_PLANE - NEAR_PLANE));
+#endif
+}
+
+//eye depth relative to FAR_PLANE, only its differences and ratios are used
 float depthLinear(float depth)
-{	
-	float f = 1000.0;
-	float n = 0.1;
-	return (2.0 * n) / (f + n - depth * (f - n));
+{
+	return linearEyeDepth(depth) / FAR_PLANE;
+}
+
+//sampler arrays are only indexed with constants, the level differs per pixel
+#define HIZ_LEVEL(i) case i: return vec3(vec2(textureSize(hiZMap[i], 0)), texelFetch(hiZMap[i], min(ivec2(uv * vec2(textureSize(hiZMap[i], 0))), textureSize(hiZMap[i], 0) - ivec2(1)), 0).x);
+
+//xy : size of the level, z : nearest depth of the cell containing uv
+vec3 getHiZCell(int level, vec2 uv)
+{
+	switch(level)
+	{
+		HIZ_LEVEL(0)
+		HIZ_LEVEL(1)
+		HIZ_LEVEL(2)
+		HIZ_LEVEL(3)
+		HIZ_LEVEL(4)
+		HIZ_LEVEL(5)
+		HIZ_LEVEL(6)
+		default: HIZ_LEVEL(7)
+	}
+}
+
+//t along the ray where it leaves the current cell, nudged slightly into the next one
+float getCellExit(vec3 origin, vec3 direction, vec3 rayPos, vec2 levelSize)
+{
+	vec2 dirSign = mix(vec2(-1.0), vec2(1.0), greaterThanEqual(direction.xy, vec2(0.0)));
+	vec2 safeDirection = dirSign * max(abs(direction.xy), vec2(1e-6));
+
+	vec2 cell = floor(rayPos.xy * levelSize);
+	vec2 boundary = (cell + max(dirSign, vec2(0.0))) / levelSize;
+	vec2 tBoundary = (boundary - origin.xy) / safeDirection;
+
+	float cellEpsilon = 0.01 / max(max(levelSize.x * abs(direction.x), levelSize.y * abs(direction.y)), 1e-6);
+	return min(tBoundary.x, tBoundary.y) + cellEpsilon;
+}
+
+//ray is origin + direction * t in (uv, depth) space, t in [0, 1]
+//empty cells are skipped at coarse levels and refined down to level 0 near an intersection
+bool traceHiZ(vec3 origin, vec3 direction, int maxIterations, float thickness, out vec3 hitPoint, out float hitT)
+{
+	int level = 0;
+
+	//leave the starting texel so the surface does not hit itself
+	float t = getCellExit(origin, direction, origin, getHiZCell(0, origin.xy).xy);
+
+	for(int i = 0; i < maxIterations; i++)
+	{
+		vec3 rayPos = origin + direction * t;
+
+		if(t > 1.0 || rayPos.x < 0.0 || rayPos.x > 1.0 || rayPos.y < 0.0 || rayPos.y > 1.0 || rayPos.z <= 0.0)
+			return false;
+
+		vec3 hiZCell = getHiZCell(level, rayPos.xy);
+		float tExit = getCellExit(origin, direction, rayPos, hiZCell.xy);
+
+		if(rayPos.z > hiZCell.z)
+		{
+			//in front of everything in this cell, either reach its nearest depth or cross it
+			float tDepth = direction.z < 0.0 ? (hiZCell.z - origin.z) / direction.z : 2.0;
+
+			if(tDepth < tExit)
+			{
+				t = max(tDepth, t);
+				level = max(level - 1, 0);
+			}
+			else
+			{
+				t = tExit;
+				level = min(level + 1, DEPTH_MIP_SIZE - 1);
+			}
+		}
+		else if(level > 0)
+		{
+			level--;
+		}
+		else if(linearEyeDepth(rayPos.z) - linearEyeDepth(hiZCell.z) < thickness)
+		{
+			hitPoint = rayPos;
+			hitT = t;
+			return true;
+		}
+		else
+		{
+			//passed behind a thin object
+			t = tExit;
+		}
+	}
+
+	return false;
 }
 
 vec4 getWorldPosition(vec2 UV, float depth)
@@ -80,7 +191,9 @@ float getDistance(vec3 planeNormal, vec3 planeCenter, vec3 worldPos)
 
 vec3 getNormalVector(vec2 surfaceUV)
 {
-	return normalize( texture(normalMap, surfaceUV).xyz * 2.0 - vec3(1.0) );
+	//BC5 normal maps only store XY
+	vec2 normalXY = texture(normalMap, surfaceUV).xy * 2.0 - vec2(1.0);
+	return normalize( vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0))) );
 }
 
 bool intersectPlane(in uint index, in vec3 worldPos, in vec2 fragUV, out vec3 normalVec, out vec4 hitPos, out vec2 relfectedUVonPlanar, bool bUseNormalMap) 
@@ -139,7 +252,7 @@ bool intersectPlane(in uint index, in vec3 worldPos, in vec2 fragUV, out vec3 no
 
 			float depth = texture(depthTexture, reflectedPos.xy).x;	
 
-			if(depth <= reflectedPos.z)
+			if(depth >= reflectedPos.z)
 				return false;
 			
 			if( reflectedPos.x < 0.0 || reflectedPos.y < 0.0  || reflectedPos.x > 1.0 || reflectedPos.y > 1.0 )
@@ -174,7 +287,7 @@ void main()
 {	
 	float depth = texture(depthTexture, fragUV).r;
 	
-	if(depth >= 1.0)
+	if(depth <= 0.0)
 	{
 		outColor = vec4(0.0, 0.0, 0.0, 0.0);
 		return;
@@ -195,6 +308,7 @@ void main()
 
 	bool bHit = false;
 	float fadeFactor = 0.0;
+	float hitDistance = 0.0;
 
 	//float maxStep = 2048.0;
 	//float stepSize = 0.1;
@@ -207,34 +321,18 @@ void main()
 	bool bIsInterect = false;
 	bool bUseInterpolation = SSRInfo.w > 0.5 ? true : false;
 
-	uint relfectedPlanarIndex;
 	vec4 hitpoint;
 	vec2 UVforNormalMap;
 	vec3 WorldNormal;
 
 	bool bUseNormalMap = SSRInfo.z > 0.5 ? true : false;
 
-	for(uint i = 0; i < numPlanes; i++)
-	{	
-		if(!intersectPlane( i, worldPos.xyz, fragUV, WorldNormal, hitpoint, UVforNormalMap, bUseNormalMap))
-		{
-			//continue;			
-		}
-		else
-		{
-			bIsInterect = true;
-			break;
-			/*
-			float localDist =  distance(hitpoint, cameraWorldPos.xyz);
-			
-			if( localDist <  minDist )
-			{
-				minDist = localDist;
-			}
-			*/
-		}
+	//only the plane under this pixel is evaluated
+	uint planeID = texelFetch(planeIDMap, ivec2(fragUV * vec2(textureSize(planeIDMap, 0))), 0).x;
 
-		relfectedPlanarIndex = i;
+	if(planeID > 0 && intersectPlane( planeID - 1, worldPos.xyz, fragUV, WorldNormal, hitpoint, UVforNormalMap, bUseNormalMap))
+	{
+		bIsInterect = true;
 	}
 
 	//bIsInterect = true;
@@ -257,131 +355,163 @@ void main()
 	vec3 relfectVec = reflect(viewVec , WorldNormal);
 
 
-	//rayMarching
-	for(float i = 0.0; i < maxStep; i++ )
-	{			
-		currentPos += relfectVec * stepSize;
+	if(SSRTraceInfo.x > 0.5)
+	{
+		//clip the ray against the near plane before projecting its end point
+		vec3 viewOrigin = (viewMat * vec4(worldPos.xyz, 1.0)).xyz;
+		vec3 viewDirection = mat3(viewMat) * relfectVec;
 
-		vec4 pos_SS = viewProjMat * vec4(currentPos, 1.0);
-		pos_SS /= pos_SS.w;
-		vec2 screenSpaceCoords = vec2((pos_SS.x + 1.0) * 0.5, (pos_SS.y + 1.0 )*0.5);
+		float rayLength = maxStep * stepSize;
 
-		
+		if(viewOrigin.z + viewDirection.z * rayLength > -NEAR_PLANE)
+			rayLength = (-NEAR_PLANE - viewOrigin.z) / viewDirection.z * 0.99;
 
-		if(screenSpaceCoords.x > 1.0 || screenSpaceCoords.x < 0.0 || screenSpaceCoords.y > 1.0 || screenSpaceCoords.y < 0.0 || pos_SS.z >= 1.0)
-		{
-			fadeFactor = 0.0;
-			//bHit = true;
+		vec4 rayEnd_SS = viewProjMat * vec4(worldPos.xyz + relfectVec * rayLength, 1.0);
+		rayEnd_SS /= rayEnd_SS.w;
+
+		vec3 rayOrigin = vec3(fragUV, depth);
+		vec3 rayDirection = vec3((rayEnd_SS.xy + vec2(1.0)) * 0.5, rayEnd_SS.z) - rayOrigin;
 
-			//outColor = vec4(0.0, 1.0, 0.0, 0.0);
-			//return;
-			break;
+		vec3 hitPoint;
+		float hitT;
+
+		if(traceHiZ(rayOrigin, rayDirection, int(SSRTraceInfo.y), SSRTraceInfo.z, hitPoint, hitT))
+		{
+			reflectionColor = texture(SceneTexture, hitPoint.xy);
+			fadeFactor = pow(1.0 - hitT, 0.05);
+			hitDistance = distance(getWorldPosition(hitPoint.xy, hitPoint.z).xyz, worldPos.xyz);
+			bHit = true;
 		}
+	}
+	else
+	{
+		//rayMarching
+		for(float i = 0.0; i < maxStep; i++ )
+		{			
+			currentPos += relfectVec * stepSize;
+
+			vec4 pos_SS = viewProjMat * vec4(currentPos, 1.0);
+			pos_SS /= pos_SS.w;
+			vec2 screenSpaceCoords = vec2((pos_SS.x + 1.0) * 0.5, (pos_SS.y + 1.0 )*0.5);
+
 		
-		float depth_SS = texture(depthTexture, screenSpaceCoords).r;
 
+			if(screenSpaceCoords.x > 1.0 || screenSpaceCoords.x < 0.0 || screenSpaceCoords.y > 1.0 || screenSpaceCoords.y < 0.0 || pos_SS.z <= 0.0)
+			{
+				fadeFactor = 0.0;
+				//bHit = true;
+
+				//outColor = vec4(0.0, 1.0, 0.0, 0.0);
+				//return;
+				break;
+			}
 		
+			float depth_SS = texture(depthTexture, screenSpaceCoords).r;
 
 		
-		if(pos_SS.z > depth_SS)
-		{				
-			float currentLinearDepth = depthLinear(depth_SS);
-			vec4 cworldPos = getWorldPosition( screenSpaceCoords, depth_SS);
 
+		
+			if(pos_SS.z < depth_SS)
+			{				
+				float currentLinearDepth = depthLinear(depth_SS);
+				vec4 cworldPos = getWorldPosition( screenSpaceCoords, depth_SS);
 
-			float currentIndicatedLinearDepth = depthLinear(pos_SS.z);
 
-			if( distance(cworldPos.xyz, currentPos) < stepSize * threshold)
-			{
+				float currentIndicatedLinearDepth = depthLinear(pos_SS.z);
+
+				if( distance(cworldPos.xyz, currentPos) < stepSize * threshold)
+				{
 				
 
-				float prevIndicatedLinearDepth = depthLinear(prevDepth);
-				float prevLinearDepth = depthLinear(prevDepthFromDepthBuffer);
+					float prevIndicatedLinearDepth = depthLinear(prevDepth);
+					float prevLinearDepth = depthLinear(prevDepthFromDepthBuffer);
 				
-				float denom = ( (currentLinearDepth - prevLinearDepth) - (currentIndicatedLinearDepth - prevIndicatedLinearDepth) );
+					float denom = ( (currentLinearDepth - prevLinearDepth) - (currentIndicatedLinearDepth - prevIndicatedLinearDepth) );
 
-				if(denom == 0.0)
-				{
-					reflectionColor = vec4(0.0, 0.0, 0.0, 0.0);
+					if(denom == 0.0)
+					{
+						reflectionColor = vec4(0.0, 0.0, 0.0, 0.0);
 
-					fadeFactor = 0.0;
-					bHit = true;
-					//outColor = vec4(1.0, 0.0, 0.0, 0.0);
-					//return;
-					break;
-				}
+						fadeFactor = 0.0;
+						bHit = true;
+						//outColor = vec4(1.0, 0.0, 0.0, 0.0);
+						//return;
+						break;
+					}
 
-				float lerpVal = (prevIndicatedLinearDepth - prevLinearDepth) / denom;
+					float lerpVal = (prevIndicatedLinearDepth - prevLinearDepth) / denom;
 				
 
-				//exception
-				if(i < 0.5)
-					lerpVal = 1.0;
+					//exception
+					if(i < 0.5)
+						lerpVal = 1.0;
 
-				vec3 lerpedPos;
+					vec3 lerpedPos;
 
-				if(bUseInterpolation)
-				{
-					lerpedPos = prevPos + relfectVec * stepSize * lerpVal;
-				}
-				else
-				{
-					lerpedPos = currentPos;
-				}
+					if(bUseInterpolation)
+					{
+						lerpedPos = prevPos + relfectVec * stepSize * lerpVal;
+					}
+					else
+					{
+						lerpedPos = currentPos;
+					}
 
-				//lerpedPos = prevPos.xyz;
+					//lerpedPos = prevPos.xyz;
 
-				vec4 lerpedPos_SS =  viewProjMat * vec4(lerpedPos, 1.0);
-				lerpedPos_SS /= lerpedPos_SS.w;
+					vec4 lerpedPos_SS =  viewProjMat * vec4(lerpedPos, 1.0);
+					lerpedPos_SS /= lerpedPos_SS.w;
 				
-				vec2 lerpedScreenSpaceCoords = vec2((lerpedPos_SS.x + 1.0) * 0.5, (lerpedPos_SS.y + 1.0) * 0.5);
-
-				//out of screen
-				if(lerpedScreenSpaceCoords.x > 1.0 || lerpedScreenSpaceCoords.x < 0.0 || lerpedScreenSpaceCoords.y > 1.0 || lerpedScreenSpaceCoords.y < 0.0 || lerpedPos_SS.z >= 1.0)
-				{
-					reflectionColor = vec4(0.0, 0.0, 0.0, 0.0);
-
-					fadeFactor = 0.0;
+					vec2 lerpedScreenSpaceCoords = vec2((lerpedPos_SS.x + 1.0) * 0.5, (lerpedPos_SS.y + 1.0) * 0.5);
+
+					//out of screen
+					if(lerpedScreenSpaceCoords.x > 1.0 || lerpedScreenSpaceCoords.x < 0.0 || lerpedScreenSpaceCoords.y > 1.0 || lerpedScreenSpaceCoords.y < 0.0 || lerpedPos_SS.z <= 0.0)
+					{
+						reflectionColor = vec4(0.0, 0.0, 0.0, 0.0);
+
+						fadeFactor = 0.0;
+						bHit = true;
+						//outColor = vec4(0.0, 0.0, 1.0, 0.0);
+						//return;
+						break;
+					}
+
+					//reflection with backface
+					/*
+					if( dot(relfectVec, texture(u_Gbuffer_Specular, lerpedScreenSpaceCoords).xyz) > 0.0 || dot(relfectVec, -viewVec ) > 0.0 )
+					{					
+
+						reflectionColor = vec4(0.0, 0.0, 0.0, 0.0);
+
+						fadeFactor = 0.0;
+						bHit = true;
+						break;
+					}
+					*/
+					reflectionColor = texture(SceneTexture, lerpedScreenSpaceCoords);
+
+					fadeFactor = 1.0;// fade(lerpedScreenSpaceCoords);
+					fadeFactor = min(pow(1.0 -  (i + 1.0)/maxStep, 0.05), fadeFactor);
+					hitDistance = distance(lerpedPos, worldPos.xyz);
 					bHit = true;
-					//outColor = vec4(0.0, 0.0, 1.0, 0.0);
-					//return;
+
 					break;
 				}
-
-				//reflection with backface
 				/*
-				if( dot(relfectVec, texture(u_Gbuffer_Specular, lerpedScreenSpaceCoords).xyz) > 0.0 || dot(relfectVec, -viewVec ) > 0.0 )
-				{					
-
-					reflectionColor = vec4(0.0, 0.0, 0.0, 0.0);
-
+				else
+				{
 					fadeFactor = 0.0;
 					bHit = true;
 					break;
 				}
 				*/
-				reflectionColor = texture(SceneTexture, lerpedScreenSpaceCoords);
-
-				fadeFactor = 1.0;// fade(lerpedScreenSpaceCoords);
-				fadeFactor = min(pow(1.0 -  (i + 1.0)/maxStep, 0.05), fadeFactor);
-				bHit = true;
-
-				break;
 			}
-			/*
-			else
-			{
-				fadeFactor = 0.0;
-				bHit = true;
-				break;
-			}
-			*/
-		}
 
-		prevDepthFromDepthBuffer = depth_SS;
-		prevDepth = pos_SS.z;
-		prevPos = currentPos;
+			prevDepthFromDepthBuffer = depth_SS;
+			prevDepth = pos_SS.z;
+			prevPos = currentPos;
 
+		}
 	}
  	
 
@@ -396,6 +526,6 @@ void main()
 	outColor.xyz = mix(vec3(0.0), outColor.xyz, fadeFactor);
 	outColor = clamp(outColor, 0.0, 1.0);
 
-	outColor.w = 1.0; //SSR_Mask
+	outColor.w = max(hitDistance, MIN_HIT_DISTANCE); //SSR_Mask, the temporal resolve reprojects the hit with it
 	
 }
@@ -1,8 +1,6 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-#define MAX_PLANES 4
-
 #define UINT_MAX 4294967295
 #define FLT_MAX  3.402823466e+38F
 
@@ -28,13 +26,14 @@ struct PlaneInfo
 	vec4 size;
 };
 
-layout(set = 0, binding = 4) uniform planeInfoBuffer
+//visible planes only, culled on the CPU every frame
+layout(std430, set = 0, binding = 4) readonly buffer planeInfoBuffer
 {	
-	PlaneInfo planeInfo[MAX_PLANES];
 	uint numPlanes;
 	uint pad00;
 	uint pad01;
 	uint pad02;
+	PlaneInfo planeInfo[];
 };
 
 float getDistance(vec3 planeNormal, vec3 planeCenter, vec3 worldPos)
@@ -109,7 +108,7 @@ bool intersectPlane(in uint index, in vec3 worldPos, in vec2 fragUV, out vec4 re
 
 			float depth = texture(depthMap, reflectedPos.xy).x;	
 
-			if(depth <= reflectedPos.z)
+			if(depth >= reflectedPos.z)
 				return false;
 			
 			if( reflectedPos.x < 0.0 || reflectedPos.y < 0.0  || reflectedPos.x > 1.0 || reflectedPos.y > 1.0 )
@@ -224,7 +223,7 @@ void main() {
 	float depth = texture(depthMap, fragUV).x;	
 
 	//if there is no obj
-	if(depth >= 1.0)
+	if(depth <= 0.0)
 		return;
 
 	vec4 worldPos = getWorldPosition(fragUV, depth);
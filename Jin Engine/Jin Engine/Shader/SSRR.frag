@@ -3,12 +3,14 @@
 
 #define UINT_MAX 4294967295
 #define FLT_MAX  3.402823466e+38F
-#define MAX_PLANES 4
+#define HOLE_HIT_DISTANCE 65504.0 //largest half float, marks texels the projection missed, must match holePatching.comp
+#define MIN_HIT_DISTANCE 0.001 //alpha is the hit distance, it stays above 0 on reflective texels to keep the SSR mask
 
 #define MAX_SCREEN_WIDTH 1920
 #define MAX_SCREEN_HEIGHT 1080
 
 #define NUM_SAMPLE 4
+#define NUM_TEMPORAL_SAMPLE 1 //samples per frame when the temporal resolve accumulates the rest
 
 #define PI 3.1415926535897932384626422832795028841971
 #define RADIAN 0.01745329251994329576923690768489
@@ -28,18 +30,21 @@ struct PlaneInfo
 	vec4 size;
 };
 
-layout(set = 0, binding = 7) uniform planeInfoBuffer
+//visible planes only, culled on the CPU every frame
+layout(std430, set = 0, binding = 7) readonly buffer planeInfoBuffer
 {	
-	PlaneInfo planeInfo[MAX_PLANES];
 	uint numPlanes;
 	uint pad00;
 	uint pad01;
 	uint pad02;
+	PlaneInfo planeInfo[];
 };
 
 layout(set = 0, binding = 8) uniform SSRInfoBuffer
 {
 	vec4 SSRInfo; //x : global Roughness, y : Intensity, z : bUseNormalmap, w : holePatching
+	vec4 SSRTraceInfo; //x : bUseHiZ, y : max Hi-Z iterations, z : thickness, w : reflection resolution divisor
+	vec4 SSRTemporalInfo; //x : bUseTemporal, y : current frame weight, z : frame index
 };
 
 layout(set = 0, binding = 9) uniform cameraBuffer
@@ -53,6 +58,9 @@ layout(set = 0, binding = 9) uniform cameraBuffer
 	vec4 viewPortSize;
 };
 
+//index + 1 of the plane under each pixel, 0 if there is none
+layout(binding = 10) uniform usampler2D planeIDMap;
+
 layout(location = 0) in vec2 fragUV;
 
 mat2 rotationMat2(float angle)
@@ -141,7 +149,7 @@ bool intersectPlane(in uint index, in vec3 worldPos, in vec2 fragUV, out vec4 hi
 
 			float depth = texture(depthMap, reflectedPos.xy).x;	
 
-			if(depth <= reflectedPos.z)
+			if(depth >= reflectedPos.z)
 				return false;
 			
 			if( reflectedPos.x < 0.0 || reflectedPos.y < 0.0  || reflectedPos.x > 1.0 || reflectedPos.y > 1.0 )
@@ -169,7 +177,9 @@ bool intersectPlane(in uint index, in vec3 worldPos, in vec2 fragUV, out vec4 hi
 
 vec3 getNormalVector(vec2 surfaceUV)
 {
-	return normalize( texture(normalMap, surfaceUV).xyz * 2.0 - vec3(1.0) );
+	//BC5 normal maps only store XY
+	vec2 normalXY = texture(normalMap, surfaceUV).xy * 2.0 - vec2(1.0);
+	return normalize( vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0))) );
 }
 
 vec3 GGXDistribution_Sample_wh(vec2 xi, float roughness)
@@ -291,7 +301,7 @@ vec4 unPacked(in uint unpacedInfo, in vec2 dividedViewSize, out uint CoordSys)
 }
 
 
-vec4 getColorwithNormal(vec3 worldPos, vec3 normalVec, float globalRoughness, vec3 reflectedWorldPos, mat3 rotMat, vec2 samples[NUM_SAMPLE])
+vec4 getColorwithNormal(vec3 worldPos, vec3 normalVec, float globalRoughness, vec3 reflectedWorldPos, mat3 rotMat, vec2 samples[NUM_SAMPLE], int numSamples)
 {
 	
 #if NUM_SAMPLE 
@@ -300,13 +310,13 @@ vec4 getColorwithNormal(vec3 worldPos, vec3 normalVec, float globalRoughness, ve
 			int validSampleCounter = 0;
 
 			
-			for(int i=0; i < NUM_SAMPLE; i++)
+			for(int i=0; i < numSamples; i++)
 			{
 				vec4 reflectedColor = getColorwithNormalMap(worldPos.xyz, normalVec, globalRoughness, reflectedWorldPos.xyz, rotMat, samples[i]);	
 				getColor += clamp(reflectedColor, 0.0, 1.0);				
 			}
 			
-			return getColor / float(NUM_SAMPLE);
+			return getColor / float(numSamples);
 #else			
 			return getColorwithNormalMap(worldPos.xyz, normalVec, globalRoughness, reflectedWorldPos.xyz, rotMat, samples[0]);
 			
@@ -322,7 +332,7 @@ float fade(vec2 UV)
 }
 
 
-vec4 fetchColor(vec2 relfectedUV, vec2 UVforNormalMap, vec3 HitPos_WS, float Roughness, mat3 rotMat, vec2 samples[NUM_SAMPLE], bool bUseNormal)
+vec4 fetchColor(vec2 relfectedUV, vec2 UVforNormalMap, vec3 HitPos_WS, float Roughness, mat3 rotMat, vec2 samples[NUM_SAMPLE], int numSamples, bool bUseNormal)
 {
 	float reflectedDepth = texture(depthMap, relfectedUV).x;
 	vec4 reflectedWorldPos = getWorldPosition(relfectedUV, reflectedDepth);
@@ -331,7 +341,7 @@ vec4 fetchColor(vec2 relfectedUV, vec2 UVforNormalMap, vec3 HitPos_WS, float Rou
 	if(bUseNormal)
 	{
 		normalVec = getNormalVector(UVforNormalMap);
-		return getColorwithNormal(HitPos_WS, normalVec, Roughness, reflectedWorldPos.xyz, rotMat, samples);
+		return getColorwithNormal(HitPos_WS, normalVec, Roughness, reflectedWorldPos.xyz, rotMat, samples, numSamples);
 	}
 	else
 	{
@@ -339,7 +349,7 @@ vec4 fetchColor(vec2 relfectedUV, vec2 UVforNormalMap, vec3 HitPos_WS, float Rou
 		
 
 		normalVec = vec3(0.0, 0.0, 1.0);
-		return getColorwithNormal(HitPos_WS, normalVec, Roughness, reflectedWorldPos.xyz, rotMat, samples);
+		return getColorwithNormal(HitPos_WS, normalVec, Roughness, reflectedWorldPos.xyz, rotMat, samples, numSamples);
 	}
 	
 }
@@ -351,9 +361,29 @@ void main()
 {
 	outColor =  vec4(0.0);
 
-	ivec2 iUV = ivec2(fragUV.x * viewPortSize.x, fragUV.y * viewPortSize.y);
-	
-	uint bufferInfo = imageAtomicAdd(IntermediateBuffer, iUV, 0);
+	//the hash stays at full resolution, resolve the nearest entry over this texel's footprint and clear it
+	int downsample = max(int(SSRTraceInfo.w), 1);
+	ivec2 hashSize = imageSize(IntermediateBuffer);
+	ivec2 lowCoord = ivec2(gl_FragCoord.xy);
+
+	ivec2 footprintStart = lowCoord * downsample;
+	ivec2 footprintEnd = footprintStart + ivec2(downsample);
+
+	//the last row and column also own the pixels left over by the integer division
+	if(lowCoord.x == hashSize.x / downsample - 1)
+		footprintEnd.x = hashSize.x;
+	if(lowCoord.y == hashSize.y / downsample - 1)
+		footprintEnd.y = hashSize.y;
+
+	uint bufferInfo = UINT_MAX;
+
+	for(int y = footprintStart.y; y < footprintEnd.y; y++)
+	{
+		for(int x = footprintStart.x; x < footprintEnd.x; x++)
+		{
+			bufferInfo = min(bufferInfo, imageAtomicExchange(IntermediateBuffer, ivec2(x, y), UINT_MAX));
+		}
+	}
 
 	bool bIsInterect = false;
 
@@ -379,25 +409,17 @@ void main()
 	vec4 worldPos = getWorldPosition(fragUV, depth);
 
 	vec4 HitPos_WS;
-	vec2 UVforNormalMap;
+	vec2 UVforNormalMap = vec2(0.0);
 
 	
 	bool bUseNormal = false;// SSRInfo.z > 0.5 ? true : false;
 
-	//if(bUseNormal)
+	//only the plane under this pixel is evaluated
+	uint planeID = texelFetch(planeIDMap, ivec2(fragUV * vec2(textureSize(planeIDMap, 0))), 0).x;
+
+	if(planeID > 0 && intersectPlane( planeID - 1, worldPos.xyz, fragUV, HitPos_WS, UVforNormalMap))
 	{
-		for(uint i = 0; i < numPlanes; i++)
-		{	
-			if(intersectPlane( i, worldPos.xyz, fragUV, HitPos_WS, UVforNormalMap))
-			{
-				bIsInterect = true;
-				break;		
-			}
-			else
-			{
-				UVforNormalMap = vec2(0.0);
-			}
-		}
+		bIsInterect = true;
 	}
 	
 
@@ -407,15 +429,18 @@ void main()
 	//If is not in the boundary of planar, exit
 	if(!bIsInterect)
 	{
-		//clear IntermediateBuffer
-		imageAtomicMax(IntermediateBuffer, iUV, UINT_MAX);
 		return;
 	}
 
 	
 	
 
-	vec4 noiseColor = texture(NoiseMap, (viewPortSize.xy / vec2(1024.0)) * fragUV);
+	//with temporal accumulation the noise moves every frame, so fewer samples are needed per frame
+	bool bUseTemporal = SSRTemporalInfo.x > 0.5;
+	int numSamples = bUseTemporal ? NUM_TEMPORAL_SAMPLE : NUM_SAMPLE;
+	vec2 noiseOffset = bUseTemporal ? fract(SSRTemporalInfo.z * vec2(0.7548776662, 0.5698402910)) : vec2(0.0);
+
+	vec4 noiseColor = texture(NoiseMap, (viewPortSize.xy / vec2(1024.0)) * fragUV + noiseOffset);
 	vec2 Xi = fract(noiseColor.xy);
 
 	vec2 samples[NUM_SAMPLE];
@@ -453,8 +478,6 @@ void main()
 	float Intensity = SSRInfo.y;
 	vec2 relfectedUV = fragUV + offset.xy;
 
-	float offsetLen = FLT_MAX;
-
 	if(bufferInfo < UINT_MAX)
 	{		
 		//values correction
@@ -469,19 +492,17 @@ void main()
 		else if(CoordSys == 3)
 			relfectedUV = relfectedUV.xy - vec2(correctionPixel/viewPortSize.x, 0.0);
 
-		offsetLen = length(offset.xy);
-	
-		outColor = fetchColor(relfectedUV, UVforNormalMap, HitPos_WS.xyz, globalRoughness, mat3(planeInfo[0].rotMat), samples, bUseNormal);
+		outColor = fetchColor(relfectedUV, UVforNormalMap, HitPos_WS.xyz, globalRoughness, mat3(planeInfo[planeID - 1].rotMat), samples, numSamples, bUseNormal);
 		
 
 		outColor *= fade(relfectedUV);
 		outColor *= Intensity;
-		outColor.w = offsetLen;
+
+		//distance from the reflector to the reflected point, the temporal resolve reprojects with it
+		vec4 reflectedWorldPos = getWorldPosition(relfectedUV, texture(depthMap, relfectedUV).x);
+		outColor.w = max(distance(reflectedWorldPos.xyz, worldPos.xyz), MIN_HIT_DISTANCE);
 
 	}	
 	else
-		outColor.w = FLT_MAX;
-		
-	//clear IntermediateBuffer
-	imageAtomicMax(IntermediateBuffer, iUV, UINT_MAX);
+		outColor.w = HOLE_HIT_DISTANCE;
 }
\ No newline at end of file
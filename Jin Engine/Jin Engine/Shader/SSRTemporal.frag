@@ -0,0 +1,94 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform sampler2D ReflectionTexture;
+layout(binding = 1) uniform sampler2D HistoryTexture;
+layout(binding = 2) uniform sampler2D depthMap;
+
+layout(set = 0, binding = 3) uniform SSRInfoBuffer
+{
+	vec4 SSRInfo; //x : global Roughness, y : Intensity, z : bUseNormalmap, w : holePatching
+	vec4 SSRTraceInfo; //x : bUseHiZ, y : max Hi-Z iterations, z : thickness, w : reflection resolution divisor
+	vec4 SSRTemporalInfo; //x : bUseTemporal, y : current frame weight, z : frame index
+};
+
+layout(set = 0, binding = 4) uniform cameraBuffer
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 viewProjMat;
+	mat4 InvViewProjMat;
+
+	vec4 cameraWorldPos;
+	vec4 viewPortSize;
+
+	mat4 prevViewProjMat;
+};
+
+layout(set = 0, binding = 5) uniform perFrameBuffer
+{
+	vec4 timeInfo; //x - totalTime, y - deltaTime, z - frameIndex
+};
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	vec4 currentColor = texture(ReflectionTexture, fragUV);
+
+	//the history is empty on the first frame
+	if(timeInfo.z < 0.5)
+	{
+		outColor = currentColor;
+		return;
+	}
+
+	float depth = texture(depthMap, fragUV).x;
+
+	//sky, or no reflection under this texel
+	if(depth <= 0.0 || currentColor.w <= 0.0)
+	{
+		outColor = currentColor;
+		return;
+	}
+
+	vec4 worldPos = InvViewProjMat * vec4(fragUV * 2.0 - vec2(1.0), depth, 1.0);
+	worldPos /= worldPos.w;
+
+	//the reflection moves with the mirror image of the hit point, which lies behind the reflector along the view ray
+	//the scene is static so only the camera moves
+	vec3 viewVec = worldPos.xyz - cameraWorldPos.xyz;
+	float surfaceDistance = length(viewVec);
+	vec3 virtualHitPos = cameraWorldPos.xyz + viewVec * ((surfaceDistance + currentColor.w) / surfaceDistance);
+
+	vec4 prevClipPos = prevViewProjMat * vec4(virtualHitPos, 1.0);
+	vec2 prevUV = (prevClipPos.xy / prevClipPos.w) * 0.5 + vec2(0.5);
+
+	if(prevClipPos.w <= 0.0 || prevUV.x < 0.0 || prevUV.x > 1.0 || prevUV.y < 0.0 || prevUV.y > 1.0)
+	{
+		outColor = currentColor;
+		return;
+	}
+
+	//clamp the history to the neighborhood of the current frame to avoid ghosting
+	vec2 texelSize = 1.0 / vec2(textureSize(ReflectionTexture, 0));
+
+	vec4 minColor = currentColor;
+	vec4 maxColor = currentColor;
+
+	for(int y = -1; y <= 1; y++)
+	{
+		for(int x = -1; x <= 1; x++)
+		{
+			vec4 neighborColor = texture(ReflectionTexture, fragUV + vec2(x, y) * texelSize);
+			minColor = min(minColor, neighborColor);
+			maxColor = max(maxColor, neighborColor);
+		}
+	}
+
+	vec4 historyColor = clamp(texture(HistoryTexture, prevUV), minColor, maxColor);
+
+	outColor = mix(historyColor, currentColor, SSRTemporalInfo.y);
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#define NEAR_PLANE 0.1
+#define FAR_PLANE 1000.0
+#define INFINITE_FAR_PLANE 1 //must match Camera.h
+
+#define DEPTH_TOLERANCE 0.05 //view depth difference, relative to this pixel's depth, still treated as the same surface
+#define NORMAL_POWER 16.0
+
+layout(binding = 0) uniform sampler2D ReflectionTexture;
+layout(binding = 1) uniform sampler2D depthMap;
+layout(binding = 2) uniform sampler2D normalMap;
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+//reverse-Z, 1 on the near plane and 0 on the far plane or at infinity
+float linearEyeDepth(float depth)
+{
+#if INFINITE_FAR_PLANE
+	return NEAR_PLANE / max(depth, 1e-7);
+#else
+	return NEAR_PLANE * FAR_PLANE / (NEAR_PLANE + depth * (FAR_PLANE - NEAR_PLANE));
+#endif
+}
+
+void main()
+{
+	ivec2 fullCoord = ivec2(gl_FragCoord.xy);
+	float depth = texelFetch(depthMap, fullCoord, 0).x;
+
+	//sky
+	if(depth <= 0.0)
+	{
+		outColor = vec4(0.0);
+		return;
+	}
+
+	float centerDepth = linearEyeDepth(depth);
+	vec3 centerNormal = normalize(texelFetch(normalMap, fullCoord, 0).xyz);
+
+	ivec2 lowSize = textureSize(ReflectionTexture, 0);
+	vec2 fullSize = vec2(textureSize(depthMap, 0));
+
+	//the 4 nearest low resolution texels
+	vec2 lowCoord = fragUV * vec2(lowSize) - vec2(0.5);
+	ivec2 baseCoord = ivec2(floor(lowCoord));
+	vec2 fraction = lowCoord - floor(lowCoord);
+
+	vec4 colorSum = vec4(0.0);
+	float weightSum = 0.0;
+
+	for(int i = 0; i < 4; i++)
+	{
+		ivec2 offset = ivec2(i & 1, i >> 1);
+		ivec2 texel = clamp(baseCoord + offset, ivec2(0), lowSize - ivec2(1));
+
+		//full resolution depth and normal under the center of the low resolution texel
+		ivec2 guideCoord = ivec2((vec2(texel) + vec2(0.5)) / vec2(lowSize) * fullSize);
+		float guideDepth = texelFetch(depthMap, guideCoord, 0).x;
+
+		if(guideDepth <= 0.0)
+			continue;
+
+		vec2 bilinear = mix(vec2(1.0) - fraction, fraction, vec2(offset));
+		float weight = bilinear.x * bilinear.y;
+
+		weight *= exp(-abs(linearEyeDepth(guideDepth) - centerDepth) / (centerDepth * DEPTH_TOLERANCE));
+		weight *= pow(max(dot(centerNormal, normalize(texelFetch(normalMap, guideCoord, 0).xyz)), 0.0), NORMAL_POWER);
+
+		colorSum += texelFetch(ReflectionTexture, texel, 0) * weight;
+		weightSum += weight;
+	}
+
+	//no neighbor lies on the same surface, take the nearest one
+	if(weightSum < 0.0001)
+	{
+		outColor = texelFetch(ReflectionTexture, clamp(ivec2(fragUV * vec2(lowSize)), ivec2(0), lowSize - ivec2(1)), 0);
+		return;
+	}
+
+	outColor = colorSum / weightSum;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+//weight of the current frame, the rest comes from the reprojected history
+#define CLOUD_TEMPORAL_BLEND 0.1
+
+layout(binding = 0) uniform sampler2D CloudTexture;
+layout(binding = 1) uniform sampler2D HistoryTexture;
+
+layout(set = 0, binding = 2) uniform cameraBuffer
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 viewProjMat;
+	mat4 InvViewProjMat;
+
+	vec4 cameraWorldPos;
+	vec4 viewPortSize;
+
+	mat4 prevViewProjMat;
+};
+
+layout(set = 0, binding = 3) uniform perFrameBuffer
+{
+	vec4 timeInfo; //x - totalTime, y - deltaTime, z - frameIndex
+};
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	vec4 currentColor = texture(CloudTexture, fragUV);
+
+	if(timeInfo.z < 0.5)
+	{
+		outColor = currentColor;
+		return;
+	}
+
+	//clouds are far enough to be reprojected as if they were at reverse-Z depth 0
+	//with the infinite far plane that point is a direction with w = 0, so it stays homogeneous
+	vec4 worldPos = InvViewProjMat * vec4(fragUV * 2.0 - vec2(1.0), 0.0, 1.0);
+
+	vec4 prevClipPos = prevViewProjMat * worldPos;
+	vec2 prevUV = (prevClipPos.xy / prevClipPos.w) * 0.5 + vec2(0.5);
+
+	if(prevClipPos.w <= 0.0 || prevUV.x < 0.0 || prevUV.x > 1.0 || prevUV.y < 0.0 || prevUV.y > 1.0)
+	{
+		outColor = currentColor;
+		return;
+	}
+
+	//clamp the history to the neighborhood of the current frame to avoid ghosting
+	vec2 texelSize = 1.0 / vec2(textureSize(CloudTexture, 0));
+
+	vec4 minColor = currentColor;
+	vec4 maxColor = currentColor;
+
+	for(int y = -1; y <= 1; y++)
+	{
+		for(int x = -1; x <= 1; x++)
+		{
+			vec4 neighborColor = texture(CloudTexture, fragUV + vec2(x, y) * texelSize);
+			minColor = min(minColor, neighborColor);
+			maxColor = max(maxColor, neighborColor);
+		}
+	}
+
+	vec4 historyColor = clamp(texture(HistoryTexture, prevUV), minColor, maxColor);
+
+	outColor = mix(historyColor, currentColor, CLOUD_TEMPORAL_BLEND);
+}
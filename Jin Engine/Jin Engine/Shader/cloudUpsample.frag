@@ -0,0 +1,61 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+#define DEPTH_SIGMA 0.0001 //reverse-Z depth difference that lowers a low resolution texel's weight to 1/e, about 1000 units away from the near plane
+
+layout(binding = 0) uniform sampler2D SceneTexture;
+layout(binding = 1) uniform sampler2D CloudTexture;
+layout(binding = 2) uniform sampler2D depthMap;
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	vec4 sceneColor = texture(SceneTexture, fragUV);
+
+	//reverse-Z, 0 on the far plane or at infinity
+	float depth = texelFetch(depthMap, ivec2(gl_FragCoord.xy), 0).x;
+
+	//geometry
+	if(depth > 0.0)
+	{
+		outColor = sceneColor;
+		return;
+	}
+
+	ivec2 lowSize = textureSize(CloudTexture, 0);
+
+	//the 4 nearest low resolution texels
+	vec2 lowCoord = fragUV * vec2(lowSize) - vec2(0.5);
+	ivec2 baseCoord = ivec2(floor(lowCoord));
+	vec2 fraction = lowCoord - floor(lowCoord);
+
+	vec4 cloudSum = vec4(0.0);
+	float weightSum = 0.0;
+
+	for(int i = 0; i < 4; i++)
+	{
+		ivec2 offset = ivec2(i & 1, i >> 1);
+		ivec2 texel = clamp(baseCoord + offset, ivec2(0), lowSize - ivec2(1));
+
+		//sky.frag marched the texel only if some of these full resolution texels is sky, otherwise it holds no clouds
+		vec4 guideDepth = textureGather(depthMap, (vec2(texel) + vec2(0.5)) / vec2(lowSize), 0);
+
+		vec2 bilinear = mix(vec2(1.0) - fraction, fraction, vec2(offset));
+		float weight = bilinear.x * bilinear.y;
+
+		weight *= exp(-abs(min(min(guideDepth.x, guideDepth.y), min(guideDepth.z, guideDepth.w)) - depth) / DEPTH_SIGMA);
+
+		cloudSum += texelFetch(CloudTexture, texel, 0) * weight;
+		weightSum += weight;
+	}
+
+	//every neighbor lies on geometry, take the nearest one
+	vec4 cloudColor = weightSum < 0.0001 ? texelFetch(CloudTexture, clamp(ivec2(fragUV * vec2(lowSize)), ivec2(0), lowSize - ivec2(1)), 0) : cloudSum / weightSum;
+
+	vec3 midDayCol = vec3(0.52941176470588235294117647058824, 0.81176470588235294117647058823529, 0.90980392156862745098039215686275);
+
+	outColor = vec4(mix(midDayCol, cloudColor.xyz, cloudColor.w), sceneColor.w);
+}
@@ -34,7 +34,8 @@ void main()
 	
 	if(SSR_MODE == 0)
 	{
-		outColor = SeneColor +  SSR * SSR.w;
+		//SSR is already scaled by the intensity, its alpha is the hit distance
+		outColor = SeneColor + vec4(SSR.xyz, 0.0);
 	}
 	else if(SSR_MODE == 1)
 	{
@@ -3,11 +3,6 @@
 
 layout(binding = 0) uniform sampler2D prevDepthMap;
 
-layout(set = 0, binding = 1) uniform screenSizeBuffer
-{
-	vec4 depthMapSize;
-};
-
 layout(location = 0) in vec2 fragUV;
 
 layout(location = 0) out float outColor;
@@ -15,36 +10,23 @@ layout(location = 0) out float outColor;
 
 void main()
 {
-	if(depthMapSize.w == 1.0)
-	{
-		outColor = texture(prevDepthMap, fragUV).x;
-	}	
-	else
-	{
-		vec2 prevMapSize = depthMapSize.xy;
+	ivec2 prevMapSize = textureSize(prevDepthMap, 0);
+	ivec2 ipixel = ivec2(gl_FragCoord.xy) * 2;
 
-		vec2 pixel = prevMapSize * fragUV;
+	//odd sized levels fold the leftover row and column into the border texels
+	ivec2 footprint = ivec2(2) + ivec2(equal(ipixel + ivec2(2), prevMapSize - ivec2(1)));
 
-		ivec2 ipixel = ivec2(int(pixel.x), int(pixel.y));
-	
-		if(ipixel.x % 2 == 1)
-		{
-			ipixel.x -= 1;
-		}
+	//reverse-Z, the nearest depth is the largest
+	float nearestDepth = 0.0;
 
-		if(ipixel.y % 2 == 1)
+	for(int y = 0; y < footprint.y; y++)
+	{
+		for(int x = 0; x < footprint.x; x++)
 		{
-			ipixel.y -= 1;
+			ivec2 coords = min(ipixel + ivec2(x, y), prevMapSize - ivec2(1));
+			nearestDepth = max(nearestDepth, texelFetch(prevDepthMap, coords, 0).x);
 		}
+	}
 
-		float val0 = texture(prevDepthMap, vec2(ipixel) / prevMapSize).x;
-		float val1 = texture(prevDepthMap, vec2(ipixel.x + 1, ipixel.y) / prevMapSize).x;
-		float val2 = texture(prevDepthMap, vec2(ipixel.x, ipixel.y + 1) / prevMapSize).x;
-		float val3 = texture(prevDepthMap, vec2(ipixel.x + 1, ipixel.y + 1) / prevMapSize).x;
-
-		float min01 = min(val0, val1);
-		float min23 = min(val2, val3);
-
-		outColor = min(min01, min23);
-	}	
+	outColor = nearestDepth;
 }
\ No newline at end of file
@@ -23,6 +23,11 @@ layout(set = 0, binding = 5) uniform cameraBuffer
 	vec4 viewPortSize;
 };
 
+//first resident level of the streamed textures, x - basicColor, y - specular, z - normal, w - emissive
+layout(set = 0, binding = 6) uniform residentLevelBuffer
+{
+	vec4 residentLevels;
+};
 
 
 layout(location = 0) in vec4 fragPos;
@@ -41,7 +46,8 @@ void main()
 {
 	float lod = log2( -fragPos.z / 3.0 + 1.0);
 
-    outColor = textureLod(basicColorTexture, fragUV, lod);
+	//the bound image starts at the resident level, the levels above it are not there to pick
+    outColor = textureLod(basicColorTexture, fragUV, max(lod - residentLevels.x, 0.0));
 
 	if(outColor.w < .1)
 		discard;
@@ -50,8 +56,11 @@ void main()
 
 	outNormal = texture(normalColorTexture, fragUV);
 
-	vec3 tangentNormal = outNormal.xyz;
-	tangentNormal = normalize(tangentNormal * 2.0 - vec3(1.0));
+	//BC5 normal maps only store XY
+	vec3 tangentNormal;
+	tangentNormal.xy = outNormal.xy * 2.0 - vec2(1.0);
+	tangentNormal.z = sqrt(max(1.0 - dot(tangentNormal.xy, tangentNormal.xy), 0.0));
+	tangentNormal = normalize(tangentNormal);
 
 	vec3 localNormal;	
 	
@@ -3,6 +3,11 @@
 
 #define MAX_LIGHT 128
 
+#define CLUSTER_X 16
+#define CLUSTER_Y 9
+#define CLUSTER_Z 24
+#define MAX_LIGHTS_PER_CLUSTER 128
+
 layout(binding = 0) uniform sampler2D basicGbuffer;
 layout(binding = 1) uniform sampler2D specularGbuffer;
 layout(binding = 2) uniform sampler2D normalGbuffere;
@@ -27,9 +32,9 @@ struct LightInfo
 	vec4 worldPos;
 };
 
-layout(set = 0, binding = 6) uniform pointLightBuffer
+layout(std430, set = 0, binding = 6) readonly buffer pointLightBuffer
 {
-	LightInfo pointLight[MAX_LIGHT];
+	LightInfo pointLight[];
 };
 
 layout(set = 0, binding = 7) uniform directionalLightBuffer
@@ -37,6 +42,23 @@ layout(set = 0, binding = 7) uniform directionalLightBuffer
 	LightInfo directionalLight[MAX_LIGHT];
 };
 
+layout(set = 0, binding = 8) uniform clusterInfoBuffer
+{
+	vec4 depthInfo; //x - near, y - far, z - CLUSTER_Z / log(far / near)
+	uvec4 lightInfo; //x - numPointLights
+};
+
+//filled by lightCulling.comp
+layout(std430, set = 0, binding = 9) readonly buffer lightGridBuffer
+{
+	uint lightGrid[];
+};
+
+layout(std430, set = 0, binding = 10) readonly buffer lightIndexBuffer
+{
+	uint lightIndex[];
+};
+
 layout(location = 0) in vec2 fragUV;
 
 layout(location = 0) out vec4 outColor;
@@ -122,6 +144,13 @@ void main()
 
 	//getPosition form Depth
 	float depth = texture(DepthMap, fragUV).x;
+
+	//sky, the cleared depth does not unproject with the infinite far plane
+	if(depth <= 0.0)
+	{
+		outColor = vec4(EmissiveMap.xyz, depth);
+		return;
+	}
 	
 	//get WorldPosition
 	vec4 worldPos = InvViewProjMat * vec4(fragUV.xy * 2.0 - 1.0, depth, 1.0);
@@ -129,10 +158,20 @@ void main()
 
 	vec3 NormalVec = NormalMap.xyz;
 
+	//Find the cluster of this pixel
+	float viewDepth = -(viewMat * worldPos).z;
+
+	uvec2 tileIndex = min(uvec2(fragUV * vec2(CLUSTER_X, CLUSTER_Y)), uvec2(CLUSTER_X - 1, CLUSTER_Y - 1));
+	uint slice = uint(clamp(floor(log(max(viewDepth, depthInfo.x) / depthInfo.x) * depthInfo.z), 0.0, float(CLUSTER_Z - 1)));
+	uint clusterIndex = (slice * CLUSTER_Y + tileIndex.y) * CLUSTER_X + tileIndex.x;
+
+	uint numClusterLights = lightGrid[clusterIndex];
+	uint clusterOffset = clusterIndex * MAX_LIGHTS_PER_CLUSTER;
+
 	//Point Light
-	for(uint i = 0; i < 9; i++)
+	for(uint i = 0; i < numClusterLights; i++)
 	{		
-		LightInfo thisPointLight = pointLight[i];
+		LightInfo thisPointLight = pointLight[lightIndex[clusterOffset + i]];
 
 		vec3 LightVec = thisPointLight.worldPos.xyz - worldPos.xyz;
 
@@ -0,0 +1,21 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(binding = 0) uniform sampler2D depthMap;
+
+layout(location = 0) flat in uint planeID;
+
+//index + 1 of the nearest plane in front of the scene, the render pass clears it to 0 where there is none
+layout(location = 0) out uint outPlaneID;
+
+void main()
+{
+	//reverse-Z, 0 on the far plane or at infinity
+	float depth = texelFetch(depthMap, ivec2(gl_FragCoord.xy), 0).x;
+
+	//sky, or the scene covers the plane here
+	if(depth <= 0.0 || depth >= gl_FragCoord.z)
+		discard;
+
+	outPlaneID = planeID;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 1) uniform cameraBuffer
+{
+	mat4 viewMat;
+	mat4 projMat;
+	mat4 viewProjMat;
+	mat4 InvViewProjMat;
+
+	vec4 cameraWorldPos;
+	vec4 viewPortSize;
+};
+
+struct PlaneInfo
+{
+	mat4 rotMat;
+	vec4 centerPoint;
+	vec4 size;
+};
+
+//visible planes only, culled and sorted far to near on the CPU every frame
+layout(std430, set = 0, binding = 2) readonly buffer planeInfoBuffer
+{	
+	uint numPlanes;
+	uint pad00;
+	uint pad01;
+	uint pad02;
+	PlaneInfo planeInfo[];
+};
+
+layout(location = 0) flat out uint planeID;
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+//two triangles of a quad centered on the plane
+const vec2 quadCorners[6] = vec2[](vec2(-0.5, -0.5), vec2(0.5, -0.5), vec2(0.5, 0.5), vec2(-0.5, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5));
+
+void main()
+{
+	planeID = uint(gl_InstanceIndex) + 1;
+
+	//one instance is drawn per plane slot, the ones past the visible planes are degenerate
+	if(uint(gl_InstanceIndex) >= numPlanes)
+	{
+		gl_Position = vec4(0.0);
+		return;
+	}
+
+	PlaneInfo thisPlane = planeInfo[gl_InstanceIndex];
+
+	vec2 corner = quadCorners[gl_VertexIndex] * thisPlane.size.xy;
+	vec3 worldPos = thisPlane.centerPoint.xyz + thisPlane.rotMat[0].xyz * corner.x + thisPlane.rotMat[1].xyz * corner.y;
+
+	gl_Position = viewProjMat * vec4(worldPos, 1.0);
+}
\ No newline at end of file
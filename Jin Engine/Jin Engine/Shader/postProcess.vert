@@ -1,13 +1,6 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(location = 0) in vec4 vertexPos;
-layout(location = 1) in vec4 vertexCol;
-layout(location = 2) in vec4 vertexTan;
-layout(location = 3) in vec4 vertexBitan;
-layout(location = 4) in vec4 vertexNor;
-layout(location = 5) in vec2 vertexUV;
-
 layout(location = 0) out vec2 fragUV;
 
 out gl_PerVertex
@@ -15,9 +8,11 @@ out gl_PerVertex
     vec4 gl_Position;
 };
 
+//one triangle covering the screen, Vulkan's Y coord is opposite
+const vec2 fullscreenUV[3] = vec2[](vec2(0.0, -1.0), vec2(0.0, 1.0), vec2(2.0, 1.0));
 
 void main()
 {
-	gl_Position = vertexPos;
-	fragUV = vertexUV;
+	fragUV = fullscreenUV[gl_VertexIndex];
+	gl_Position = vec4(fragUV * 2.0 - vec2(1.0), 0.5, 1.0);
 }
\ No newline at end of file
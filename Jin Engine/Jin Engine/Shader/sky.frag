@@ -6,6 +6,14 @@
 #define CLOUD_MIN 1500.0
 #define CLOUD_MAX 8000.0
 
+#define CLOUD_DOWNSAMPLE 2
+#define CLOUD_OCCUPANCY_SIZE 16
+#define CLOUD_CELL_EXIT_BIAS 1.0 //distance past an occupancy cell exit, puts the next sample inside the next cell
+
+#define CLOUD_NOISE_SCALE 0.000057
+#define CLOUD_COVERAGE 0.01
+#define CLOUD_TYPE 0.0 //0.0 - stratus, 0.5 - stratocumulus, 1.0 - cumulus
+
 #define PI 3.1415926535897932384626422832795028841971
 #define TwoPi 6.28318530717958647692
 #define InvPi 0.31830988618379067154
@@ -25,6 +33,9 @@ layout(set = 0, binding = 4) uniform cameraBuffer
 	mat4 InvViewProjMat;
 
 	vec4 cameraWorldPos;
+	vec4 viewPortSize;
+
+	mat4 prevViewProjMat;
 };
 
 layout(set = 0, binding = 5) uniform perFrameBuffer
@@ -32,6 +43,17 @@ layout(set = 0, binding = 5) uniform perFrameBuffer
 	vec4 timeInfo;
 };
 
+layout(set = 0, binding = 6) uniform cloudInfoBuffer
+{
+	vec4 marchInfo; //x - steps through the cloud layer, y - search step scale, z - min transmittance, w - max zero density samples
+};
+
+//max low frequency base shape of each cell of the noise volume, built once on load
+layout(std430, set = 0, binding = 7) readonly buffer cloudOccupancyBuffer
+{
+	float cloudOccupancy[];
+};
+
 layout(location = 0) in vec2 fragUV;
 
 layout(location = 0) out vec4 outColor;
@@ -188,7 +210,8 @@ float SphericalPhi(vec3 v)
 	return (p < 0.0f) ? (p + TwoPi) : p;
 }
 
-float SampleCloudDensity(vec3 position, float height_fraction, vec3 weather_data, bool doCheaply)
+//mipLevel is the footprint of the sample in low frequency noise texels
+float SampleCloudDensity(vec3 position, float height_fraction, vec3 weather_data, bool doCheaply, float mipLevel)
 {
 	vec2 inCloudMinMax = vec2(CLOUD_MIN, CLOUD_MAX);
 
@@ -226,10 +249,9 @@ float SampleCloudDensity(vec3 position, float height_fraction, vec3 weather_data
     //animate clouds in wind direction and add a small upward bias to the wind direction
     //position += (wind_direction + vec3(0.0, 0.1, 0.0)  ) * timeInfo.x * cloud_speed;
 
-	float scale = 0.000057;
-	newPosition *= scale;
+	newPosition *= CLOUD_NOISE_SCALE;
     // read the low frequency Perlin-Worley and Worley noises
-    vec4 low_frequency_noises = texture(lowFreqTexture, newPosition);
+    vec4 low_frequency_noises = textureLod(lowFreqTexture, newPosition, mipLevel);
 
     // build an fBm out of  the low frequency Worley noises that can be used to add detail to the Low frequency Perlin-Worley noise
     float low_freq_fBm = ( low_frequency_noises.g * 0.625 ) + ( low_frequency_noises.b * 0.25 ) + ( low_frequency_noises.a * 0.125 );
@@ -270,7 +292,8 @@ float SampleCloudDensity(vec3 position, float height_fraction, vec3 weather_data
         //newPosition.xy += curl_noise.rg * (1.0 - height_fraction) * 200.0;
 
         // sample high-frequency noises
-        vec3 high_frequency_noises = texture(highFreqTexture, newPosition * 0.1).rgb;
+        float highFreqMipLevel = max(mipLevel + log2(0.1 * float(textureSize(highFreqTexture, 0).x) / float(textureSize(lowFreqTexture, 0).x)), 0.0);
+        vec3 high_frequency_noises = textureLod(highFreqTexture, newPosition * 0.1, highFreqMipLevel).rgb;
 
         // build High frequency Worley noise fBm
         float high_freq_fBm = ( high_frequency_noises.r * 0.625 ) + ( high_frequency_noises.g * 0.25 ) + ( high_frequency_noises.b * 0.125 );
@@ -344,7 +367,7 @@ float SampleCloudDensityAlongCone(vec3 p, vec3 ray_direction, vec3 weather_data,
 		//get projected Pos in innerShell;
 		float relativeHeight = distance(position, normalize(position) * CLOUD_MIN) / (CLOUD_MAX - CLOUD_MIN);
 
-        density_along_cone += SampleCloudDensity(position, relativeHeight, weather_data, false);
+        density_along_cone += SampleCloudDensity(position, relativeHeight, weather_data, false, float(i) * 0.5);
     }
 	return clamp(density_along_cone, 0.0, 1.0);
 }
@@ -380,21 +403,86 @@ float HenyeyGreenstein(float cos_angle, float inG)
 	return ((1.0 - inG2) / pow((1.0 + inG2 - 2.0 * inG * cos_angle), 1.5)) / 12.566370614359172953850573533118;
 }
 
+//height fractions where GetDensityHeightGradientForPoint is positive
+vec2 getCloudHeightRange(float cloudType)
+{
+	if(cloudType < 0.5)
+		return vec2(0.05, 0.25);
+	else if(cloudType < 1.0)
+		return vec2(0.1, 0.45);
+	else
+		return vec2(0.05, 0.8);
+}
+
+//peak of GetDensityHeightGradientForPoint
+float getMaxHeightGradient(float cloudType)
+{
+	if(cloudType < 0.5)
+		return 4.0;
+	else if(cloudType < 1.0)
+		return 3.0625;
+	else
+		return 28.125;
+}
+
+//distance to leave the occupancy cell containing position, along viewVec
+float getOccupancyCellExit(vec3 position, vec3 viewVec)
+{
+	float cellScale = CLOUD_NOISE_SCALE * float(CLOUD_OCCUPANCY_SIZE);
+	vec3 cellPos = position * cellScale;
+	vec3 cellFrac = cellPos - floor(cellPos);
+
+	vec3 dist = mix(cellFrac, vec3(1.0) - cellFrac, step(vec3(0.0), viewVec));
+	vec3 tExit = dist / max(abs(viewVec), vec3(1e-5));
+
+	return min(min(tExit.x, tExit.y), tExit.z) / cellScale;
+}
+
+float getOccupancy(vec3 position)
+{
+	ivec3 cell = ivec3(floor(fract(position * CLOUD_NOISE_SCALE) * float(CLOUD_OCCUPANCY_SIZE)));
+	cell = clamp(cell, ivec3(0), ivec3(CLOUD_OCCUPANCY_SIZE - 1));
+
+	return cloudOccupancy[(cell.z * CLOUD_OCCUPANCY_SIZE + cell.y) * CLOUD_OCCUPANCY_SIZE + cell.x];
+}
+
+//4x4 Bayer order, one sub-texel position per frame
+const vec2 bayerOffsets[16] = { vec2(0.0, 0.0), vec2(2.0, 2.0), vec2(2.0, 0.0), vec2(0.0, 2.0),
+								vec2(1.0, 1.0), vec2(3.0, 3.0), vec2(3.0, 1.0), vec2(1.0, 3.0),
+								vec2(1.0, 0.0), vec2(3.0, 2.0), vec2(3.0, 0.0), vec2(1.0, 2.0),
+								vec2(0.0, 1.0), vec2(2.0, 3.0), vec2(2.0, 1.0), vec2(0.0, 3.0) };
+
 void main()
 {
-	vec4 sceneColor = texture(SceneTexture, fragUV);
-	float depth = sceneColor.w;
-	float energy = 0.0;
-	vec4 skyColor = vec4(0.0, 0.0, 0.0, 1.0);
+	//rendered at 1 / CLOUD_DOWNSAMPLE resolution, cloudTemporal.frag accumulates the jittered samples
+	vec4 sceneDepth = textureGather(SceneTexture, fragUV, 3);
+
+	//no sky under this texel
+	if(min(min(sceneDepth.x, sceneDepth.y), min(sceneDepth.z, sceneDepth.w)) > 0.0)
+	{
+		outColor = vec4(0.0);
+		return;
+	}
 
+	uint frame = uint(timeInfo.z) % 16;
+	vec2 lowResTexelSize = float(CLOUD_DOWNSAMPLE) / viewPortSize.xy;
+	vec2 jitteredUV = fragUV + ((bayerOffsets[frame] + vec2(0.5)) * 0.25 - vec2(0.5)) * lowResTexelSize;
 
-	float isSky = 0.0;
+	float energy = 0.0;
 
-	vec4 screenSpaceDireciton = InvViewProjMat * vec4(fragUV * 2.0 - vec2(1.0), 1.0, 1.0);
+	//a point on the near plane under reverse-Z, only the direction from the camera is used
+	vec4 screenSpaceDireciton = InvViewProjMat * vec4(jitteredUV * 2.0 - vec2(1.0), 1.0, 1.0);
 		screenSpaceDireciton /= screenSpaceDireciton.w;
 	
 	vec3 viewVec = normalize(screenSpaceDireciton.xyz - cameraWorldPos.xyz);
 
+	//angle covered by one low resolution texel, to pick the noise mip from the distance
+	vec4 neighborDireciton = InvViewProjMat * vec4((jitteredUV + vec2(lowResTexelSize.x, 0.0)) * 2.0 - vec2(1.0), 1.0, 1.0);
+		neighborDireciton /= neighborDireciton.w;
+
+	float texelAngle = length(normalize(neighborDireciton.xyz - cameraWorldPos.xyz) - viewVec);
+	float noiseTexelsPerUnit = CLOUD_NOISE_SCALE * float(textureSize(lowFreqTexture, 0).x);
+
 	vec3 lightVec = normalize(vec3(1.0, 4.0, 1.0));
 	float LoV = dot(lightVec, viewVec);
 	float HG = HenyeyGreenstein(LoV, 0.6);
@@ -409,21 +497,6 @@ void main()
 	Intersection atmosphereIsectInner = raySphereIntersection(cameraPos, viewVec, atmosphereSphereInner);
     Intersection atmosphereIsectOuter = raySphereIntersection(cameraPos, viewVec, atmosphereSphereOuter);
 
-	/*
-	if(atmosphereIsectInner.valid == true)
-	{
-		outColor = vec4(1.0, 0.5, 0.5, 1.0);
-		return;
-	}
-	
-
-	if(atmosphereIsectOuter.valid == true)
-	{
-		outColor = vec4(0.5, 1.0, 0.0, 1.0);
-		return;
-	}
-	*/
-
 	float ds = 0.0;
 	float cloud_test = 0.0;
 	int zero_density_sample_count = 0;
@@ -431,91 +504,90 @@ void main()
 	float alpha = 0.0;
 
 
-	float stepSize = 64.0;
+	float stepSize = marchInfo.x;
+	float maxAlpha = 1.0 - marchInfo.z;
+	int maxZeroDensitySamples = int(marchInfo.w);
+		
+	vec3 weatherData = vec3(0.0); 				
+	vec3 position;
+	float step =  (CLOUD_MAX - CLOUD_MIN) / stepSize;
 
-	//sky
-	if(depth >= 1.0)
-	{		
-		isSky = 1.0;
+	//empty space below and above the layers of this cloud type, kept on the step grid
+	float layerLength = atmosphereIsectOuter.t - atmosphereIsectInner.t;
+	vec2 heightRange = getCloudHeightRange(CLOUD_TYPE);
+	float tStart = atmosphereIsectInner.t + ceil(heightRange.x * layerLength / step) * step;
+	float tEnd = atmosphereIsectInner.t + heightRange.y * layerLength;
 
-		vec3 weatherData = vec3(0.0); 				
-		vec3 position;
-		float step =  (CLOUD_MAX - CLOUD_MIN) / stepSize;
+	//no sample in the cell can exceed the coverage
+	float maxHeightGradient = getMaxHeightGradient(CLOUD_TYPE);
 
-		for(float t = atmosphereIsectInner.t; t < atmosphereIsectOuter.t; ) 
-		{
-			float rHeight = (t - atmosphereIsectInner.t) / (atmosphereIsectOuter.t - atmosphereIsectInner.t);
-			position = cameraPos + viewVec*t;
+	for(float t = tStart; t < tEnd; ) 
+	{
+		float rHeight = (t - atmosphereIsectInner.t) / layerLength;
+		position = cameraPos + viewVec*t;
 
-			if(alpha <= 1.0)
-			{
-				weatherData = texture(wheatherTexture, vec2(position.x, position.z) * 0.001).xyz;
-				//weatherData.x -= 0.2;
-				weatherData.z = 0.0;
-
-				//weatherData.x = 0.999;
-				weatherData.x = 0.01;
-
-				//weatherData = clamp(weatherData, 0.0, 1.0);
-
-				if(cloud_test > 0.0)
-				{
-					float sampled_density = SampleCloudDensity(position, rHeight, weatherData, true);
-
-					if(sampled_density == 0.0 && sampled_density_previous == 0.0)
-					{
-						zero_density_sample_count++;
-					}
-
-					if(zero_density_sample_count < 11 && sampled_density > 0.0)
-					{
-						ds += sampled_density;
-						//float dl = SampleCloudDensityAlongCone(position, lightVec, weatherData, step);
-						energy += sampled_density * 0.5;// GetLightEnergy(position, rHeight, dl, sampled_density, HG, LoV, 7.0, 1.0) * sampled_density;
-						alpha += sampled_density;
-								
-						
-						t += step;
-					}					
-					else
-					{
-						cloud_test = 0.0;
-						zero_density_sample_count = 0;
-					}
-
-					sampled_density_previous = sampled_density;
-				}
-				else
-				{
-					cloud_test = SampleCloudDensity(position, rHeight, weatherData, true);
-					if(cloud_test <= 0.0)
-					{
-						t += step * 2.0;
-					}
-					else
-					{
-						t += step;
-					}
-				}
-			}
-			else
-				break;
+		//early termination, the remaining transmittance is negligible
+		if(alpha > maxAlpha)
+			break;
+
+		if(cloud_test <= 0.0 && getOccupancy(position) * maxHeightGradient <= CLOUD_COVERAGE)
+		{
+			//a longer skip could step over an occupied neighbor cell
+			t += getOccupancyCellExit(position, viewVec) + CLOUD_CELL_EXIT_BIAS;
+			continue;
 		}
 
-		vec3 endWorldPos = viewVec * 1000.0 + cameraPos;
+		float mipLevel = max(log2(t * texelAngle * noiseTexelsPerUnit), 0.0);
 
-		vec3 midDayCol = vec3(0.52941176470588235294117647058824, 0.81176470588235294117647058823529, 0.90980392156862745098039215686275);
-		vec3 midDayCol2 = vec3(0.94901960784313725490196078431373, 0.9, 0.76862745098039215686274509803922);
-		
-		skyColor.xyz = midDayCol;// mix(midDayCol2, midDayCol, Remap( endWorldPos.y, 0.0 , 500.0 , 0.0 , 1.0 ) );
-	}
+		weatherData = textureLod(wheatherTexture, vec2(position.x, position.z) * 0.001, 0.0).xyz;
+		//weatherData.x -= 0.2;
+		weatherData.z = CLOUD_TYPE;
 
-	//sceneColor = sceneColor + skyColor;
+		//weatherData.x = 0.999;
+		weatherData.x = CLOUD_COVERAGE;
 
-	vec4 cloudColor = vec4(energy, energy, energy, alpha);
+		//weatherData = clamp(weatherData, 0.0, 1.0);
 
-	skyColor = mix(skyColor, cloudColor, cloudColor.a);
+		if(cloud_test > 0.0)
+		{
+			float sampled_density = SampleCloudDensity(position, rHeight, weatherData, true, mipLevel);
 
-	outColor = mix(sceneColor, skyColor, isSky);
-		
+			if(sampled_density == 0.0 && sampled_density_previous == 0.0)
+			{
+				zero_density_sample_count++;
+			}
+
+			if(zero_density_sample_count < maxZeroDensitySamples && sampled_density > 0.0)
+			{
+				ds += sampled_density;
+				//float dl = SampleCloudDensityAlongCone(position, lightVec, weatherData, step);
+				energy += sampled_density * 0.5;// GetLightEnergy(position, rHeight, dl, sampled_density, HG, LoV, 7.0, 1.0) * sampled_density;
+				alpha += sampled_density;
+				
+				t += step;
+			}					
+			else
+			{
+				cloud_test = 0.0;
+				zero_density_sample_count = 0;
+			}
+
+			sampled_density_previous = sampled_density;
+		}
+		else
+		{
+			cloud_test = SampleCloudDensity(position, rHeight, weatherData, true, mipLevel);
+			if(cloud_test <= 0.0)
+			{
+				t += step * marchInfo.y;
+			}
+			else
+			{
+				t += step;
+			}
+		}
+	}
+
+	//clouds only, the sky color is composed in cloudUpsample.frag
+	outColor = vec4(energy, energy, energy, clamp(alpha, 0.0, 1.0));
 }
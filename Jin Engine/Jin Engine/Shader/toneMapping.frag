@@ -3,6 +3,24 @@
 
 layout(binding = 0) uniform sampler2D SceneTexture;
 
+//written by exposureAdaptation.comp from the luminance histogram of the scene
+layout(std430, binding = 1) readonly buffer ExposureBuffer
+{
+	uint histogram[256];
+	float exposure;
+	float averageLuminance;
+	float pad00;
+	float pad01;
+};
+
+//half resolution top of the bloom pyramid
+layout(binding = 2) uniform sampler2D BloomTexture;
+
+layout(set = 0, binding = 3) uniform BloomInfoBuffer
+{
+	vec4 BloomInfo; //x : intensity, y : upsample filter radius in texels, z : number of levels
+};
+
 layout(location = 0) in vec2 fragUV;
 
 layout(location = 0) out vec4 outColor;
@@ -18,16 +36,14 @@ float bloomCalculation(float x, float A, float B, float C, float D, float E, flo
 
 vec3 linearToneMapping(vec3 color)
 {
-	float exposure = 1.;
-	color = clamp(exposure * color, 0., 1.);
+	color = clamp(color, 0., 1.);
 	color = pow(color, vec3(1. / gamma));
 	return color;
 }
 
 vec3 simpleReinhardToneMapping(vec3 color)
 {
-	float exposure = 1.5;
-	color *= exposure/(1. + color / exposure);
+	color /= 1. + color;
 	color = pow(color, vec3(1. / gamma));
 	return color;
 }
@@ -76,8 +92,6 @@ vec3 Uncharted2ToneMapping(vec3 color)
 	float E = 0.02;
 	float F = 0.30;
 	float W = 11.2;
-	float exposure = 2.;
-	color *= exposure;
 	color = ((color * (A * color + C * B) + D * E) / (color * (A * color + B) + D * F)) - E / F;
 	float white = ((W * (A * W + C * B) + D * E) / (W * (A * W + B) + D * F)) - E / F;
 	color /= white;
@@ -85,6 +99,27 @@ vec3 Uncharted2ToneMapping(vec3 color)
 	return color;
 }
 
+//last tent upsample of the pyramid, straight into the tone mapping pass
+vec3 upsampleBloom(vec2 uv)
+{
+	vec2 texelSize = BloomInfo.y / vec2(textureSize(BloomTexture, 0));
+
+	vec3 color = texture(BloomTexture, uv).xyz * 4.0;
+
+	color += texture(BloomTexture, uv + texelSize * vec2(-1.0,  0.0)).xyz * 2.0;
+	color += texture(BloomTexture, uv + texelSize * vec2( 1.0,  0.0)).xyz * 2.0;
+	color += texture(BloomTexture, uv + texelSize * vec2( 0.0, -1.0)).xyz * 2.0;
+	color += texture(BloomTexture, uv + texelSize * vec2( 0.0,  1.0)).xyz * 2.0;
+
+	color += texture(BloomTexture, uv + texelSize * vec2(-1.0, -1.0)).xyz;
+	color += texture(BloomTexture, uv + texelSize * vec2( 1.0, -1.0)).xyz;
+	color += texture(BloomTexture, uv + texelSize * vec2(-1.0,  1.0)).xyz;
+	color += texture(BloomTexture, uv + texelSize * vec2( 1.0,  1.0)).xyz;
+
+	//every level of the pyramid added its own copy
+	return color * (1.0 / 16.0) / BloomInfo.z;
+}
+
 vec3 ColorTemperatureToRGB(float temperatureInKelvins)
 {
 	vec3 retColor;
@@ -148,7 +183,14 @@ vec3 RGBtoHSL(vec3 RGB)
 
 void main()
  {
-	vec3 toneMappedColor = (texture(SceneTexture, fragUV).xyz /* + texture(bloomMap, fragUV).xyz*/ ) * ColorTemperatureToRGB( 5200.0 /*3600.0*/);
+	//the operators take exposed color, the exposure comes from the GPU and is never read back
+	vec3 sceneColor = texture(SceneTexture, fragUV).xyz;
+
+	//without bloom the pyramid is not built and BloomTexture is the scene
+	if(BloomInfo.x > 0.0)
+		sceneColor = mix(sceneColor, upsampleBloom(fragUV), BloomInfo.x);
+
+	vec3 toneMappedColor = exposure * sceneColor * ColorTemperatureToRGB( 5200.0 /*3600.0*/);
 	outColor = vec4( RomBinDaHouseToneMapping(toneMappedColor), 1.0);
 
 	// Apply contrast
@@ -1,7 +1,107 @@
 #include "Render\Renderer.h"
+#include "Asset\TextureCooker.h"
+#include "Core\MicroBenchmark.h"
 
-int main()
+int main(int argc, char** argv)
 {
+	//-cook file0 file1 ... converts source images into block compressed containers and exits
+	if (argc > 1 && std::string(argv[1]) == "-cook")
+	{
+		for (int i = 2; i < argc; i++)
+		{
+			std::string sourcePath = argv[i];
+
+			TextureCooker::cookTexture(sourcePath, TextureCooker::getCookedPath(sourcePath));
+			std::cout << "cooked " << TextureCooker::getCookedPath(sourcePath) << std::endl;
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	//-microbench [scene.obj] times the CPU hot paths over synthetic inputs and the meshes of the scene, no device is created
+	if (argc > 1 && std::string(argv[1]) == "-microbench")
+	{
+		MicroBenchmark microBenchmark;
+		microBenchmark.runAll(argc > 2 ? argv[2] : "Asset/Object/sponza/sponza.obj");
+
+		return EXIT_SUCCESS;
+	}
+
+	//-benchmark frames output.json [camera_path.txt] renders offscreen without a window along the path, a recorded one or a turn in place,
+	//and writes the frame times
+	if (argc > 3 && std::string(argv[1]) == "-benchmark")
+	{
+		Benchmark benchmark;
+		benchmark.frameCount = static_cast<uint32_t>(std::max(atoi(argv[2]), 1));
+
+		if (argc > 4 && !benchmark.cameraPath.load(argv[4]))
+		{
+			std::cerr << "failed to load camera path " << argv[4] << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		Renderer renderer;
+
+		renderer.setHeadless(benchmark.width, benchmark.height);
+		renderer.initialize(NULL);
+
+		renderer.runBenchmark(benchmark);
+
+		renderer.shutDown();
+
+		if (!benchmark.writeReport(argv[3]))
+		{
+			std::cerr << "failed to write " << argv[3] << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::cout << "wrote " << argv[3] << std::endl;
+
+		return EXIT_SUCCESS;
+	}
+
+	//-golden capture|compare directory [camera_path.txt] renders every key of the path offscreen, or the starting view without one,
+	//and stores the G-buffers, the post process targets and the final image as goldens or compares them and writes directory/report.json
+	if (argc > 3 && std::string(argv[1]) == "-golden" && (std::string(argv[2]) == "capture" || std::string(argv[2]) == "compare"))
+	{
+		GoldenTest goldenTest;
+		goldenTest.bCapture = std::string(argv[2]) == "capture";
+		goldenTest.directory = argv[3];
+
+		if (argc > 4 && !goldenTest.cameraPath.load(argv[4]))
+		{
+			std::cerr << "failed to load camera path " << argv[4] << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		Renderer renderer;
+
+		renderer.setHeadless(goldenTest.width, goldenTest.height);
+		renderer.initialize(NULL);
+
+		renderer.runGoldenTest(goldenTest);
+
+		renderer.shutDown();
+
+		if (goldenTest.bCapture)
+		{
+			std::cout << "captured " << goldenTest.cameraPath.size() << " poses into " << goldenTest.directory << std::endl;
+			return EXIT_SUCCESS;
+		}
+
+		std::string reportPath = goldenTest.directory + "/report.json";
+
+		if (!goldenTest.writeReport(reportPath))
+		{
+			std::cerr << "failed to write " << reportPath << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::cout << goldenTest.getFailedCount() << " failed passes, wrote " << reportPath << std::endl;
+
+		return goldenTest.getFailedCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	Renderer renderer;
 
 	renderer.initialize(NULL);
@@ -14,4 +114,4 @@ int main()
 
 
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}